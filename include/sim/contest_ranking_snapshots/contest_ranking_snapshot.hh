@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <sim/contest_problems/contest_problem.hh>
+#include <sim/contest_rounds/contest_round.hh>
+#include <sim/contests/contest.hh>
+#include <sim/primary_key.hh>
+#include <sim/sql_fields/blob.hh>
+#include <sim/sql_fields/datetime.hh>
+#include <sim/sql_fields/inf_datetime.hh>
+#include <sim/users/user.hh>
+#include <simlib/mysql/mysql.hh>
+
+namespace sim::contest_ranking_snapshots {
+
+// Ranking of a contest round as seen by non-admins, materialized so that the
+// ranking requests do not have to query the submissions table. Judging does not
+// touch the snapshots: a snapshot older than refresh_interval is rebuilt by one
+// of the readers, so new results appear in the ranking with this delay.
+constexpr auto refresh_interval = std::chrono::seconds{10};
+
+struct ContestRankingSnapshot {
+    decltype(contest_rounds::ContestRound::id) contest_round_id;
+    // Incremented on every invalidation; a snapshot is saved only if the
+    // generation did not change since the data was read
+    uint64_t generation;
+    sql_fields::Datetime created_at;
+    // Snapshot is valid only before this time (NEG_INF means invalidated)
+    sql_fields::InfDatetime valid_until;
+    sql_fields::Blob<0> data;
+
+    static constexpr auto primary_key = PrimaryKey{&ContestRankingSnapshot::contest_round_id};
+};
+
+// The below functions mark snapshots as stale, so they are not served anymore.
+// They should be called in the same transaction that changes the ranking in a
+// way that has to be visible immediately (e.g. edits of rounds or problems).
+
+void invalidate_of_contest_round(
+    mysql::Connection& mysql, decltype(contest_rounds::ContestRound::id) contest_round_id
+);
+
+void invalidate_of_contest_problem(
+    mysql::Connection& mysql, decltype(contest_problems::ContestProblem::id) contest_problem_id
+);
+
+void invalidate_of_contest(mysql::Connection& mysql, decltype(contests::Contest::id) contest_id);
+
+// Invalidates snapshots of all contest rounds in which the user has a final submission
+void invalidate_of_user(mysql::Connection& mysql, decltype(users::User::id) user_id);
+
+} // namespace sim::contest_ranking_snapshots
@@ -1,13 +1,19 @@
 #pragma once
 
-#include <simlib/aho_corasick.hh>
+#include <cstdint>
+#include <simlib/string_view.hh>
+#include <string>
 
 namespace sim {
 
+// Stateless - the keyword automaton is built once and shared by all instances, so creating one
+// highlighter per thread is cheap
 class CppSyntaxHighlighter {
-    AhoCorasick aho;
-
 public:
+    // Has to be incremented on every change of the generated html (it is a part of the cache
+    // keys of the highlighted sources)
+    static constexpr uint32_t version = 1;
+
     CppSyntaxHighlighter();
 
     CppSyntaxHighlighter(const CppSyntaxHighlighter&) = default;
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <simlib/config_file.hh>
+#include <simlib/string_view.hh>
+#include <vector>
+
+namespace sim::cpu_affinity {
+
+// Returns the cpu numbers listed in the sim.conf array variable @p var_name (which has to be added
+// to @p cf), throws if an entry is not a valid cpu number
+std::vector<int> cpus_from_config(const ConfigFile& cf, StringView var_name);
+
+// Returns the cpus dedicated to judging in sim.conf, i.e. js_judge_cpus and
+// js_parallel_judging_cpus (both have to be added to @p cf)
+std::vector<int> judging_cpus_from_config(const ConfigFile& cf);
+
+// Pins the calling thread to @p cpu. Threads and processes spawned by it afterwards inherit it.
+void pin_current_thread_to(int cpu);
+
+// Forbids the calling thread to run on @p cpus (as long as there are other cpus allowed). Threads
+// and processes spawned by it afterwards inherit it.
+void exclude_from_current_thread(const std::vector<int>& cpus);
+
+} // namespace sim::cpu_affinity
@@ -19,4 +19,15 @@ inline auto path_of(decltype(InternalFile::id) id) { return concat<64>(dir, id);
 
 inline auto path_of(const InternalFile& internal_file) { return path_of(internal_file.id); }
 
+// Data derived from the internal files, that can be removed at any time
+constexpr CStringView cache_dir = "internal_files_cache/";
+
+inline auto highlighted_source_path_of(decltype(InternalFile::id) id) {
+    return concat<64>(cache_dir, id, ".highlighted");
+}
+
+inline auto statement_path_of(decltype(InternalFile::id) id) {
+    return concat<64>(cache_dir, id, ".statement");
+}
+
 } // namespace sim::internal_files
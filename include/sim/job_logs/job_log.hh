@@ -0,0 +1,21 @@
+#pragma once
+
+#include <sim/jobs/job.hh>
+#include <sim/primary_key.hh>
+#include <sim/sql_fields/blob.hh>
+
+namespace sim::job_logs {
+
+// Job logs are kept apart from the jobs, so that the rows of the jobs table, that is scanned and
+// updated often, stay narrow. A log is written append-only, so it consists of parts: each row
+// holds the part starting at byte pos. No rows exist if the job has no log.
+struct JobLog {
+    decltype(jobs::Job::id) job_id;
+    uint64_t pos;
+    bool compressed; // using MySQL's COMPRESS()
+    sql_fields::Blob<0> data;
+
+    static constexpr auto primary_key = PrimaryKey{&JobLog::job_id, &JobLog::pos};
+};
+
+} // namespace sim::job_logs
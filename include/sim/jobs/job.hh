@@ -35,6 +35,7 @@ struct Job {
         (DELETE_FILE, 16, "delete_file")
         (CHANGE_PROBLEM_STATEMENT, 17, "change_problem_statement")
         (MERGE_USERS, 18, "merge_users")
+        (REJUDGE_PROBLEM_BATCH, 19, "rejudge_problem_batch")
     );
 
     ENUM_WITH_STRING_CONVERSIONS(Status, uint8_t,
@@ -56,12 +57,12 @@ struct Job {
     sql_fields::Datetime added;
     std::optional<uint64_t> aux_id;
     sql_fields::Blob<128> info;
-    sql_fields::Blob<0> data;
 
     static constexpr auto primary_key = PrimaryKey{&Job::id};
 };
 
 constexpr uint64_t job_log_view_max_size = 128 << 10; // 128 KiB
+constexpr uint64_t job_log_max_size = 8 << 20; // 8 MiB, the rest of a longer log is dropped
 
 // The greater, the more important
 constexpr decltype(Job::priority) default_priority(Job::Type type) {
@@ -83,7 +84,8 @@ constexpr decltype(Job::priority) default_priority(Job::Type type) {
     case Job::Type::ADD_PROBLEM:
     case Job::Type::REUPLOAD_PROBLEM: return 10;
     case Job::Type::JUDGE_SUBMISSION: return 5;
-    case Job::Type::REJUDGE_SUBMISSION: return 4;
+    case Job::Type::REJUDGE_SUBMISSION:
+    case Job::Type::REJUDGE_PROBLEM_BATCH: return 4;
     }
     __builtin_unreachable();
 }
@@ -112,6 +114,7 @@ constexpr const char* to_string(Job::Type x) {
     case JT::DELETE_FILE: return "DELETE_FILE";
     case JT::CHANGE_PROBLEM_STATEMENT: return "CHANGE_PROBLEM_STATEMENT";
     case JT::MERGE_USERS: return "MERGE_USERS";
+    case JT::REJUDGE_PROBLEM_BATCH: return "REJUDGE_PROBLEM_BATCH";
     }
     return "Unknown";
 }
@@ -136,7 +139,8 @@ constexpr bool is_problem_management_job(Job::Type x) {
     case JT::DELETE_CONTEST_ROUND:
     case JT::DELETE_CONTEST_PROBLEM:
     case JT::DELETE_FILE:
-    case JT::MERGE_USERS: return false;
+    case JT::MERGE_USERS:
+    case JT::REJUDGE_PROBLEM_BATCH: return false;
     }
     return false;
 }
@@ -161,7 +165,8 @@ constexpr bool is_submission_job(Job::Type x) {
     case JT::MERGE_PROBLEMS:
     case JT::DELETE_FILE:
     case JT::CHANGE_PROBLEM_STATEMENT:
-    case JT::MERGE_USERS: return false;
+    case JT::MERGE_USERS:
+    case JT::REJUDGE_PROBLEM_BATCH: return false;
     }
     return false;
 }
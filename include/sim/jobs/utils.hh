@@ -1,9 +1,13 @@
 #pragma once
 
+#include <limits>
+#include <sim/contest_problems/contest_problem.hh>
 #include <sim/jobs/job.hh>
 #include <sim/problems/problem.hh>
+#include <sim/submissions/submission.hh>
 #include <sim/users/user.hh>
 #include <simlib/mysql/mysql.hh>
+#include <string>
 #include <utility>
 
 namespace sim::jobs {
@@ -230,6 +234,49 @@ struct MergeUsersInfo {
     }
 };
 
+struct RejudgeProblemBatchInfo {
+    // If set, only the submissions to this contest problem are rejudged
+    std::optional<decltype(sim::contest_problems::ContestProblem::id)> contest_problem_id;
+    // Submissions are claimed in chunks, in the order of their ids
+    decltype(sim::submissions::Submission::id) last_claimed_submission_id{};
+    uint64_t judged_submissions{};
+    uint32_t chunks_in_progress{};
+    // Incremented on every restart, so that chunks claimed before it are not accounted for
+    uint32_t generation{};
+    bool all_claimed{};
+
+    RejudgeProblemBatchInfo() = default;
+
+    explicit RejudgeProblemBatchInfo(
+        std::optional<decltype(sim::contest_problems::ContestProblem::id)> cpid
+    ) noexcept
+    : contest_problem_id(cpid) {}
+
+    explicit RejudgeProblemBatchInfo(StringView str) {
+        extract_dumped(contest_problem_id, str);
+        extract_dumped(last_claimed_submission_id, str);
+        extract_dumped(judged_submissions, str);
+        extract_dumped(chunks_in_progress, str);
+        extract_dumped(generation, str);
+
+        auto mask = extract_dumped_int<uint8_t>(str);
+        all_claimed = (mask & 1);
+    }
+
+    [[nodiscard]] std::string dump() const {
+        std::string res;
+        append_dumped(res, contest_problem_id);
+        append_dumped(res, last_claimed_submission_id);
+        append_dumped(res, judged_submissions);
+        append_dumped(res, chunks_in_progress);
+        append_dumped(res, generation);
+
+        uint8_t mask = all_claimed;
+        append_dumped(res, mask);
+        return res;
+    }
+};
+
 void restart_job(
     mysql::Connection& mysql,
     StringView job_id,
@@ -240,6 +287,39 @@ void restart_job(
 
 void restart_job(mysql::Connection& mysql, StringView job_id, bool notify_job_server);
 
+// Logs are kept in the job_logs table and written append-only: each row holds the part of the log
+// starting at byte `pos`. Once the job is finished, its log is stored compressed in a single row.
+
+// Replaces the parts of the job's log at the positions [@p pos, @p pos_end) with @p log_part
+// saved at @p pos
+void save_log_part(
+    mysql::Connection& mysql,
+    decltype(Job::id) job_id,
+    uint64_t pos,
+    StringView log_part,
+    uint64_t pos_end = std::numeric_limits<uint64_t>::max()
+);
+
+// Appends @p log_part right after the parts of the job's log at the positions lower than
+// @p pos_end, as long as the log does not exceed job_log_max_size. The job's row has to be locked
+// (e.g. SELECT ... FOR UPDATE) for concurrent appends.
+void append_log_part(
+    mysql::Connection& mysql,
+    decltype(Job::id) job_id,
+    StringView log_part,
+    uint64_t pos_end = std::numeric_limits<uint64_t>::max()
+);
+
+// Replaces the whole log of the job with compressed @p log (truncated to job_log_max_size)
+void save_final_log(mysql::Connection& mysql, decltype(Job::id) job_id, StringView log);
+
+// Returns the log of the job, which is cut after the part that reaches @p max_size bytes
+std::string load_log(
+    mysql::Connection& mysql,
+    decltype(Job::id) job_id,
+    uint64_t max_size = std::numeric_limits<uint64_t>::max()
+);
+
 // Notifies the Job server that there are jobs to do
 void notify_job_server() noexcept;
 
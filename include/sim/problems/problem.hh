@@ -24,6 +24,7 @@ struct Problem {
     sql_fields::Varbinary<128> name;
     sql_fields::Varbinary<64> label;
     sql_fields::Blob<4096> simfile;
+    bool parallel_judging; // whether test groups are judged concurrently on the dedicated cpus
     std::optional<decltype(users::User::id)> owner_id;
     sql_fields::Datetime created_at;
     sql_fields::Datetime updated_at;
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <sim/internal_files/internal_file.hh>
+#include <simlib/string_view.hh>
+
+namespace sim::problems {
+
+// Extracts the statement of the problem package @p problem_file_id (having Simfile @p simfile)
+// to internal_files::statement_path_of(@p problem_file_id). The file appears atomically, so it is
+// safe to do it concurrently and to serve the file as soon as it exists. A package is never
+// modified, so the extracted statement stays valid until the package is deleted.
+void extract_statement_to_cache(
+    decltype(internal_files::InternalFile::id) problem_file_id, StringView simfile
+);
+
+} // namespace sim::problems
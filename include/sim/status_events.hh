@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <simlib/string_view.hh>
+#include <utility>
+
+namespace sim::status_events {
+
+// The web server listens on this unix datagram socket for notifications about changes of
+// statuses of submissions and jobs and about changes of users made outside the web server (the
+// path is relative to the sim build directory)
+constexpr CStringView socket_path = ".web-server.status-events.sock";
+
+enum class Kind : char {
+    SUBMISSION = 's',
+    JOB = 'j',
+    USER = 'u', // e.g. the user's contest memberships changed
+    PROBLEM = 'p', // the problem was deleted or merged
+};
+
+// Notifies the web server (if it listens) that the status of the submission / job @p id (or the
+// user @p id) has changed. Has to be called after the change is committed. It never blocks, so notifications
+// may be lost - listeners have to recheck the statuses from time to time anyway.
+void publish(Kind kind, uint64_t id) noexcept;
+
+// Returns std::nullopt if @p datagram is not a valid notification
+std::optional<std::pair<Kind, uint64_t>> parse(StringView datagram) noexcept;
+
+} // namespace sim::status_events
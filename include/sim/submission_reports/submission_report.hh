@@ -0,0 +1,20 @@
+#pragma once
+
+#include <sim/primary_key.hh>
+#include <sim/sql_fields/blob.hh>
+#include <sim/submissions/submission.hh>
+
+namespace sim::submission_reports {
+
+// Judging reports are kept apart from the submissions, so that the rows of the submissions
+// table, that is scanned and updated often, stay narrow. The row is created when the submission
+// is judged for the first time.
+struct SubmissionReport {
+    decltype(submissions::Submission::id) submission_id;
+    sql_fields::Blob<0> initial_report;
+    sql_fields::Blob<0> final_report;
+
+    static constexpr auto primary_key = PrimaryKey{&SubmissionReport::submission_id};
+};
+
+} // namespace sim::submission_reports
@@ -8,7 +8,6 @@
 #include <sim/internal_files/internal_file.hh>
 #include <sim/primary_key.hh>
 #include <sim/problems/problem.hh>
-#include <sim/sql_fields/blob.hh>
 #include <sim/sql_fields/datetime.hh>
 #include <sim/users/user.hh>
 #include <simlib/enum_with_string_conversions.hh>
@@ -64,8 +63,6 @@ struct Submission {
     sql_fields::Datetime submit_time;
     std::optional<int64_t> score;
     sql_fields::Datetime last_judgment;
-    sql_fields::Blob<0> initial_report;
-    sql_fields::Blob<0> final_report;
 
     static constexpr auto primary_key = PrimaryKey{&Submission::id};
 
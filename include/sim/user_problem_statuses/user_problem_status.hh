@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <sim/primary_key.hh>
+#include <sim/problems/problem.hh>
+#include <sim/submissions/submission.hh>
+#include <sim/users/user.hh>
+
+namespace sim::user_problem_statuses {
+
+// Status of the problem final submission of the user, kept in sync by
+// submissions::update_final() so that listing problems does not have to query
+// the submissions table. A row exists iff the user has a problem final
+// submission of the problem.
+struct UserProblemStatus {
+    decltype(users::User::id) user_id;
+    decltype(problems::Problem::id) problem_id;
+    decltype(submissions::Submission::full_status) full_status;
+    int64_t score;
+
+    static constexpr auto primary_key =
+        PrimaryKey{&UserProblemStatus::user_id, &UserProblemStatus::problem_id};
+};
+
+} // namespace sim::user_problem_statuses
@@ -0,0 +1,156 @@
+#include "compilation_cache.hh"
+
+#include <simlib/call_in_destructor.hh>
+#include <simlib/concat_tostr.hh>
+#include <simlib/debug.hh>
+#include <simlib/file_contents.hh>
+#include <simlib/file_manip.hh>
+#include <simlib/file_perms.hh>
+#include <simlib/logger.hh>
+#include <simlib/sha.hh>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace job_server {
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+CompilationCache checker_cache{"internal_files_cache/checkers/"};
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+CompilationCache solution_cache{"internal_files_cache/solutions/"};
+
+void CompilationCache::configure(uint64_t max_size) noexcept {
+    max_size_ = max_size;
+    if (remove_r(dir_) and errno != ENOENT) {
+        errlog("Compilation cache: remove_r()", errmsg());
+    }
+    if (max_size_ > 0 and ::mkdir(dir_.data(), S_0755)) {
+        errlog("Compilation cache: mkdir()", errmsg());
+        max_size_ = 0;
+    }
+}
+
+std::optional<std::string> CompilationCache::get(
+    const std::string& key, const CompileFunc& compile, const LoadFunc& load
+) {
+    STACK_UNWINDING_MARK;
+
+    auto path = path_of(key);
+    std::unique_lock<std::mutex> lock(mtx_);
+    for (;;) {
+        auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            if (max_size_ == 0) {
+                lock.unlock();
+                return compile(std::nullopt);
+            }
+            it = entries_.try_emplace(key).first;
+            lru_.emplace_front(key);
+            it->second.lru_it = lru_.begin();
+            it->second.compiling = true;
+            break;
+        }
+
+        auto& entry = it->second;
+        if (entry.compiling) {
+            cv_.wait(lock); // Other worker compiles the program
+            continue;
+        }
+
+        lru_.splice(lru_.begin(), lru_, entry.lru_it);
+        if (entry.compilation_errors) {
+            if (entry.failure_expires > std::chrono::steady_clock::now()) {
+                return entry.compilation_errors;
+            }
+            // Recompile in place
+            used_size_ -= entry.size;
+            entry.size = 0;
+            entry.compilation_errors = std::nullopt;
+            entry.compiling = true;
+            break;
+        }
+
+        ++entry.users;
+        auto binary_hash = entry.binary_hash;
+        lock.unlock();
+        bool loaded = false;
+        try {
+            // Verify integrity of the binary before using it
+            if (sha3_512(get_file_contents(path)).to_string() == binary_hash) {
+                load(path);
+                loaded = true;
+            } else {
+                errlog("Compilation cache: corrupted binary ", path);
+            }
+        } catch (const std::exception& e) {
+            ERRLOG_CATCH(e);
+        }
+        lock.lock();
+        --entry.users; // Entries being loaded are not removed, so `entry` is still valid
+        if (loaded) {
+            return std::nullopt;
+        }
+        if (entry.users > 0) {
+            lock.unlock();
+            return compile(std::nullopt); // Others still load the binary, so it cannot be removed
+        }
+        remove_locked(it);
+    }
+
+    lock.unlock();
+    // Let the waiting workers retry if the compilation throws
+    CallInDtor abandon_guard([&] {
+        std::lock_guard<std::mutex> guard(mtx_);
+        remove_locked(entries_.find(key));
+        cv_.notify_all();
+    });
+    auto compilation_errors = compile(path);
+    std::string binary_hash;
+    uint64_t size = 0;
+    if (compilation_errors) {
+        size = compilation_errors->size();
+    } else {
+        auto binary = get_file_contents(path);
+        binary_hash = sha3_512(binary).to_string();
+        size = binary.size();
+    }
+    abandon_guard.cancel();
+
+    lock.lock();
+    auto& entry = entries_.find(key)->second; // Entries being compiled are not removed
+    entry.compiling = false;
+    entry.compilation_errors = compilation_errors;
+    entry.failure_expires = std::chrono::steady_clock::now() + FAILURE_TTL;
+    entry.binary_hash = std::move(binary_hash);
+    entry.size = size;
+    used_size_ += size;
+    evict_locked();
+    cv_.notify_all();
+    return compilation_errors;
+}
+
+std::string CompilationCache::path_of(const std::string& key) const {
+    return concat_tostr(dir_, key);
+}
+
+void CompilationCache::remove_locked(std::map<std::string, Entry, std::less<>>::iterator it
+) noexcept {
+    (void)unlink(path_of(it->first).c_str());
+    used_size_ -= it->second.size;
+    lru_.erase(it->second.lru_it);
+    entries_.erase(it);
+}
+
+void CompilationCache::evict_locked() noexcept {
+    auto it = lru_.end();
+    while (used_size_ > max_size_ and it != lru_.begin()) {
+        --it;
+        auto entry_it = entries_.find(*it);
+        if (entry_it->second.compiling or entry_it->second.users > 0) {
+            continue;
+        }
+        it = std::next(it);
+        remove_locked(entry_it); // Invalidates the previous `it`
+    }
+}
+
+} // namespace job_server
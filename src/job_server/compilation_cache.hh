@@ -0,0 +1,83 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <simlib/string_view.hh>
+#include <string>
+
+namespace job_server {
+
+// Process-wide LRU cache of compiled programs (checkers or solutions) saved in a directory inside
+// sim::internal_files::cache_dir, keyed by a hash of everything the compilation depends on (e.g.
+// the source and the language). Compilation failures are cached too, so a broken program fails
+// fast, but they expire after a while, as they may be caused by exceeding the time limit under a
+// heavy load. Concurrent compilations of the same program are coalesced: one worker compiles it
+// while the others wait. Cached binaries are verified against their hashes before being used.
+// The cache is cleared on the job server start, so the binaries never outlive the compiler and
+// the compilation flags they were built with.
+class CompilationCache {
+    struct Entry {
+        bool compiling = false;
+        size_t users = 0; // workers loading the binary, such entry cannot be removed
+        std::optional<std::string> compilation_errors;
+        std::chrono::steady_clock::time_point failure_expires;
+        std::string binary_hash;
+        uint64_t size = 0;
+        std::list<std::string>::iterator lru_it;
+    };
+
+    static constexpr std::chrono::minutes FAILURE_TTL{10};
+
+    const CStringView dir_;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    uint64_t max_size_ = 0;
+    uint64_t used_size_ = 0;
+    std::list<std::string> lru_; // the most recently used key is at the front
+    std::map<std::string, Entry, std::less<>> entries_;
+
+public:
+    // Has to compile the program and either return the compilation errors or save the compiled
+    // program to the given path (if there is one)
+    using CompileFunc =
+        std::function<std::optional<std::string>(const std::optional<std::string>&)>;
+    // Has to load the compiled program from the given path
+    using LoadFunc = std::function<void(const std::string&)>;
+
+    explicit CompilationCache(CStringView dir) noexcept : dir_(dir) {}
+
+    CompilationCache(const CompilationCache&) = delete;
+    CompilationCache(CompilationCache&&) = delete;
+    CompilationCache& operator=(const CompilationCache&) = delete;
+    CompilationCache& operator=(CompilationCache&&) = delete;
+    ~CompilationCache() = default;
+
+    // Not thread-safe, should be called before the workers start. 0 disables the cache.
+    void configure(uint64_t max_size) noexcept;
+
+    // Returns the compilation errors iff the compilation failed. On a hit, the cached program is
+    // loaded using @p load, otherwise it is compiled using @p compile. @p key has to be usable as
+    // a filename.
+    std::optional<std::string>
+    get(const std::string& key, const CompileFunc& compile, const LoadFunc& load);
+
+private:
+    [[nodiscard]] std::string path_of(const std::string& key) const;
+
+    void remove_locked(std::map<std::string, Entry, std::less<>>::iterator it) noexcept;
+
+    void evict_locked() noexcept;
+};
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+extern CompilationCache checker_cache;
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+extern CompilationCache solution_cache;
+
+} // namespace job_server
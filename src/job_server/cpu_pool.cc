@@ -0,0 +1,26 @@
+#include "cpu_pool.hh"
+
+#include <algorithm>
+
+namespace job_server {
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+CpuPool parallel_judging_cpus;
+
+CpuPool::Lease CpuPool::acquire(size_t max_cpus) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto n = std::min(max_cpus, free_cpus_.size());
+    std::vector<int> cpus(free_cpus_.end() - static_cast<ptrdiff_t>(n), free_cpus_.end());
+    free_cpus_.resize(free_cpus_.size() - n);
+    return Lease(this, std::move(cpus));
+}
+
+void CpuPool::release(const std::vector<int>& cpus) noexcept {
+    if (cpus.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mtx_);
+    free_cpus_.insert(free_cpus_.end(), cpus.begin(), cpus.end());
+}
+
+} // namespace job_server
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace job_server {
+
+// Pool of cpus dedicated to judging test groups concurrently. Every cpu is used by at most one
+// judging thread at a time, so the runtimes measured on it are not disturbed by other judgings,
+// and the number of the cpus caps the concurrency.
+class CpuPool {
+    std::mutex mtx_;
+    std::vector<int> free_cpus_;
+
+public:
+    // Returns the cpus to the pool as soon as it is destroyed
+    class Lease {
+        friend class CpuPool;
+
+        CpuPool* pool_;
+        std::vector<int> cpus_;
+
+        Lease(CpuPool* pool, std::vector<int> cpus) noexcept
+        : pool_(pool)
+        , cpus_(std::move(cpus)) {}
+
+    public:
+        Lease(const Lease&) = delete;
+        Lease(Lease&& other) noexcept : pool_(other.pool_), cpus_(std::move(other.cpus_)) {
+            other.cpus_.clear();
+        }
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+
+        ~Lease() { pool_->release(cpus_); }
+
+        [[nodiscard]] const std::vector<int>& cpus() const noexcept { return cpus_; }
+    };
+
+    CpuPool() = default;
+
+    CpuPool(const CpuPool&) = delete;
+    CpuPool(CpuPool&&) = delete;
+    CpuPool& operator=(const CpuPool&) = delete;
+    CpuPool& operator=(CpuPool&&) = delete;
+    ~CpuPool() = default;
+
+    // Not thread-safe, should be called before the workers start. No cpus disable the pool.
+    void configure(std::vector<int> cpus) noexcept { free_cpus_ = std::move(cpus); }
+
+    // Takes at most @p max_cpus free cpus, possibly none; never blocks
+    Lease acquire(size_t max_cpus);
+
+private:
+    void release(const std::vector<int>& cpus) noexcept;
+};
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+extern CpuPool parallel_judging_cpus;
+
+} // namespace job_server
@@ -11,6 +11,7 @@
 #include "job_handlers/judge_or_rejudge.hh"
 #include "job_handlers/merge_problems.hh"
 #include "job_handlers/merge_users.hh"
+#include "job_handlers/rejudge_problem_batch.hh"
 #include "job_handlers/reselect_final_submissions_in_contest_problem.hh"
 #include "job_handlers/reset_problem_time_limits.hh"
 #include "job_handlers/reupload_problem.hh"
@@ -18,6 +19,7 @@
 #include "main.hh"
 
 #include <sim/jobs/job.hh>
+#include <sim/jobs/utils.hh>
 #include <thread>
 
 using sim::jobs::Job;
@@ -110,6 +112,10 @@ void job_dispatcher(
             job_handler = make_unique<JudgeOrRejudge>(job_id, aux_id.value(), added);
             break;
 
+        case JT::REJUDGE_PROBLEM_BATCH:
+            job_handler = make_unique<RejudgeProblemBatch>(job_id, aux_id.value(), added);
+            break;
+
         case JT::ADD_PROBLEM__JUDGE_MODEL_SOLUTION:
             job_handler = make_unique<AddProblemJudgeModelSolution>(
                 job_id, creator.value(), info, file_id.value(), tmp_file_id
@@ -130,8 +136,9 @@ void job_dispatcher(
         throw_assert(job_handler);
         job_handler->run();
         if (job_handler->failed()) {
-            mysql.prepare("UPDATE jobs SET status=?, data=? WHERE id=?")
-                .bind_and_execute(EnumVal(Job::Status::FAILED), job_handler->get_log(), job_id);
+            job_handler->save_final_log();
+            mysql.prepare("UPDATE jobs SET status=? WHERE id=?")
+                .bind_and_execute(EnumVal(Job::Status::FAILED), job_id);
         }
 
     } catch (const std::exception& e) {
@@ -140,8 +147,8 @@ void job_dispatcher(
 
         // Add job to delete temporary file
         auto stmt = mysql.prepare("INSERT INTO jobs(file_id, creator, type,"
-                                  " priority, status, added, aux_id, info, data) "
-                                  "SELECT tmp_file_id, NULL, ?, ?, ?, ?, NULL, '', '' FROM jobs"
+                                  " priority, status, added, aux_id, info) "
+                                  "SELECT tmp_file_id, NULL, ?, ?, ?, ?, NULL, '' FROM jobs"
                                   " WHERE id=? AND tmp_file_id IS NOT NULL");
         stmt.bind_and_execute(
             EnumVal(Job::Type::DELETE_FILE),
@@ -152,18 +159,12 @@ void job_dispatcher(
         );
 
         // Fail job
-        stmt = mysql.prepare("UPDATE jobs SET tmp_file_id=NULL, status=?, data=? "
-                             "WHERE id=?");
+        mysql.prepare("UPDATE jobs SET tmp_file_id=NULL, status=? WHERE id=?")
+            .bind_and_execute(EnumVal(Job::Status::FAILED), job_id);
         if (job_handler) {
-            stmt.bind_and_execute(
-                EnumVal(Job::Status::FAILED),
-                concat(job_handler->get_log(), "\nCaught exception: ", e.what()),
-                job_id
-            );
+            job_handler->save_final_log(concat("\nCaught exception: ", e.what()));
         } else {
-            stmt.bind_and_execute(
-                EnumVal(Job::Status::FAILED), concat("\nCaught exception: ", e.what()), job_id
-            );
+            sim::jobs::save_final_log(mysql, job_id, concat("\nCaught exception: ", e.what()));
         }
 
         transaction.commit();
@@ -2,10 +2,13 @@
 #include "add_or_reupload_problem_base.hh"
 
 #include <sim/jobs/job.hh>
+#include <sim/jobs/utils.hh>
 #include <sim/judging_config.hh>
 #include <sim/problems/problem.hh>
+#include <sim/problems/statement_cache.hh>
 #include <sim/submissions/submission.hh>
 #include <simlib/libzip.hh>
+#include <simlib/logger.hh>
 #include <simlib/sim/problem_package.hh>
 
 using sim::jobs::Job;
@@ -14,14 +17,6 @@ using sim::submissions::Submission;
 
 namespace job_server::job_handlers {
 
-void AddOrReuploadProblemBase::load_job_log_from_db() {
-    STACK_UNWINDING_MARK;
-    auto stmt = mysql.prepare("SELECT data FROM jobs WHERE id=?");
-    stmt.bind_and_execute(job_id_);
-    stmt.res_bind_all(job_log_holder_);
-    stmt.next();
-}
-
 void AddOrReuploadProblemBase::assert_transaction_is_open() {
     STACK_UNWINDING_MARK;
 
@@ -171,7 +166,7 @@ void AddOrReuploadProblemBase::job_done(bool& job_was_canceled) {
 
     auto stmt = mysql.prepare("UPDATE jobs "
                               "SET tmp_file_id=?, type=?, priority=?,"
-                              " status=?, aux_id=?, info=?, data=? "
+                              " status=?, aux_id=?, info=? "
                               "WHERE id=? AND status!=?");
     stmt.bind_and_execute(
         tmp_file_id_,
@@ -180,11 +175,13 @@ void AddOrReuploadProblemBase::job_done(bool& job_was_canceled) {
         status,
         problem_id_,
         info_.dump(),
-        get_log(),
         job_id_,
         EnumVal(Job::Status::CANCELED)
     );
     job_was_canceled = (stmt.affected_rows() == 0);
+    if (not job_was_canceled) {
+        save_log();
+    }
 }
 
 static Submission::Language filename_to_lang(StringView extension) {
@@ -245,6 +242,7 @@ void AddOrReuploadProblemBase::add_problem_to_db() {
         current_date_
     );
 
+    problem_file_id_ = tmp_file_id_;
     tmp_file_id_ = std::nullopt;
     problem_id_ = stmt.insert_id();
 }
@@ -260,8 +258,8 @@ void AddOrReuploadProblemBase::replace_problem_in_db() {
     // Add job to delete old problem file
     mysql
         .prepare("INSERT INTO jobs(file_id, creator, type, priority, status,"
-                 " added, aux_id, info, data) "
-                 "SELECT file_id, NULL, ?, ?, ?, ?, NULL, '', '' "
+                 " added, aux_id, info) "
+                 "SELECT file_id, NULL, ?, ?, ?, ?, NULL, '' "
                  "FROM problems WHERE id=?")
         .bind_and_execute(
             EnumVal(Job::Type::DELETE_FILE),
@@ -286,13 +284,14 @@ void AddOrReuploadProblemBase::replace_problem_in_db() {
         problem_id_.value()
     );
 
+    problem_file_id_ = tmp_file_id_;
     tmp_file_id_ = std::nullopt;
 
     // Schedule jobs to delete old solutions files
     mysql
         .prepare("INSERT INTO jobs(file_id, creator, type, priority, status,"
-                 " added, aux_id, info, data) "
-                 "SELECT file_id, NULL, ?, ?, ?, ?, NULL, '', '' "
+                 " added, aux_id, info) "
+                 "SELECT file_id, NULL, ?, ?, ?, ?, NULL, '' "
                  "FROM submissions "
                  "WHERE problem_id=? AND type=?")
         .bind_and_execute(
@@ -324,9 +323,8 @@ void AddOrReuploadProblemBase::submit_solutions() {
     auto submission_inserter =
         mysql.prepare("INSERT INTO submissions (file_id, owner, problem_id, "
                       "contest_problem_id, contest_round_id, contest_id, type, language, "
-                      "initial_status, full_status, submit_time, last_judgment, "
-                      "initial_report, final_report) VALUES(?, NULL, ?, NULL, NULL, "
-                      "NULL, ?, ?, ?, ?, ?, ?, '', '')");
+                      "initial_status, full_status, submit_time, last_judgment) "
+                      "VALUES(?, NULL, ?, NULL, NULL, NULL, ?, ?, ?, ?, ?, ?)");
 
     auto file_inserter = mysql.prepare("INSERT INTO internal_files VALUES()");
 
@@ -358,8 +356,8 @@ void AddOrReuploadProblemBase::submit_solutions() {
     // Add jobs to judge the solutions
     mysql
         .prepare("INSERT INTO jobs(creator, type, priority, status, added,"
-                 " aux_id, info, data) "
-                 "SELECT NULL, ?, ?, ?, ?, id, ?, '' "
+                 " aux_id, info) "
+                 "SELECT NULL, ?, ?, ?, ?, id, ? "
                  "FROM submissions "
                  "WHERE problem_id=? AND type=? ORDER BY id")
         // Problem's solutions are more important than the ordinary submissions
@@ -376,4 +374,18 @@ void AddOrReuploadProblemBase::submit_solutions() {
     job_log("Done.");
 }
 
+void AddOrReuploadProblemBase::extract_statement_to_cache() noexcept {
+    STACK_UNWINDING_MARK;
+    if (not problem_file_id_.has_value()) {
+        return;
+    }
+
+    try {
+        sim::problems::extract_statement_to_cache(*problem_file_id_, simfile_str_);
+    } catch (const std::exception& e) {
+        // Not fatal - the statement will be extracted upon the first view
+        ERRLOG_CATCH(e);
+    }
+}
+
 } // namespace job_server::job_handlers
@@ -28,8 +28,8 @@ private:
     std::string current_date_;
     std::string simfile_str_;
     sim::Simfile simfile_;
-
-    void load_job_log_from_db();
+    // Package of the added / reuploaded problem
+    std::optional<uint64_t> problem_file_id_;
 
 protected:
     AddOrReuploadProblemBase(
@@ -47,7 +47,7 @@ protected:
     , tmp_file_id_(tmp_file_id)
     , problem_id_(problem_id) {
         if (tmp_file_id.has_value()) {
-            load_job_log_from_db();
+            load_saved_log();
         }
     }
 
@@ -68,6 +68,9 @@ protected:
 
     void submit_solutions();
 
+    // Has to be called after committing the transaction
+    void extract_statement_to_cache() noexcept;
+
     using JobHandler::job_done;
 
     void job_done(bool& job_was_canceled);
@@ -35,6 +35,7 @@ void AddProblem::run() {
     if (not failed() and not canceled) {
         transaction.commit();
         package_file_remover_.cancel();
+        extract_statement_to_cache();
         return;
     }
 }
@@ -1,6 +1,8 @@
 #include "../main.hh"
 #include "change_problem_statement.hh"
 
+#include <sim/problems/statement_cache.hh>
+#include <simlib/logger.hh>
 #include <simlib/path.hh>
 #include <simlib/sim/problem_package.hh>
 
@@ -80,8 +82,8 @@ void ChangeProblemStatement::run() {
     // Add job to delete old problem file
     mysql
         .prepare("INSERT INTO jobs(file_id, creator, type, priority, status,"
-                 " added, aux_id, info, data)"
-                 " SELECT file_id, NULL, ?, ?, ?, ?, NULL, '', '' FROM problems"
+                 " added, aux_id, info)"
+                 " SELECT file_id, NULL, ?, ?, ?, ?, NULL, '' FROM problems"
                  " WHERE id=?")
         .bind_and_execute(
             EnumVal(Job::Type::DELETE_FILE),
@@ -101,6 +103,13 @@ void ChangeProblemStatement::run() {
 
     transaction.commit();
     new_pkg_remover.cancel();
+
+    try {
+        sim::problems::extract_statement_to_cache(new_file_id, simfile_str);
+    } catch (const std::exception& e) {
+        // Not fatal - the statement will be extracted upon the first view
+        ERRLOG_CATCH(e);
+    }
 }
 
 } // namespace job_server::job_handlers
@@ -1,7 +1,9 @@
 #include "../main.hh"
 #include "delete_contest_round.hh"
 
+#include <deque>
 #include <sim/jobs/job.hh>
+#include <sim/submissions/update_final.hh>
 
 using sim::jobs::Job;
 
@@ -39,8 +41,8 @@ void DeleteContestRound::run() {
     // Add jobs to delete submission files
     mysql
         .prepare("INSERT INTO jobs(file_id, creator, type, priority, status,"
-                 " added, aux_id, info, data) "
-                 "SELECT file_id, NULL, ?, ?, ?, ?, NULL, '', ''"
+                 " added, aux_id, info) "
+                 "SELECT file_id, NULL, ?, ?, ?, ?, NULL, ''"
                  " FROM submissions WHERE contest_round_id=?")
         .bind_and_execute(
             EnumVal(Job::Type::DELETE_FILE),
@@ -50,10 +52,37 @@ void DeleteContestRound::run() {
             contest_round_id_
         );
 
+    // Collect update finals (the submissions are deleted by the foreign key constraints, so the
+    // problem finals of their owners have to be reselected)
+    struct FTU {
+        mysql::Optional<uint64_t> owner;
+        uint64_t problem_id{};
+    };
+
+    std::deque<FTU> finals_to_update;
+    {
+        auto stmt = mysql.prepare("SELECT DISTINCT owner, problem_id "
+                                  "FROM submissions WHERE contest_round_id=?");
+        stmt.bind_and_execute(contest_round_id_);
+        FTU ftu_elem;
+        stmt.res_bind_all(ftu_elem.owner, ftu_elem.problem_id);
+        while (stmt.next()) {
+            finals_to_update.emplace_back(ftu_elem);
+        }
+    }
+
     // Delete contest round (all necessary actions will take place thanks to
     // foreign key constrains)
     mysql.prepare("DELETE FROM contest_rounds WHERE id=?").bind_and_execute(contest_round_id_);
 
+    // Update problem finals (contest finals were deleted along with the submissions)
+    for (const auto& ftu_elem : finals_to_update) {
+        sim::submissions::update_final_lock(mysql, ftu_elem.owner, ftu_elem.problem_id);
+        sim::submissions::update_final(
+            mysql, ftu_elem.owner, ftu_elem.problem_id, std::nullopt, false
+        );
+    }
+
     job_done();
 
     transaction.commit();
@@ -1,4 +1,5 @@
 #include "../main.hh"
+#include "../package_cache.hh"
 #include "delete_internal_file.hh"
 
 #include <sim/internal_files/internal_file.hh>
@@ -10,6 +11,9 @@ void DeleteInternalFile::run() {
 
     job_log("Internal file ID: ", internal_file_id_);
     (void)unlink(sim::internal_files::path_of(internal_file_id_));
+    (void)unlink(sim::internal_files::highlighted_source_path_of(internal_file_id_));
+    (void)unlink(sim::internal_files::statement_path_of(internal_file_id_));
+    package_cache.invalidate(internal_file_id_);
 
     auto transaction = mysql.start_transaction();
     // The internal_file may already be deleted
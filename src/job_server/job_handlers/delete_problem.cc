@@ -2,6 +2,7 @@
 #include "delete_problem.hh"
 
 #include <sim/jobs/job.hh>
+#include <sim/status_events.hh>
 
 using sim::jobs::Job;
 
@@ -39,8 +40,8 @@ void DeleteProblem::run() {
     // Add job to delete problem file
     mysql
         .prepare("INSERT INTO jobs(file_id, creator, type, priority, status,"
-                 " added, aux_id, info, data) "
-                 "SELECT file_id, NULL, ?, ?, ?, ?, NULL, '', ''"
+                 " added, aux_id, info) "
+                 "SELECT file_id, NULL, ?, ?, ?, ?, NULL, ''"
                  " FROM problems WHERE id=?")
         .bind_and_execute(
             EnumVal(Job::Type::DELETE_FILE),
@@ -53,8 +54,8 @@ void DeleteProblem::run() {
     // Add jobs to delete problem submissions' files
     mysql
         .prepare("INSERT INTO jobs(file_id, creator, type, priority, status,"
-                 " added, aux_id, info, data) "
-                 "SELECT file_id, NULL, ?, ?, ?, ?, NULL, '', ''"
+                 " added, aux_id, info) "
+                 "SELECT file_id, NULL, ?, ?, ?, ?, NULL, ''"
                  " FROM submissions WHERE problem_id=?")
         .bind_and_execute(
             EnumVal(Job::Type::DELETE_FILE),
@@ -71,6 +72,7 @@ void DeleteProblem::run() {
     job_done();
 
     transaction.commit();
+    sim::status_events::publish(sim::status_events::Kind::PROBLEM, problem_id_);
 }
 
 } // namespace job_server::job_handlers
@@ -1,7 +1,9 @@
 #include "../main.hh"
 #include "delete_user.hh"
 
+#include <sim/contest_ranking_snapshots/contest_ranking_snapshot.hh>
 #include <sim/jobs/job.hh>
+#include <sim/status_events.hh>
 #include <sim/users/user.hh>
 
 using sim::jobs::Job;
@@ -32,8 +34,8 @@ void DeleteUser::run() {
     // Add jobs to delete submission files
     mysql
         .prepare("INSERT INTO jobs(file_id, creator, type, priority, status,"
-                 " added, aux_id, info, data) "
-                 "SELECT file_id, NULL, ?, ?, ?, ?, NULL, '', ''"
+                 " added, aux_id, info) "
+                 "SELECT file_id, NULL, ?, ?, ?, ?, NULL, ''"
                  " FROM submissions WHERE owner=?")
         .bind_and_execute(
             EnumVal(Job::Type::DELETE_FILE),
@@ -43,6 +45,8 @@ void DeleteUser::run() {
             user_id_
         );
 
+    sim::contest_ranking_snapshots::invalidate_of_user(mysql, user_id_);
+
     // Delete user (all necessary actions will take place thanks to foreign key
     // constrains)
     mysql.prepare("DELETE FROM users WHERE id=?").bind_and_execute(user_id_);
@@ -50,6 +54,7 @@ void DeleteUser::run() {
     job_done();
 
     transaction.commit();
+    sim::status_events::publish(sim::status_events::Kind::USER, user_id_);
 }
 
 } // namespace job_server::job_handlers
@@ -1,31 +1,96 @@
 #include "../main.hh"
 #include "job_handler.hh"
 
+#include <algorithm>
 #include <sim/jobs/job.hh>
+#include <sim/jobs/utils.hh>
 
 using sim::jobs::Job;
 
 namespace job_server::job_handlers {
 
+void JobHandler::load_saved_log() {
+    STACK_UNWINDING_MARK;
+
+    job_log_holder_.clear();
+    job_log_holder_.append(sim::jobs::load_log(mysql, job_id_));
+    saved_log_size_ = job_log_holder_.size;
+    log_tail_saved_ = false;
+}
+
+void JobHandler::save_log_at(uint64_t pos_beg, uint64_t pos_end) {
+    log_pos_beg_ = pos_beg;
+    log_pos_end_ = pos_end;
+    saved_log_size_ = 0;
+    log_tail_saved_ = false;
+}
+
+void JobHandler::save_log(std::optional<uint64_t> tail_pos) {
+    STACK_UNWINDING_MARK;
+
+    // The part beyond the size limit is kept only in the final log (it gets truncated there)
+    StringView log = get_log();
+    auto max_size = std::min<uint64_t>(sim::jobs::job_log_max_size, log_pos_end_ - log_pos_beg_);
+    log = log.substr(0, std::min<uint64_t>(log.size(), max_size));
+    auto tail_beg = std::min<uint64_t>(tail_pos.value_or(log.size()), log.size());
+    tail_beg = std::max(tail_beg, saved_log_size_);
+    if (saved_log_size_ < tail_beg or log_tail_saved_) {
+        sim::jobs::save_log_part(
+            mysql,
+            job_id_,
+            log_pos_beg_ + saved_log_size_,
+            log.substr(saved_log_size_, tail_beg - saved_log_size_),
+            log_pos_end_
+        );
+        saved_log_size_ = tail_beg;
+        log_tail_saved_ = false;
+    }
+    if (tail_beg < log.size()) {
+        sim::jobs::save_log_part(
+            mysql, job_id_, log_pos_beg_ + tail_beg, log.substr(tail_beg), log_pos_end_
+        );
+        log_tail_saved_ = true;
+    }
+}
+
+void JobHandler::save_whole_log(StringView log) {
+    STACK_UNWINDING_MARK;
+    sim::jobs::save_final_log(mysql, job_id_, log);
+}
+
+void JobHandler::save_final_log(StringView log_suffix) {
+    STACK_UNWINDING_MARK;
+
+    if (log_suffix.empty()) {
+        save_whole_log(get_log());
+    } else {
+        save_whole_log(concat(get_log(), log_suffix));
+    }
+    save_log_at(0, std::numeric_limits<uint64_t>::max());
+}
+
 void JobHandler::job_canceled() {
     STACK_UNWINDING_MARK;
 
-    mysql.prepare("UPDATE jobs SET status=?, data=? WHERE id=?")
-        .bind_and_execute(EnumVal(Job::Status::CANCELED), get_log(), job_id_);
+    save_final_log();
+    mysql.prepare("UPDATE jobs SET status=? WHERE id=?")
+        .bind_and_execute(EnumVal(Job::Status::CANCELED), job_id_);
 }
 
 void JobHandler::job_done() {
     STACK_UNWINDING_MARK;
 
-    mysql.prepare("UPDATE jobs SET status=?, data=? WHERE id=?")
-        .bind_and_execute(EnumVal(Job::Status::DONE), get_log(), job_id_);
+    save_final_log();
+    mysql.prepare("UPDATE jobs SET status=? WHERE id=?")
+        .bind_and_execute(EnumVal(Job::Status::DONE), job_id_);
 }
 
 void JobHandler::job_done(StringView new_info) {
     STACK_UNWINDING_MARK;
 
-    mysql.prepare("UPDATE jobs SET status=?, info=?, data=? WHERE id=?")
-        .bind_and_execute(EnumVal(Job::Status::DONE), new_info, get_log(), job_id_);
+    save_final_log();
+    mysql.prepare("UPDATE jobs SET status=?, info=? WHERE id=?")
+        .bind_and_execute(EnumVal(Job::Status::DONE), new_info, job_id_);
 }
 
 } // namespace job_server::job_handlers
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <limits>
+#include <optional>
 #include <simlib/sim/conver.hh>
 
 namespace job_server::job_handlers {
@@ -7,6 +9,12 @@ namespace job_server::job_handlers {
 class JobHandler {
 private:
     bool job_failed_ = false;
+    // The log is saved append-only at the positions [log_pos_beg_, log_pos_end_) of the job's log,
+    // so only its part past this prefix needs to be written
+    uint64_t saved_log_size_ = 0;
+    uint64_t log_pos_beg_ = 0;
+    uint64_t log_pos_end_ = std::numeric_limits<uint64_t>::max();
+    bool log_tail_saved_ = false;
 
 protected:
     const uint64_t job_id_;
@@ -33,6 +41,16 @@ protected:
         job_canceled();
     }
 
+    // Continues the log saved by the previous run of the job
+    void load_saved_log();
+
+    // Makes save_log() use only the positions [@p pos_beg, @p pos_end) of the job's log, e.g. so
+    // that handlers running the same job concurrently do not overwrite each other's logs
+    void save_log_at(uint64_t pos_beg, uint64_t pos_end);
+
+    // Saves @p log as the whole log of the finished job
+    virtual void save_whole_log(StringView log);
+
     virtual void job_canceled();
 
     virtual void job_done();
@@ -51,6 +69,13 @@ public:
     [[nodiscard]] bool failed() const noexcept { return job_failed_; }
 
     [[nodiscard]] const auto& get_log() const noexcept { return job_log_holder_; }
+
+    // Saves the part of the log that has not been saved yet. The part from byte @p tail_pos on is
+    // saved only until the next call, as the caller is going to drop it from the log.
+    void save_log(std::optional<uint64_t> tail_pos = std::nullopt);
+
+    // Saves the whole log (followed by @p log_suffix) compressed, once the job is finished
+    void save_final_log(StringView log_suffix = {});
 };
 
 } // namespace job_server::job_handlers
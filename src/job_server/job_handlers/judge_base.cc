@@ -1,7 +1,21 @@
+#include "../compilation_cache.hh"
+#include "../cpu_pool.hh"
 #include "judge_base.hh"
 
+#include <condition_variable>
+#include <cstdlib>
+#include <exception>
+#include <mutex>
+#include <sim/cpu_affinity.hh>
 #include <sim/judging_config.hh>
+#include <simlib/call_in_destructor.hh>
+#include <simlib/concat.hh>
+#include <simlib/concat_tostr.hh>
 #include <simlib/enum_val.hh>
+#include <simlib/file_contents.hh>
+#include <simlib/file_manip.hh>
+#include <simlib/sha.hh>
+#include <thread>
 
 using sim::submissions::Submission;
 
@@ -187,12 +201,33 @@ void JudgeBase::load_problem_package(FilePath problem_pkg_path) {
     auto tmplog = job_log("Loading problem package...");
     tmplog.flush_no_nl();
     jworker_.load_package(problem_pkg_path, std::nullopt);
+    package_path_ = problem_pkg_path.to_str();
+    tmplog(" done.");
+}
+
+void JudgeBase::load_problem_package(
+    decltype(sim::internal_files::InternalFile::id) problem_file_id
+) {
+    STACK_UNWINDING_MARK;
+    if (failed()) {
+        return;
+    }
+
+    auto tmplog = job_log("Loading problem package...");
+    tmplog.flush_no_nl();
+    cached_package_.reset();
+    cached_package_.emplace(package_cache.get(problem_file_id));
+    jworker_.load_package(cached_package_->path(), std::nullopt);
+    package_path_ = cached_package_->path();
     tmplog(" done.");
 }
 
 template <class MethodPtr>
 std::optional<std::string> JudgeBase::compile_solution_impl(
-    FilePath solution_path, sim::SolutionLanguage lang, MethodPtr compile_method
+    FilePath solution_path,
+    sim::SolutionLanguage lang,
+    MethodPtr compile_method,
+    const std::optional<std::string>& cache_key
 ) {
     STACK_UNWINDING_MARK;
     if (failed()) {
@@ -202,16 +237,33 @@ std::optional<std::string> JudgeBase::compile_solution_impl(
     auto tmplog = job_log("Compiling solution...");
     tmplog.flush_no_nl();
 
-    std::string compilation_errors;
-    if ((jworker_.*compile_method
-        )(solution_path,
-          lang,
-          sim::SOLUTION_COMPILATION_TIME_LIMIT,
-          &compilation_errors,
-          sim::COMPILATION_ERRORS_MAX_LENGTH,
-          sim::PROOT_PATH))
-    {
-        tmplog(" failed:\n", compilation_errors);
+    auto compile = [&](const std::optional<std::string>& save_path) -> std::optional<std::string> {
+        std::string compilation_errors;
+        if ((jworker_.*compile_method
+            )(solution_path,
+              lang,
+              sim::SOLUTION_COMPILATION_TIME_LIMIT,
+              &compilation_errors,
+              sim::COMPILATION_ERRORS_MAX_LENGTH,
+              sim::PROOT_PATH))
+        {
+            return compilation_errors;
+        }
+        if (save_path) {
+            jworker_.save_compiled_solution(*save_path);
+        }
+        return std::nullopt;
+    };
+
+    auto compilation_errors = cache_key
+        ? solution_cache.get(
+              *cache_key,
+              compile,
+              [&](const std::string& path) { jworker_.load_compiled_solution(path); }
+          )
+        : compile(std::nullopt);
+    if (compilation_errors) {
+        tmplog(" failed:\n", *compilation_errors);
         return compilation_errors;
     }
 
@@ -222,7 +274,18 @@ std::optional<std::string> JudgeBase::compile_solution_impl(
 std::optional<std::string>
 JudgeBase::compile_solution(FilePath solution_path, sim::SolutionLanguage lang) {
     STACK_UNWINDING_MARK;
-    return compile_solution_impl(solution_path, lang, &sim::JudgeWorker::compile_solution);
+    if (failed()) {
+        return std::nullopt;
+    }
+
+    // The cache is keyed by everything the compilation depends on, but the compiler, which is
+    // handled by the cache itself
+    auto cache_key = sha3_512(concat(
+        static_cast<int>(lang), '\0', get_file_contents(solution_path)
+    ));
+    return compile_solution_impl(
+        solution_path, lang, &sim::JudgeWorker::compile_solution, cache_key.to_string()
+    );
 }
 
 std::optional<std::string> JudgeBase::compile_solution_from_problem_package(
@@ -230,7 +293,7 @@ std::optional<std::string> JudgeBase::compile_solution_from_problem_package(
 ) {
     STACK_UNWINDING_MARK;
     return compile_solution_impl(
-        solution_path, lang, &sim::JudgeWorker::compile_solution_from_package
+        solution_path, lang, &sim::JudgeWorker::compile_solution_from_package, std::nullopt
     );
 }
 
@@ -243,15 +306,44 @@ std::optional<std::string> JudgeBase::compile_checker() {
     auto tmplog = job_log("Compiling checker...");
     tmplog.flush_no_nl();
 
-    std::string compilation_errors;
-    if (jworker_.compile_checker(
-            sim::SOLUTION_COMPILATION_TIME_LIMIT,
-            &compilation_errors,
-            sim::COMPILATION_ERRORS_MAX_LENGTH,
-            sim::PROOT_PATH
-        ))
-    {
-        tmplog(" failed:\n", compilation_errors);
+    auto compile = [&](const std::optional<std::string>& save_path) -> std::optional<std::string> {
+        std::string compilation_errors;
+        if (jworker_.compile_checker(
+                sim::SOLUTION_COMPILATION_TIME_LIMIT,
+                &compilation_errors,
+                sim::COMPILATION_ERRORS_MAX_LENGTH,
+                sim::PROOT_PATH
+            ))
+        {
+            return compilation_errors;
+        }
+        if (save_path) {
+            jworker_.save_compiled_checker(*save_path);
+        }
+        return std::nullopt;
+    };
+
+    // The checker's source is easily accessible only in the unpacked package
+    std::optional<std::string> compilation_errors;
+    if (cached_package_ and cached_package_->is_unpacked()) {
+        const auto& checker = jworker_.simfile().checker;
+        auto source_hash = checker
+            ? sha3_512(concat(
+                  *checker, '\0', get_file_contents(concat(cached_package_->path(), *checker))
+              ))
+            : sha3_512("default checker");
+
+        compilation_errors = checker_cache.get(
+            source_hash.to_string(),
+            compile,
+            [&](const std::string& path) { jworker_.load_compiled_checker(path); }
+        );
+    } else {
+        compilation_errors = compile(std::nullopt);
+    }
+
+    if (compilation_errors) {
+        tmplog(" failed:\n", *compilation_errors);
         return compilation_errors;
     }
 
@@ -259,4 +351,144 @@ std::optional<std::string> JudgeBase::compile_checker() {
     return std::nullopt;
 }
 
+sim::JudgeReport JudgeBase::judge(
+    bool final, bool in_parallel, const PartialReportCallback& partial_report_callback
+) {
+    STACK_UNWINDING_MARK;
+
+    auto groups_no = jworker_.simfile().tgroups.size();
+    if (in_parallel and groups_no > 1) {
+        auto lease = parallel_judging_cpus.acquire(groups_no);
+        if (lease.cpus().size() > 1) {
+            return judge_in_parallel(final, lease.cpus(), partial_report_callback);
+        }
+    }
+    sim::VerboseJudgeLogger logger(true);
+    return jworker_.judge(final, logger, partial_report_callback);
+}
+
+sim::JudgeReport JudgeBase::judge_in_parallel(
+    bool final, const std::vector<int>& cpus, const PartialReportCallback& partial_report_callback
+) {
+    STACK_UNWINDING_MARK;
+
+    // Split the test groups into contiguous shards with similar numbers of tests, so that
+    // concatenating the shards' reports keeps the groups in order
+    auto& simfile = jworker_.simfile();
+    simfile.load_all(); // Everything is needed as we will dump the shards' Simfiles
+    size_t tests_left = 0;
+    for (auto& group : simfile.tgroups) {
+        tests_left += group.tests.size();
+    }
+    std::vector<std::string> shard_simfiles;
+    {
+        auto shard_sf = simfile;
+        auto begin = simfile.tgroups.begin();
+        while (begin != simfile.tgroups.end()) {
+            size_t shards_left = cpus.size() - shard_simfiles.size();
+            size_t target = (tests_left + shards_left - 1) / shards_left;
+            size_t tests = 0;
+            auto end = begin;
+            // Leave at least one group for each of the remaining shards
+            while (end != simfile.tgroups.end() and
+                   (end == begin or
+                    (tests < target and
+                     static_cast<size_t>(simfile.tgroups.end() - end) >= shards_left)))
+            {
+                tests += end->tests.size();
+                ++end;
+            }
+            shard_sf.tgroups.assign(begin, end);
+            shard_simfiles.emplace_back(shard_sf.dump());
+            tests_left -= tests;
+            begin = end;
+        }
+    }
+
+    // The shards' workers load the already compiled programs
+    std::string tmp_dir = "/tmp/sim-parallel-judging.XXXXXX";
+    if (not mkdtemp(tmp_dir.data())) {
+        THROW("mkdtemp()", errmsg());
+    }
+    CallInDtor tmp_dir_remover([&] { (void)remove_r(tmp_dir); });
+    auto solution_path = concat_tostr(tmp_dir, "/solution");
+    auto checker_path = concat_tostr(tmp_dir, "/checker");
+    jworker_.save_compiled_solution(solution_path);
+    jworker_.save_compiled_checker(checker_path);
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<sim::JudgeReport> reports(shard_simfiles.size());
+    std::vector<std::exception_ptr> errors(shard_simfiles.size());
+    size_t finished = 0;
+    bool new_partial_report = false;
+
+    auto merge_reports = [&reports] {
+        sim::JudgeReport merged;
+        for (auto& rep : reports) {
+            merged.groups.insert(merged.groups.end(), rep.groups.begin(), rep.groups.end());
+            merged.judge_log += rep.judge_log;
+        }
+        return merged;
+    };
+
+    std::vector<std::thread> threads;
+    CallInDtor threads_joiner([&] {
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    });
+    for (size_t i = 0; i < shard_simfiles.size(); ++i) {
+        threads.emplace_back([&, i] {
+            try {
+                sim::cpu_affinity::pin_current_thread_to(cpus[i]);
+                sim::JudgeWorker worker;
+                worker.checker_time_limit = jworker_.checker_time_limit;
+                worker.checker_memory_limit = jworker_.checker_memory_limit;
+                worker.score_cut_lambda = jworker_.score_cut_lambda;
+                worker.load_package(package_path_, shard_simfiles[i]);
+                worker.load_compiled_solution(solution_path);
+                worker.load_compiled_checker(checker_path);
+
+                sim::VerboseJudgeLogger logger(true);
+                auto rep = worker.judge(final, logger, [&](const sim::JudgeReport& partial) {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    reports[i] = partial;
+                    new_partial_report = true;
+                    cv.notify_one();
+                });
+                std::lock_guard<std::mutex> lock(mtx);
+                reports[i] = std::move(rep);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mtx);
+                errors[i] = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(mtx);
+            ++finished;
+            cv.notify_one();
+        });
+    }
+
+    // Partial reports are sent from this thread, as the database connection is thread-local
+    std::unique_lock<std::mutex> lock(mtx);
+    for (;;) {
+        cv.wait(lock, [&] { return new_partial_report or finished == threads.size(); });
+        if (finished == threads.size()) {
+            break;
+        }
+        new_partial_report = false;
+        auto merged = merge_reports();
+        lock.unlock();
+        partial_report_callback(merged);
+        lock.lock();
+    }
+
+    for (auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    return merge_reports();
+}
+
 } // namespace job_server::job_handlers
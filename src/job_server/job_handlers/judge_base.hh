@@ -1,13 +1,22 @@
 #pragma once
 
+#include "../package_cache.hh"
 #include "job_handler.hh"
 
+#include <functional>
+#include <optional>
 #include <sim/submissions/submission.hh>
 #include <simlib/sim/judge_worker.hh>
+#include <string>
+#include <vector>
 
 namespace job_server::job_handlers {
 
 class JudgeBase : virtual public JobHandler {
+    // Declared before jworker_, so that the package is released after jworker_ is destroyed
+    std::optional<PackageCache::Handle> cached_package_;
+    std::string package_path_; // of the loaded package
+
 protected:
     sim::JudgeWorker jworker_;
 
@@ -23,11 +32,18 @@ protected:
 
     void load_problem_package(FilePath problem_pkg_path);
 
+    // Loads the package of the internal file @p problem_file_id using the package cache
+    void load_problem_package(decltype(sim::internal_files::InternalFile::id) problem_file_id);
+
 private:
-    // Iff compilation failed, compilation errors are returned
+    // Iff compilation failed, compilation errors are returned. If @p cache_key is set, the
+    // compiled solution is cached in the solution cache.
     template <class MethodPtr>
     std::optional<std::string> compile_solution_impl(
-        FilePath solution_path, sim::SolutionLanguage lang, MethodPtr compile_method
+        FilePath solution_path,
+        sim::SolutionLanguage lang,
+        MethodPtr compile_method,
+        const std::optional<std::string>& cache_key
     );
 
 protected:
@@ -39,6 +55,22 @@ protected:
     compile_solution_from_problem_package(FilePath solution_path, sim::SolutionLanguage lang);
 
     std::optional<std::string> compile_checker();
+
+    using PartialReportCallback = std::function<void(const sim::JudgeReport&)>;
+
+    // Judges the compiled solution like jworker_.judge(). If @p in_parallel is true, the test
+    // groups are split into contiguous shards judged concurrently, each on its own cpu taken from
+    // parallel_judging_cpus, and the shards' reports are merged in order. Without at least two
+    // free cpus, the groups are judged one after another.
+    sim::JudgeReport
+    judge(bool final, bool in_parallel, const PartialReportCallback& partial_report_callback);
+
+private:
+    sim::JudgeReport judge_in_parallel(
+        bool final,
+        const std::vector<int>& cpus,
+        const PartialReportCallback& partial_report_callback
+    );
 };
 
 } // namespace job_server::job_handlers
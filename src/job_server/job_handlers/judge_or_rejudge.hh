@@ -1,19 +1,18 @@
 #pragma once
 
-#include "judge_base.hh"
+#include "judge_submission_base.hh"
 
 namespace job_server::job_handlers {
 
-class JudgeOrRejudge final : public JudgeBase {
+class JudgeOrRejudge final : public JudgeSubmissionBase {
 private:
     const uint64_t submission_id_;
-    const StringView job_creation_time_;
 
 public:
     JudgeOrRejudge(uint64_t job_id, uint64_t submission_id, StringView job_creation_time)
     : JobHandler(job_id)
-    , submission_id_(submission_id)
-    , job_creation_time_(job_creation_time) {}
+    , JudgeSubmissionBase(job_creation_time)
+    , submission_id_(submission_id) {}
 
     void run() override;
 };
@@ -0,0 +1,340 @@
+#include "../main.hh"
+#include "judge_submission_base.hh"
+
+#include <chrono>
+#include <sim/status_events.hh>
+#include <sim/submissions/submission.hh>
+#include <sim/submissions/update_final.hh>
+
+using sim::submissions::Submission;
+
+namespace job_server::job_handlers {
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+std::chrono::milliseconds partial_judge_reports_interval{0};
+
+JudgeSubmissionBase::JudgingResult
+JudgeSubmissionBase::judge_submission(decltype(Submission::id) submission_id) {
+    STACK_UNWINDING_MARK;
+
+    // Gather the needed information about the submission
+    auto stmt = mysql.prepare("SELECT s.file_id, s.language, s.owner,"
+                              " s.contest_problem_id, s.problem_id,"
+                              " s.last_judgment, p.file_id, p.updated_at,"
+                              " p.parallel_judging "
+                              "FROM submissions s, problems p "
+                              "WHERE p.id=problem_id AND s.id=?");
+    stmt.bind_and_execute(submission_id);
+    uint64_t submission_file_id = 0;
+    uint64_t problem_file_id = 0;
+    uint64_t problem_id = 0;
+    mysql::Optional<uint64_t> sowner;
+    mysql::Optional<uint64_t> contest_problem_id;
+    InplaceBuff<64> last_judgment;
+    InplaceBuff<64> p_updated_at;
+    bool parallel_judging = false;
+    EnumVal<Submission::Language> lang{};
+    stmt.res_bind_all(
+        submission_file_id,
+        lang,
+        sowner,
+        contest_problem_id,
+        problem_id,
+        last_judgment,
+        problem_file_id,
+        p_updated_at,
+        parallel_judging
+    );
+    // If the submission doesn't exist (probably was removed)
+    if (not stmt.next()) {
+        return JudgingResult::NO_SUCH_SUBMISSION;
+    }
+
+    // If the problem wasn't modified since last judgment and submission has
+    // already been rejudged after the job was created
+    if (last_judgment > p_updated_at and last_judgment > job_creation_time_) {
+        return JudgingResult::ALREADY_REJUDGED;
+    }
+
+    std::string judging_began = mysql_date();
+
+    job_log("Judging submission ", submission_id, " (problem: ", problem_id, ')');
+    if (loaded_problem_file_id_ != problem_file_id) {
+        load_problem_package(problem_file_id);
+        loaded_problem_file_id_ = problem_file_id;
+        checker_compilation_errors_ = std::nullopt;
+    }
+
+    auto update_submission = [&](decltype(Submission::initial_status) initial_status,
+                                 decltype(Submission::full_status) full_status,
+                                 std::optional<int64_t> score,
+                                 auto&& initial_report,
+                                 auto&& final_report,
+                                 bool partial = false) {
+        {
+            auto transaction = mysql.start_transaction();
+            if (partial) {
+                // Partial results only refresh what is displayed, so the final submissions are
+                // left to be recomputed by the subsequent complete report
+                stmt = mysql.prepare("SELECT 1 FROM submissions WHERE id=?");
+                stmt.bind_and_execute(submission_id);
+                if (not stmt.next()) {
+                    return; // Ignore errors (deleted submission)
+                }
+
+                stmt = mysql.prepare("UPDATE submissions "
+                                     "SET initial_status=?, full_status=?, score=? "
+                                     "WHERE id=?");
+                if (is_fatal(full_status)) {
+                    stmt.bind_and_execute(initial_status, full_status, nullptr, submission_id);
+                } else {
+                    stmt.bind_and_execute(initial_status, full_status, score, submission_id);
+                }
+                mysql
+                    .prepare("INSERT INTO submission_reports(submission_id, initial_report,"
+                             " final_report) VALUES(?, ?, ?) "
+                             "ON DUPLICATE KEY UPDATE initial_report=VALUES(initial_report),"
+                             " final_report=VALUES(final_report)")
+                    .bind_and_execute(submission_id, initial_report, final_report);
+
+                transaction.commit();
+                sim::status_events::publish(sim::status_events::Kind::SUBMISSION, submission_id);
+                return;
+            }
+
+            sim::submissions::update_final_lock(mysql, sowner, problem_id);
+
+            using ST = Submission::Type;
+            // Get the submission's ACTUAL type
+            stmt = mysql.prepare("SELECT type FROM submissions WHERE id=?");
+            stmt.bind_and_execute(submission_id);
+            EnumVal<ST> stype{};
+            stmt.res_bind_all(stype);
+            if (not stmt.next()) {
+                return; // Ignore errors (deleted submission)
+            }
+
+            // Update submission
+            stmt = mysql.prepare("UPDATE submissions "
+                                 "SET final_candidate=?, initial_status=?,"
+                                 " full_status=?, score=?, last_judgment=? "
+                                 "WHERE id=?");
+
+            if (is_fatal(full_status)) {
+                stmt.bind_and_execute(
+                    false,
+                    initial_status,
+                    full_status,
+                    nullptr,
+                    judging_began,
+                    submission_id
+                );
+            } else {
+                stmt.bind_and_execute(
+                    (stype == ST::NORMAL and score.has_value()),
+                    initial_status,
+                    full_status,
+                    score,
+                    judging_began,
+                    submission_id
+                );
+            }
+
+            mysql
+                .prepare("INSERT INTO submission_reports(submission_id, initial_report,"
+                         " final_report) VALUES(?, ?, ?) "
+                         "ON DUPLICATE KEY UPDATE initial_report=VALUES(initial_report),"
+                         " final_report=VALUES(final_report)")
+                .bind_and_execute(submission_id, initial_report, final_report);
+
+            sim::submissions::update_final(mysql, sowner, problem_id, contest_problem_id, false);
+
+            transaction.commit();
+        }
+        sim::status_events::publish(sim::status_events::Kind::SUBMISSION, submission_id);
+    };
+
+    auto compilation_errors =
+        compile_solution(sim::internal_files::path_of(submission_file_id), to_sol_lang(lang));
+    if (compilation_errors.has_value()) {
+        update_submission(
+            Submission::Status::COMPILATION_ERROR,
+            Submission::Status::COMPILATION_ERROR,
+            std::nullopt,
+            concat(
+                "<pre class=\"compilation-errors\">",
+                html_escape(compilation_errors.value()),
+                "</pre>"
+            ),
+            ""
+        );
+
+        return JudgingResult::JUDGED;
+    }
+
+    // Compile checker
+    if (not checker_compilation_errors_) {
+        checker_compilation_errors_ = compile_checker();
+    }
+    compilation_errors = *checker_compilation_errors_;
+    if (compilation_errors.has_value()) {
+        errlog(
+            "Job ",
+            job_id_,
+            " (submission ",
+            submission_id,
+            ", problem ",
+            problem_id,
+            "): Checker compilation failed"
+        );
+        update_submission(
+            Submission::Status::CHECKER_COMPILATION_ERROR,
+            Submission::Status::CHECKER_COMPILATION_ERROR,
+            std::nullopt,
+            "",
+            ""
+        );
+
+        return JudgingResult::JUDGED;
+    }
+
+    auto send_judge_report = [&,
+                              initial_status = Submission::Status::OK,
+                              initial_report = InplaceBuff<1 << 16>(),
+                              initial_score = static_cast<int64_t>(0),
+                              last_partial_report_time = std::chrono::steady_clock::now()](
+                                 const sim::JudgeReport& jreport, bool final, bool partial
+                             ) mutable {
+        if (partial) {
+            auto now = std::chrono::steady_clock::now();
+            if (now - last_partial_report_time < partial_judge_reports_interval) {
+                return;
+            }
+            last_partial_report_time = now;
+        }
+
+        auto rep = construct_report(jreport, final);
+        auto status = calc_status(jreport);
+        // Count score
+        int64_t score = 0;
+        for (auto&& group : jreport.groups) {
+            score += group.score;
+        }
+
+        // Log reports
+        auto job_log_len = job_log_holder_.size;
+        job_log(
+            "Job ",
+            job_id_,
+            " -> submission ",
+            submission_id,
+            " (problem ",
+            problem_id,
+            ")\n",
+            (partial ? "Partial j" : "J"),
+            "udge report: ",
+            jreport.judge_log
+        );
+
+        // The partial report is saved only until the next one replaces it
+        save_log(partial ? std::optional<uint64_t>(job_log_len) : std::nullopt);
+        if (partial) {
+            job_log_holder_.size = job_log_len;
+        }
+
+        if (not final) {
+            initial_report = rep;
+            initial_status = status;
+            initial_score = score;
+            return update_submission(
+                status, Submission::Status::PENDING, std::nullopt, rep, "", partial
+            );
+        }
+
+        // Final
+        score += initial_score;
+        // If initial tests haven't passed
+        if (initial_status != Submission::Status::OK and status != Submission::Status::JUDGE_ERROR)
+        {
+            status = initial_status;
+        }
+
+        update_submission(initial_status, status, score, initial_report, rep, partial);
+    };
+
+    try {
+        // Judge
+        sim::JudgeReport initial_jrep =
+            judge(false, parallel_judging, [&](const sim::JudgeReport& partial) {
+                send_judge_report(partial, false, true);
+            });
+        send_judge_report(initial_jrep, false, false);
+
+        sim::JudgeReport final_jrep =
+            judge(true, parallel_judging, [&](const sim::JudgeReport& partial) {
+                send_judge_report(partial, true, true);
+            });
+        send_judge_report(final_jrep, true, false);
+
+        // Log checker errors
+        for (auto&& rep : {initial_jrep, final_jrep}) {
+            for (auto&& group : rep.groups) {
+                for (auto&& test : group.tests) {
+                    if (test.status == sim::JudgeReport::Test::CHECKER_ERROR) {
+                        errlog(
+                            "Checker error: submission ",
+                            submission_id,
+                            " (problem id: ",
+                            problem_id,
+                            ") test `",
+                            test.name,
+                            '`'
+                        );
+                    }
+                }
+            }
+        }
+
+        // Log syscall problems (to errlog)
+        for (auto&& rep : {initial_jrep, final_jrep}) {
+            for (auto&& group : rep.groups) {
+                for (auto&& test : group.tests) {
+                    if (has_one_of_prefixes(
+                            test.comment,
+                            "Runtime error (Error: ",
+                            "Runtime error (failed to get syscall",
+                            "Runtime error (forbidden syscall"
+                        ))
+                    {
+                        errlog(
+                            "Submission ",
+                            submission_id,
+                            " (problem ",
+                            problem_id,
+                            "): ",
+                            test.name,
+                            " -> ",
+                            test.comment
+                        );
+                    }
+                }
+            }
+        }
+
+        return JudgingResult::JUDGED;
+
+    } catch (const std::exception& e) {
+        ERRLOG_CATCH(e);
+
+        job_log("Judge error.");
+        job_log("Caught exception -> ", e.what());
+
+        update_submission(
+            Submission::Status::JUDGE_ERROR, Submission::Status::JUDGE_ERROR, std::nullopt, "", ""
+        );
+
+        return JudgingResult::JUDGED;
+    }
+}
+
+} // namespace job_server::job_handlers
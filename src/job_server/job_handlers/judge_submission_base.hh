@@ -0,0 +1,37 @@
+#pragma once
+
+#include "judge_base.hh"
+
+#include <chrono>
+#include <optional>
+#include <sim/internal_files/internal_file.hh>
+#include <sim/submissions/submission.hh>
+
+namespace job_server::job_handlers {
+
+// Minimal time between saving two partial judge reports of a submission (0 saves each of them);
+// the reports arriving in between are dropped, as the next ones supersede them
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+extern std::chrono::milliseconds partial_judge_reports_interval;
+
+class JudgeSubmissionBase : public JudgeBase {
+    // The package and the checker are loaded once and reused for the subsequent submissions
+    std::optional<decltype(sim::internal_files::InternalFile::id)> loaded_problem_file_id_;
+    std::optional<std::optional<std::string>> checker_compilation_errors_;
+
+protected:
+    const StringView job_creation_time_;
+
+    explicit JudgeSubmissionBase(StringView job_creation_time)
+    : job_creation_time_(job_creation_time) {}
+
+    enum class JudgingResult {
+        JUDGED,
+        ALREADY_REJUDGED, // after the job had been scheduled
+        NO_SUCH_SUBMISSION,
+    };
+
+    JudgingResult judge_submission(decltype(sim::submissions::Submission::id) submission_id);
+};
+
+} // namespace job_server::job_handlers
@@ -2,6 +2,7 @@
 #include "merge_problems.hh"
 
 #include <deque>
+#include <sim/status_events.hh>
 #include <sim/submissions/submission.hh>
 #include <sim/submissions/update_final.hh>
 
@@ -16,6 +17,7 @@ void MergeProblems::run() {
     for (;;) {
         try {
             run_impl();
+            sim::status_events::publish(sim::status_events::Kind::PROBLEM, donor_problem_id_);
             break;
         } catch (const std::exception& e) {
             if (has_prefix(
@@ -63,8 +65,8 @@ void MergeProblems::run_impl() {
     // Add job to delete problem file
     mysql
         .prepare("INSERT INTO jobs(file_id, creator, type, priority, status,"
-                 " added, aux_id, info, data) "
-                 "SELECT file_id, NULL, ?, ?, ?, ?, NULL, '', '' "
+                 " added, aux_id, info) "
+                 "SELECT file_id, NULL, ?, ?, ?, ?, NULL, '' "
                  "FROM problems WHERE id=?")
         .bind_and_execute(
             EnumVal(Job::Type::DELETE_FILE),
@@ -77,8 +79,8 @@ void MergeProblems::run_impl() {
     // Add jobs to delete problem solutions' files
     mysql
         .prepare("INSERT INTO jobs(file_id, creator, type, priority, status,"
-                 " added, aux_id, info, data) "
-                 "SELECT file_id, NULL, ?, ?, ?, ?, NULL, '', '' "
+                 " added, aux_id, info) "
+                 "SELECT file_id, NULL, ?, ?, ?, ?, NULL, '' "
                  "FROM submissions WHERE problem_id=? AND "
                  "type=?")
         .bind_and_execute(
@@ -118,8 +120,8 @@ void MergeProblems::run_impl() {
     if (info_.rejudge_transferred_submissions) {
         mysql
             .prepare("INSERT INTO jobs(creator, status, priority, type, added,"
-                     " aux_id, info, data) "
-                     "SELECT NULL, ?, ?, ?, ?, id, ?, '' "
+                     " aux_id, info) "
+                     "SELECT NULL, ?, ?, ?, ?, id, ? "
                      "FROM submissions WHERE problem_id=? ORDER BY id")
             .bind_and_execute(
                 EnumVal(Job::Status::PENDING),
@@ -3,6 +3,7 @@
 
 #include <deque>
 #include <sim/contest_users/contest_user.hh>
+#include <sim/status_events.hh>
 #include <sim/submissions/update_final.hh>
 #include <simlib/utilities.hh>
 
@@ -16,6 +17,8 @@ void MergeUsers::run() {
     for (;;) {
         try {
             run_impl();
+            // The target user got the donor's contest memberships
+            sim::status_events::publish(sim::status_events::Kind::USER, info_.target_user_id);
             break;
         } catch (const std::exception& e) {
             if (has_prefix(
@@ -0,0 +1,190 @@
+#include "../main.hh"
+#include "rejudge_problem_batch.hh"
+
+#include <sim/jobs/job.hh>
+#include <sim/jobs/utils.hh>
+
+using sim::jobs::Job;
+using sim::jobs::RejudgeProblemBatchInfo;
+using sim::submissions::Submission;
+
+namespace job_server::job_handlers {
+
+void RejudgeProblemBatch::run() {
+    STACK_UNWINDING_MARK;
+
+    auto chunk = claim_chunk();
+    if (not chunk) {
+        return;
+    }
+    // Submission ids are far below 2^38, so that the positions do not overflow
+    chunk_log_pos_ = CHUNK_LOGS_POS + chunk->submission_ids.front() * CHUNK_LOG_MAX_SIZE;
+    save_log_at(*chunk_log_pos_, *chunk_log_pos_ + CHUNK_LOG_MAX_SIZE);
+
+    uint64_t judged_submissions = 0;
+    for (auto submission_id : chunk->submission_ids) {
+        switch (judge_submission(submission_id)) {
+        case JudgingResult::JUDGED: ++judged_submissions; break;
+        case JudgingResult::ALREADY_REJUDGED:
+            job_log(
+                "Skipped the submission ",
+                submission_id,
+                " because it has already been rejudged after this job had been scheduled"
+            );
+            break;
+        case JudgingResult::NO_SUCH_SUBMISSION:
+            job_log("Skipped the submission ", submission_id, " since it no longer exists");
+            break;
+        }
+    }
+
+    job_log(
+        "Rejudged ",
+        judged_submissions,
+        " out of ",
+        chunk->submission_ids.size(),
+        " claimed submissions of the problem ",
+        problem_id_
+    );
+    finish_chunk(chunk->generation, judged_submissions);
+}
+
+std::optional<RejudgeProblemBatch::Chunk> RejudgeProblemBatch::claim_chunk() {
+    STACK_UNWINDING_MARK;
+
+    auto transaction = mysql.start_transaction();
+    EnumVal<Job::Status> status{};
+    InplaceBuff<512> info_str;
+    auto stmt = mysql.prepare("SELECT status, info FROM jobs WHERE id=? FOR UPDATE");
+    stmt.bind_and_execute(job_id_);
+    stmt.res_bind_all(status, info_str);
+    if (not stmt.next() or status == Job::Status::CANCELED) {
+        return std::nullopt;
+    }
+
+    RejudgeProblemBatchInfo info(info_str);
+    Chunk chunk{{}, info.generation};
+    if (not info.all_claimed) {
+        // One more id is selected to find out whether any submissions will remain unclaimed
+        if (info.contest_problem_id) {
+            stmt = mysql.prepare(
+                "SELECT id FROM submissions WHERE contest_problem_id=? AND id>? "
+                "ORDER BY id LIMIT ",
+                CHUNK_SIZE + 1
+            );
+            stmt.bind_and_execute(info.contest_problem_id.value(), info.last_claimed_submission_id);
+        } else {
+            stmt = mysql.prepare(
+                "SELECT id FROM submissions WHERE problem_id=? AND id>? ORDER BY id LIMIT ",
+                CHUNK_SIZE + 1
+            );
+            stmt.bind_and_execute(problem_id_, info.last_claimed_submission_id);
+        }
+        decltype(Submission::id) submission_id = 0;
+        stmt.res_bind_all(submission_id);
+        while (stmt.next()) {
+            chunk.submission_ids.emplace_back(submission_id);
+        }
+
+        info.all_claimed = (chunk.submission_ids.size() <= CHUNK_SIZE);
+        if (not info.all_claimed) {
+            chunk.submission_ids.pop_back();
+        }
+        if (not chunk.submission_ids.empty()) {
+            info.last_claimed_submission_id = chunk.submission_ids.back();
+            ++info.chunks_in_progress;
+        }
+    }
+
+    if (chunk.submission_ids.empty()) {
+        if (info.chunks_in_progress == 0) {
+            job_log("All submissions of the problem ", problem_id_, " have been rejudged");
+            job_done(info.dump());
+        } else {
+            // The workers judging the remaining chunks will finish the job
+            mysql.prepare("UPDATE jobs SET info=? WHERE id=?")
+                .bind_and_execute(info.dump(), job_id_);
+        }
+        transaction.commit();
+        return std::nullopt;
+    }
+
+    // Let other judge workers claim the next chunks while this one is being judged
+    mysql.prepare("UPDATE jobs SET status=?, info=? WHERE id=?")
+        .bind_and_execute(
+            EnumVal(info.all_claimed ? Job::Status::IN_PROGRESS : Job::Status::PENDING),
+            info.dump(),
+            job_id_
+        );
+    transaction.commit();
+    if (not info.all_claimed) {
+        sim::jobs::notify_job_server();
+    }
+
+    job_log(
+        "Claimed submissions ",
+        chunk.submission_ids.front(),
+        "..",
+        chunk.submission_ids.back(),
+        " of the problem ",
+        problem_id_
+    );
+    return chunk;
+}
+
+void RejudgeProblemBatch::finish_chunk(uint32_t generation, uint64_t judged_submissions) {
+    STACK_UNWINDING_MARK;
+
+    auto transaction = mysql.start_transaction();
+    EnumVal<Job::Status> status{};
+    InplaceBuff<512> info_str;
+    auto stmt = mysql.prepare("SELECT status, info FROM jobs WHERE id=? FOR UPDATE");
+    stmt.bind_and_execute(job_id_);
+    stmt.res_bind_all(status, info_str);
+    if (not stmt.next()) {
+        return;
+    }
+    if (status == Job::Status::CANCELED) {
+        append_chunk_log(get_log());
+        transaction.commit();
+        return;
+    }
+
+    RejudgeProblemBatchInfo info(info_str);
+    info.judged_submissions += judged_submissions;
+    // A restart of the job forgets about the chunks claimed before it
+    if (info.generation == generation and info.chunks_in_progress > 0) {
+        --info.chunks_in_progress;
+    }
+
+    if (info.all_claimed and info.chunks_in_progress == 0) {
+        job_done(info.dump());
+    } else {
+        append_chunk_log(get_log());
+        mysql.prepare("UPDATE jobs SET info=? WHERE id=?").bind_and_execute(info.dump(), job_id_);
+    }
+    transaction.commit();
+}
+
+void RejudgeProblemBatch::append_chunk_log(StringView log) {
+    STACK_UNWINDING_MARK;
+
+    if (chunk_log_pos_) {
+        sim::jobs::save_log_part(
+            mysql, job_id_, *chunk_log_pos_, "", *chunk_log_pos_ + CHUNK_LOG_MAX_SIZE
+        );
+    }
+    sim::jobs::append_log_part(mysql, job_id_, log.substr(appended_log_size_), CHUNK_LOGS_POS);
+    appended_log_size_ = log.size();
+}
+
+void RejudgeProblemBatch::save_whole_log(StringView log) {
+    STACK_UNWINDING_MARK;
+
+    append_chunk_log(log);
+    // Logs of the chunks claimed before a restart of the job are left only by stale workers
+    sim::jobs::save_log_part(mysql, job_id_, CHUNK_LOGS_POS, "");
+    sim::jobs::save_final_log(mysql, job_id_, sim::jobs::load_log(mysql, job_id_));
+}
+
+} // namespace job_server::job_handlers
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "judge_submission_base.hh"
+
+#include <optional>
+#include <sim/jobs/job.hh>
+#include <sim/problems/problem.hh>
+#include <vector>
+
+namespace job_server::job_handlers {
+
+// Rejudges all submissions to a problem (or to a contest problem) in one job. The submissions are
+// claimed in chunks in the order of their ids. After claiming a chunk, the job is set back to
+// pending while unclaimed submissions remain, so that other judge workers can claim the next
+// chunks in parallel. The progress is kept in the job's info.
+class RejudgeProblemBatch final : public JudgeSubmissionBase {
+private:
+    static constexpr size_t CHUNK_SIZE = 16;
+    // While a chunk is judged, its log is saved at its own positions past the job's log, so that
+    // the workers do not overwrite each other's logs. Once judged, the chunk's log is moved to the
+    // end of the job's log under the lock of the job's row.
+    static constexpr uint64_t CHUNK_LOGS_POS = uint64_t{1} << 62;
+    static constexpr uint64_t CHUNK_LOG_MAX_SIZE = uint64_t{1} << 24;
+    static_assert(CHUNK_LOG_MAX_SIZE >= sim::jobs::job_log_max_size);
+
+    const decltype(sim::problems::Problem::id) problem_id_;
+    std::optional<uint64_t> chunk_log_pos_;
+    uint64_t appended_log_size_ = 0; // prefix of the log already appended to the job's log
+
+    struct Chunk {
+        std::vector<decltype(sim::submissions::Submission::id)> submission_ids;
+        uint32_t generation;
+    };
+
+public:
+    RejudgeProblemBatch(
+        uint64_t job_id,
+        decltype(sim::problems::Problem::id) problem_id,
+        StringView job_creation_time
+    )
+    : JobHandler(job_id)
+    , JudgeSubmissionBase(job_creation_time)
+    , problem_id_(problem_id) {}
+
+    void run() override;
+
+private:
+    // Returns std::nullopt if the job was canceled or is already done
+    std::optional<Chunk> claim_chunk();
+
+    void finish_chunk(uint32_t generation, uint64_t judged_submissions);
+
+    // Has to be called with the job's row locked
+    void append_chunk_log(StringView log);
+
+    // Has to be called with the job's row locked (which finishing the job does)
+    void save_whole_log(StringView log) override;
+};
+
+} // namespace job_server::job_handlers
@@ -58,8 +58,8 @@ void ResetProblemTimeLimits::run() {
     // Add job to delete old problem file
     mysql
         .prepare("INSERT INTO jobs(file_id, creator, type, priority, status,"
-                 " added, aux_id, info, data) "
-                 "SELECT file_id, NULL, ?, ?, ?, ?, NULL, '', '' FROM problems "
+                 " added, aux_id, info) "
+                 "SELECT file_id, NULL, ?, ?, ?, ?, NULL, '' FROM problems "
                  "WHERE id=?")
         .bind_and_execute(
             EnumVal(Job::Type::DELETE_FILE),
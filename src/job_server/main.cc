@@ -1,18 +1,28 @@
+#include "compilation_cache.hh"
+#include "cpu_pool.hh"
 #include "dispatcher.hh"
+#include "job_handlers/judge_submission_base.hh"
 #include "logs.hh"
 #include "notify_file.hh"
+#include "package_cache.hh"
 
+#include <algorithm>
 #include <climits>
 #include <cstdint>
+#include <cstring>
 #include <future>
 #include <map>
+#include <optional>
 #include <poll.h>
 #include <queue>
 #include <set>
+#include <sim/cpu_affinity.hh>
 #include <sim/jobs/job.hh>
 #include <sim/jobs/utils.hh>
 #include <sim/mysql/mysql.hh>
+#include <sim/status_events.hh>
 #include <sim/submissions/update_final.hh>
+#include <simlib/call_in_destructor.hh>
 #include <simlib/config_file.hh>
 #include <simlib/file_info.hh>
 #include <simlib/file_manip.hh>
@@ -22,8 +32,11 @@
 #include <simlib/working_directory.hh>
 #include <sys/eventfd.h>
 #include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include <thread>
 #include <unistd.h>
+#include <vector>
 
 #if 0
 #define DEBUG_JOB_SERVER(...) __VA_ARGS__
@@ -66,6 +79,8 @@ public:
     };
 
 private:
+    static constexpr size_t SYNC_BATCH_SIZE = 1024;
+
     struct ProblemJobs {
         uint64_t problem_id{};
         std::set<Job> jobs;
@@ -134,6 +149,8 @@ private:
     }
 
 public:
+    // Claims all pending jobs in batches: each batch is selected (with rows locked, so that e.g.
+    // canceling a job cannot interleave) and marked as NOTICED_PENDING in a single transaction
     void sync_with_db() {
         STACK_UNWINDING_MARK;
 
@@ -142,23 +159,27 @@ public:
         mysql::Optional<decltype(sim::jobs::Job::aux_id)::value_type> aux_id;
         uint priority = 0;
         InplaceBuff<512> info;
-        // Select jobs
-        auto stmt = job_server::mysql.prepare("SELECT id, type, priority, aux_id, info "
-                                              "FROM jobs "
-                                              "WHERE status=? "
-                                              "ORDER BY priority DESC, id ASC LIMIT 4");
+        InplaceBuff<SYNC_BATCH_SIZE * 8> claimed_ids;
+        // Claimed jobs stop being PENDING, so every batch starts at the beginning of the index
+        auto stmt = job_server::mysql.prepare(
+            "SELECT id, type, priority, aux_id, info "
+            "FROM jobs "
+            "WHERE status=? "
+            "ORDER BY priority DESC, id ASC LIMIT ",
+            SYNC_BATCH_SIZE,
+            " FOR UPDATE"
+        );
         stmt.res_bind_all(jid, jtype, priority, aux_id, info);
-        // Sets job's status to NOTICED_PENDING
-        auto mark_stmt = job_server::mysql.prepare("UPDATE jobs SET status=? WHERE id=?");
         // Add jobs to internal queue
         using JT = sim::jobs::Job::Type;
         for (;;) {
+            auto transaction = job_server::mysql.start_transaction();
             stmt.bind_and_execute(EnumVal(sim::jobs::Job::Status::PENDING));
-            if (not stmt.next()) {
-                break;
-            }
-
-            do {
+            claimed_ids.clear();
+            size_t batch_size = 0;
+            while (stmt.next()) {
+                ++batch_size;
+                claimed_ids.append(claimed_ids.size == 0 ? "" : ",", jid);
                 DEBUG_JOB_SERVER(stdlog("DEBUG: Fetched from DB: job ", jid);)
                 auto queue_job =
                     [&jid, &priority](auto& job_category, uint64_t problem_id, bool locks_problem) {
@@ -211,6 +232,10 @@ public:
                     break;
                 }
 
+                case JT::REJUDGE_PROBLEM_BATCH:
+                    queue_job(judge_jobs, aux_id.value(), false);
+                    break;
+
                 case JT::ADD_PROBLEM__JUDGE_MODEL_SOLUTION: queue_job(judge_jobs, 0, false); break;
 
                 case JT::REUPLOAD_PROBLEM__JUDGE_MODEL_SOLUTION:
@@ -237,8 +262,21 @@ public:
                 case JT::DELETE_CONTEST_PROBLEM:
                 case JT::DELETE_FILE: other_jobs.insert({jid, priority, false}); break;
                 }
-                mark_stmt.bind_and_execute(EnumVal(sim::jobs::Job::Status::NOTICED_PENDING), jid);
-            } while (stmt.next());
+            }
+
+            if (batch_size > 0) {
+                job_server::mysql.update(
+                    "UPDATE jobs SET status=",
+                    EnumVal(sim::jobs::Job::Status::NOTICED_PENDING).to_int(),
+                    " WHERE id IN (",
+                    claimed_ids,
+                    ')'
+                );
+            }
+            transaction.commit();
+            if (batch_size < SYNC_BATCH_SIZE) {
+                break;
+            }
         }
 
         DEBUG_JOB_SERVER(stdlog(__FILE__ ":", __LINE__, ": ", __FUNCTION__, "()");)
@@ -526,15 +564,18 @@ private:
     vector<thread::id> idle_workers;
     map<thread::id, WorkerInfo> workers; // AVLDict cannot be used as addresses must not change
 
+    vector<int> free_cpus_; // dedicated cpus not taken by any worker
+
     function<void(NextJob)> job_handler_;
     function<void()> worker_becomes_idle_callback_;
     function<void(WorkerInfo)> worker_dies_callback_;
 
     class Worker {
         WorkersPool& wp_;
+        std::optional<int> cpu_;
 
     public:
-        explicit Worker(WorkersPool& wp) : wp_(wp) {
+        Worker(WorkersPool& wp, std::optional<int> cpu) : wp_(wp), cpu_(cpu) {
             STACK_UNWINDING_MARK;
             auto tid = std::this_thread::get_id();
             lock_guard<mutex> lock(wp_.mtx_);
@@ -554,6 +595,10 @@ private:
             auto it = wp_.workers.find(tid);
             auto wi = std::move(it->second);
             wp_.workers.erase(it);
+            // Hand the cpu over to the replacement of the worker
+            if (cpu_) {
+                wp_.free_cpus_.emplace_back(*cpu_);
+            }
             // Remove it from idle workers
             if (wi.is_idle) {
                 for (auto k = wp_.idle_workers.begin(); k != wp_.idle_workers.end(); ++k) {
@@ -619,12 +664,35 @@ public:
         throw_assert(job_handler_);
     }
 
+    // Not thread-safe, should be called before the workers start. Every worker spawned afterwards
+    // takes its own cpu from @p cpus (while any is free) and is pinned to it.
+    void dedicate_cpus(vector<int> cpus) { free_cpus_ = std::move(cpus); }
+
     void spawn_worker() {
         STACK_UNWINDING_MARK;
 
-        std::thread foo([this] {
+        std::optional<int> cpu;
+        {
+            lock_guard<mutex> lock(mtx_);
+            if (not free_cpus_.empty()) {
+                cpu = free_cpus_.back();
+                free_cpus_.pop_back();
+            }
+        }
+        CallInDtor cpu_returner([&] {
+            if (cpu) {
+                lock_guard<mutex> lock(mtx_);
+                free_cpus_.emplace_back(*cpu);
+            }
+        });
+
+        std::thread foo([this, cpu] {
             try {
-                thread_local Worker w(*this);
+                thread_local Worker w(*this, cpu);
+                // The judge sandboxes spawned by the worker inherit its affinity
+                if (cpu) {
+                    sim::cpu_affinity::pin_current_thread_to(*cpu);
+                }
                 // Connect to databases
                 job_server::mysql = sim::mysql::make_conn_with_credential_file(".db.config");
 
@@ -639,6 +707,7 @@ public:
                 pthread_exit(nullptr);
             }
         });
+        cpu_returner.cancel(); // The worker owns the cpu now
         foo.detach();
     }
 
@@ -716,6 +785,7 @@ static void process_job(const WorkersPool::NextJob& job) {
     // Mark as in progress
     job_server::mysql.prepare("UPDATE jobs SET status=? WHERE id=?")
         .bind_and_execute(EnumVal(sim::jobs::Job::Status::IN_PROGRESS), job.id);
+    sim::status_events::publish(sim::status_events::Kind::JOB, job.id);
 
     stdlog("Processing job ", job.id, "...");
 
@@ -724,6 +794,7 @@ static void process_job(const WorkersPool::NextJob& job) {
         creat = creator.value();
     }
     job_server::job_dispatcher(job.id, jtype, file_id, tmp_file_id, creat, aux_id, info, added);
+    sim::status_events::publish(sim::status_events::Kind::JOB, job.id);
 
     exit_procedures();
 }
@@ -889,9 +960,46 @@ static void sync_and_assign_jobs() {
     }
 }
 
+// Returns -1 on error, then the job server relies on the notify file only
+static int open_notify_socket() noexcept {
+    int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd == -1) {
+        errlog("Notify socket: socket()", errmsg());
+        return -1;
+    }
+
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    constexpr auto path = job_server::notify_socket;
+    static_assert(path.size() < sizeof(addr.sun_path));
+    std::memcpy(addr.sun_path, path.data(), path.size() + 1);
+
+    (void)unlink(path.data()); // Left by the previous instance
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr))) {
+        errlog("Notify socket: bind()", errmsg());
+        (void)close(fd);
+        return -1;
+    }
+    return fd;
+}
+
 static void events_loop() noexcept {
     int inotify_fd = -1;
     int inotify_wd = -1;
+    const int notify_socket_fd = open_notify_socket(); // poll() ignores it if it is -1
+
+    auto process_notify_socket_datagrams = [&] {
+        STACK_UNWINDING_MARK;
+
+        bool received = false;
+        char buff[16];
+        while (recv(notify_socket_fd, buff, sizeof(buff), 0) >= 0) {
+            received = true; // Datagrams only wake us up, so many of them need a single sync
+        }
+        if (received) {
+            sync_and_assign_jobs();
+        }
+    };
 
     // Returns a bool denoting whether inotify is still healthy
     auto process_inotify_event = [&]() -> bool {
@@ -935,6 +1043,7 @@ static void events_loop() noexcept {
         try {
             STACK_UNWINDING_MARK;
             constexpr uint SLEEP_INTERVAL = 30; // in milliseconds
+            constexpr uint SOCKET_SLEEP_INTERVAL = 1000; // in milliseconds
 
             // Update jobs queue
             sync_and_assign_jobs();
@@ -1000,7 +1109,11 @@ static void events_loop() noexcept {
                     // Events queue is fine
                     STACK_UNWINDING_MARK;
 
-                    pollfd pfd = {EventsQueue::get_notifier_fd(), POLLIN, 0};
+                    pollfd pfd[2] = {
+                        {EventsQueue::get_notifier_fd(), POLLIN, 0}, {notify_socket_fd, POLLIN, 0}};
+                    // The notify socket reports new jobs, so the database may be polled rarely
+                    int sleep_interval =
+                        notify_socket_fd == -1 ? SLEEP_INTERVAL : SOCKET_SLEEP_INTERVAL;
                     auto tend = std::chrono::steady_clock::now() + std::chrono::seconds(5);
                     // Process events for 5 seconds
                     for (;;) {
@@ -1011,11 +1124,12 @@ static void events_loop() noexcept {
                         // Update queue - sth may have changed
                         sync_and_assign_jobs();
 
-                        int rc = poll(&pfd, 1, SLEEP_INTERVAL);
+                        int rc = poll(pfd, 2, sleep_interval);
                         if (rc == -1 and errno != EINTR) {
                             THROW("poll() failed", errmsg());
                         }
 
+                        process_notify_socket_datagrams();
                         EventsQueue::reset_notifier();
                         while (EventsQueue::process_next_event()) {
                         }
@@ -1063,11 +1177,15 @@ static void events_loop() noexcept {
 
                     constexpr uint INFY_IDX = 0;
                     constexpr uint EQ_IDX = 1;
-                    pollfd pfd[2] = {
-                        {inotify_fd, POLLIN, 0}, {EventsQueue::get_notifier_fd(), POLLIN, 0}};
+                    constexpr uint SOCK_IDX = 2;
+                    pollfd pfd[3] = {
+                        {inotify_fd, POLLIN, 0},
+                        {EventsQueue::get_notifier_fd(), POLLIN, 0},
+                        {notify_socket_fd, POLLIN, 0},
+                    };
 
                     for (;;) {
-                        int rc = poll(pfd, 2, -1);
+                        int rc = poll(pfd, 3, -1);
                         if (rc == -1) {
                             if (errno == EINTR) {
                                 continue;
@@ -1076,8 +1194,11 @@ static void events_loop() noexcept {
                             THROW("poll() failed", errmsg());
                         }
 
-                        // This should be checked (called) first in so as to
+                        // These should be checked (called) first in so as to
                         // update the jobs queue before processing events
+                        if (pfd[SOCK_IDX].revents != 0) {
+                            process_notify_socket_datagrams();
+                        }
                         if (pfd[INFY_IDX].revents != 0) {
                             if (not process_inotify_event()) {
                                 continue; // inotify has just broken
@@ -1113,10 +1234,16 @@ static void clean_up_db() {
         // Do it in a transaction to speed things up
         auto transaction = job_server::mysql.start_transaction();
 
-        // Fix jobs that are in progress after the job-server died
+        // Fix jobs that are in progress after the job-server died. Batch rejudges may be pending
+        // while their chunks were being judged, so they are restarted too.
         auto stmt = job_server::mysql.prepare("SELECT id, type, info FROM jobs WHERE "
-                                              "status=?");
-        stmt.bind_and_execute(EnumVal(sim::jobs::Job::Status::IN_PROGRESS));
+                                              "status=? OR (type=? AND status IN (?, ?))");
+        stmt.bind_and_execute(
+            EnumVal(sim::jobs::Job::Status::IN_PROGRESS),
+            EnumVal(sim::jobs::Job::Type::REJUDGE_PROBLEM_BATCH),
+            EnumVal(sim::jobs::Job::Status::PENDING),
+            EnumVal(sim::jobs::Job::Status::NOTICED_PENDING)
+        );
 
         decltype(sim::jobs::Job::id) job_id = 0;
         EnumVal<sim::jobs::Job::Type> job_type{};
@@ -1190,7 +1317,15 @@ int main() {
         clean_up_db();
 
         ConfigFile cf;
-        cf.add_vars("js_local_workers", "js_judge_workers");
+        cf.add_vars(
+            "js_local_workers",
+            "js_judge_workers",
+            "js_judge_cpus",
+            "js_package_cache_mb",
+            "js_solution_cache_mb",
+            "js_parallel_judging_cpus",
+            "js_partial_judge_reports_interval_ms"
+        );
         cf.load_config_from_file("sim.conf");
 
         size_t lworkers_no = cf["js_local_workers"].as<size_t>().value_or(0);
@@ -1199,17 +1334,53 @@ int main() {
                   "than 0");
         }
 
-        size_t jworkers_no = cf["js_judge_workers"].as<size_t>().value_or(0);
+        // Every judge worker gets its own cpu, if they are listed
+        auto judge_cpus = sim::cpu_affinity::cpus_from_config(cf, "js_judge_cpus");
+        size_t jworkers_no = judge_cpus.empty()
+            ? cf["js_judge_workers"].as<size_t>().value_or(0)
+            : judge_cpus.size();
         if (jworkers_no < 1) {
             THROW("sim.conf: js_judge_workers has to be an integer greater "
                   "than 0");
         }
 
+        auto package_cache_mb = cf["js_package_cache_mb"].as<uint64_t>().value_or(0);
+        job_server::package_cache.configure(package_cache_mb << 20);
+        // There are few distinct checkers, so their cache does not need to be configurable
+        constexpr uint64_t CHECKER_CACHE_SIZE = 256 << 20;
+        job_server::checker_cache.configure(CHECKER_CACHE_SIZE);
+        auto solution_cache_mb = cf["js_solution_cache_mb"].as<uint64_t>().value_or(0);
+        job_server::solution_cache.configure(solution_cache_mb << 20);
+        auto partial_judge_reports_interval_ms =
+            cf["js_partial_judge_reports_interval_ms"].as<uint64_t>().value_or(0);
+        job_server::job_handlers::partial_judge_reports_interval =
+            std::chrono::milliseconds(partial_judge_reports_interval_ms);
+
+        auto parallel_judging_cpus =
+            sim::cpu_affinity::cpus_from_config(cf, "js_parallel_judging_cpus");
+        auto judging_cpus = sim::cpu_affinity::judging_cpus_from_config(cf);
+        std::sort(judging_cpus.begin(), judging_cpus.end());
+        if (std::adjacent_find(judging_cpus.begin(), judging_cpus.end()) != judging_cpus.end()) {
+            THROW("sim.conf: cpus in js_judge_cpus and js_parallel_judging_cpus have to be "
+                  "distinct");
+        }
+        // Keep the local workers (and everything else in the job server) off the judging cpus;
+        // threads inherit the affinity
+        sim::cpu_affinity::exclude_from_current_thread(judging_cpus);
+        judge_workers.dedicate_cpus(judge_cpus);
+
+        auto parallel_judging_cpus_no = parallel_judging_cpus.size();
+        job_server::parallel_judging_cpus.configure(std::move(parallel_judging_cpus));
+
         // clang-format off
         stdlog("\n=================== Job server launched ==================="
                "\nPID: ", getpid(),
                "\nlocal workers: ", lworkers_no,
-               "\njudge workers: ", jworkers_no);
+               "\njudge workers: ", jworkers_no, (judge_cpus.empty() ? "" : " (pinned)"),
+               "\npackage cache: ", package_cache_mb, " MiB",
+               "\nsolution cache: ", solution_cache_mb, " MiB",
+               "\npartial judge reports interval: ", partial_judge_reports_interval_ms, " ms",
+               "\nparallel judging cpus: ", parallel_judging_cpus_no);
         // clang-format on
 
         for (size_t i = 0; i < lworkers_no; ++i) {
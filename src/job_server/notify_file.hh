@@ -6,4 +6,8 @@ namespace job_server {
 
 constexpr CStringView notify_file = ".job-server.notify";
 
+// Unix datagram socket the job server listens on, a datagram sent to it wakes the job server up
+// immediately; notify_file is the fallback if the socket is unavailable
+constexpr CStringView notify_socket = ".job-server.notify.sock";
+
 } // namespace job_server
@@ -0,0 +1,199 @@
+#include "package_cache.hh"
+
+#include <simlib/concat_tostr.hh>
+#include <simlib/debug.hh>
+#include <simlib/file_manip.hh>
+#include <simlib/file_perms.hh>
+#include <simlib/libzip.hh>
+#include <simlib/logger.hh>
+#include <simlib/sim/problem_package.hh>
+#include <sys/stat.h>
+
+namespace job_server {
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+PackageCache package_cache;
+
+void PackageCache::configure(uint64_t max_size) noexcept {
+    max_size_ = max_size;
+    if (remove_r(dir) and errno != ENOENT) {
+        errlog("Package cache: remove_r()", errmsg());
+    }
+    if (max_size_ > 0 and ::mkdir(dir.data(), S_0755)) {
+        errlog("Package cache: mkdir()", errmsg());
+        max_size_ = 0;
+    }
+}
+
+PackageCache::Handle PackageCache::get(FileId file_id) {
+    STACK_UNWINDING_MARK;
+
+    auto zip_path = sim::internal_files::path_of(file_id).to_string();
+    if (max_size_ == 0) {
+        return Handle(this, nullptr, std::move(zip_path));
+    }
+
+    struct stat st = {};
+    if (stat(zip_path.c_str(), &st)) {
+        return Handle(this, nullptr, std::move(zip_path)); // Let it fail as without the cache
+    }
+    uint64_t inode = st.st_ino;
+    uint64_t mtime_ns = static_cast<uint64_t>(st.st_mtim.tv_sec) * 1'000'000'000 +
+        static_cast<uint64_t>(st.st_mtim.tv_nsec);
+
+    std::vector<std::string> dirs_to_remove;
+    auto find_locked = [&]() -> std::shared_ptr<Entry> {
+        auto it = entries_.find(file_id);
+        if (it == entries_.end()) {
+            return nullptr;
+        }
+        if (it->second->inode != inode or it->second->mtime_ns != mtime_ns) {
+            remove_locked(it->second, dirs_to_remove); // The file id was reused
+            return nullptr;
+        }
+
+        auto entry = it->second;
+        lru_.splice(lru_.begin(), lru_, entry->lru_it);
+        ++entry->users;
+        return entry;
+    };
+
+    auto entry = std::make_shared<Entry>();
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (auto found = find_locked()) {
+            return Handle(this, found, found->package_path);
+        }
+        entry->dir = concat_tostr(dir, file_id, '.', next_dir_id_++, '/');
+    }
+    for (auto& d : dirs_to_remove) {
+        (void)remove_r(d);
+    }
+    dirs_to_remove.clear();
+
+    entry->file_id = file_id;
+    entry->inode = inode;
+    entry->mtime_ns = mtime_ns;
+    try {
+        unpack(zip_path, *entry);
+    } catch (const std::exception& e) {
+        ERRLOG_CATCH(e);
+        (void)remove_r(entry->dir);
+        return Handle(this, nullptr, std::move(zip_path));
+    }
+
+    std::shared_ptr<Entry> res;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        res = find_locked(); // Other worker may have just unpacked it
+        if (res) {
+            dirs_to_remove.emplace_back(entry->dir);
+        } else {
+            res = entry;
+            res->users = 1;
+            used_size_ += res->size;
+            lru_.emplace_front(res);
+            res->lru_it = lru_.begin();
+            entries_.emplace(file_id, res);
+            evict_locked(dirs_to_remove);
+        }
+    }
+    for (auto& d : dirs_to_remove) {
+        (void)remove_r(d);
+    }
+    return Handle(this, res, res->package_path);
+}
+
+void PackageCache::invalidate(FileId file_id) noexcept {
+    std::vector<std::string> dirs_to_remove;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        auto it = entries_.find(file_id);
+        if (it == entries_.end()) {
+            return;
+        }
+        remove_locked(it->second, dirs_to_remove);
+    }
+    for (auto& d : dirs_to_remove) {
+        (void)remove_r(d);
+    }
+}
+
+void PackageCache::release(Entry& entry) noexcept {
+    std::vector<std::string> dirs_to_remove;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (--entry.users == 0 and entry.removed) {
+            dirs_to_remove.emplace_back(entry.dir);
+        }
+        evict_locked(dirs_to_remove); // The entry might have held back the eviction
+    }
+    for (auto& d : dirs_to_remove) {
+        (void)remove_r(d);
+    }
+}
+
+std::list<std::shared_ptr<PackageCache::Entry>>::iterator PackageCache::remove_locked(
+    std::shared_ptr<Entry> entry, std::vector<std::string>& dirs_to_remove
+) {
+    entry->removed = true;
+    used_size_ -= entry->size;
+    entries_.erase(entry->file_id);
+    if (entry->users == 0) {
+        dirs_to_remove.emplace_back(entry->dir);
+    }
+    return lru_.erase(entry->lru_it);
+}
+
+void PackageCache::evict_locked(std::vector<std::string>& dirs_to_remove) {
+    auto it = lru_.end();
+    while (used_size_ > max_size_ and it != lru_.begin()) {
+        --it;
+        if ((*it)->users == 0) {
+            it = remove_locked(*it, dirs_to_remove);
+        }
+    }
+}
+
+void PackageCache::unpack(const std::string& zip_path, Entry& entry) {
+    STACK_UNWINDING_MARK;
+
+    if (::mkdir(entry.dir.c_str(), S_0755)) {
+        THROW("mkdir()", errmsg());
+    }
+
+    ZipFile zip(zip_path, ZIP_RDONLY);
+    auto eno = zip.entries_no();
+    for (decltype(eno) i = 0; i < eno; ++i) {
+        auto entry_name = concat_tostr(zip.get_name(i));
+        if (entry_name.find("..") != std::string::npos) {
+            THROW("Invalid entry name in the package: ", entry_name);
+        }
+
+        auto path = concat_tostr(entry.dir, entry_name);
+        // Create the parent directories, as the zip does not have to contain entries for them
+        for (auto pos = path.find('/', entry.dir.size()); pos != std::string::npos;
+             pos = path.find('/', pos + 1))
+        {
+            path[pos] = '\0';
+            if (::mkdir(path.c_str(), S_0755) and errno != EEXIST) {
+                THROW("mkdir()", errmsg());
+            }
+            path[pos] = '/';
+        }
+        if (path.back() == '/') {
+            continue; // Directory entry
+        }
+
+        zip.extract_to_file(i, path, S_0600);
+        struct stat st = {};
+        if (stat(path.c_str(), &st)) {
+            THROW("stat()", errmsg());
+        }
+        entry.size += static_cast<uint64_t>(st.st_size);
+    }
+
+    entry.package_path = concat_tostr(entry.dir, sim::zip_package_main_dir(zip));
+}
+
+} // namespace job_server
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sim/internal_files/internal_file.hh>
+#include <simlib/string_view.hh>
+#include <string>
+#include <vector>
+
+namespace job_server {
+
+// Process-wide LRU cache of problem packages unpacked into directories (inside
+// sim::internal_files::cache_dir), so that judging submissions of the same problem does not
+// decompress its tests over and over again. Packages in use (see Handle) are never evicted, so
+// only they may exceed the size limit. As file ids may be reused after deletion, an entry is
+// identified by the file id, the file's inode and modification time. The DELETE_FILE job
+// invalidates the entry of the deleted file.
+class PackageCache {
+public:
+    using FileId = decltype(sim::internal_files::InternalFile::id);
+
+private:
+    struct Entry {
+        FileId file_id;
+        uint64_t inode;
+        uint64_t mtime_ns;
+        std::string dir; // where the package is unpacked
+        std::string package_path; // main directory of the package (inside dir)
+        uint64_t size = 0; // total size of the unpacked files
+        size_t users = 0;
+        bool removed = false; // if true, the last user removes dir
+        std::list<std::shared_ptr<Entry>>::iterator lru_it;
+    };
+
+    std::mutex mtx_;
+    uint64_t max_size_ = 0;
+    uint64_t used_size_ = 0;
+    uint64_t next_dir_id_ = 0;
+    std::list<std::shared_ptr<Entry>> lru_; // the most recently used entry is at the front
+    std::map<FileId, std::shared_ptr<Entry>> entries_;
+
+public:
+    // Keeps the package from being evicted as long as it exists
+    class Handle {
+        friend class PackageCache;
+
+        PackageCache* cache_;
+        std::shared_ptr<Entry> entry_; // nullptr if the package is not cached
+        std::string path_;
+
+        Handle(PackageCache* cache, std::shared_ptr<Entry> entry, std::string path) noexcept
+        : cache_(cache)
+        , entry_(std::move(entry))
+        , path_(std::move(path)) {}
+
+    public:
+        Handle(const Handle&) = delete;
+        Handle(Handle&&) noexcept = default;
+        Handle& operator=(const Handle&) = delete;
+        Handle& operator=(Handle&&) = delete;
+
+        ~Handle() {
+            if (entry_) {
+                cache_->release(*entry_);
+            }
+        }
+
+        // Path to the package that can be loaded by sim::JudgeWorker: the main directory of the
+        // unpacked package or the package's zip itself
+        [[nodiscard]] const std::string& path() const noexcept { return path_; }
+
+        [[nodiscard]] bool is_unpacked() const noexcept { return entry_ != nullptr; }
+    };
+
+    static constexpr CStringView dir = "internal_files_cache/packages/";
+
+    PackageCache() = default;
+
+    PackageCache(const PackageCache&) = delete;
+    PackageCache(PackageCache&&) = delete;
+    PackageCache& operator=(const PackageCache&) = delete;
+    PackageCache& operator=(PackageCache&&) = delete;
+    ~PackageCache() = default;
+
+    // Not thread-safe, should be called before the workers start. Removes the packages unpacked
+    // by the previous instance. 0 disables the cache.
+    void configure(uint64_t max_size) noexcept;
+
+    // Returns the handle of the unpacked package of the internal file @p file_id. If the cache is
+    // disabled or unpacking fails, the handle points to the zip.
+    Handle get(FileId file_id);
+
+    // Removes the entry of the internal file @p file_id (its directory is removed once no one
+    // uses it)
+    void invalidate(FileId file_id) noexcept;
+
+private:
+    void release(Entry& entry) noexcept;
+
+    // Returns the iterator to the next entry in lru_; the directories to remove are appended to
+    // @p dirs_to_remove, as they are removed after unlocking the mutex
+    std::list<std::shared_ptr<Entry>>::iterator
+    remove_locked(std::shared_ptr<Entry> entry, std::vector<std::string>& dirs_to_remove);
+
+    void evict_locked(std::vector<std::string>& dirs_to_remove);
+
+    static void unpack(const std::string& zip_path, Entry& entry);
+};
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+extern PackageCache package_cache;
+
+} // namespace job_server
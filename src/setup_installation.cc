@@ -6,6 +6,7 @@
 #include <sim/contest_entry_tokens/contest_entry_token.hh>
 #include <sim/contest_files/contest_file.hh>
 #include <sim/contest_problems/contest_problem.hh>
+#include <sim/contest_ranking_snapshots/contest_ranking_snapshot.hh>
 #include <sim/contest_rounds/contest_round.hh>
 #include <sim/contest_users/contest_user.hh>
 #include <sim/contests/contest.hh>
@@ -126,7 +127,7 @@ static void create_db_config(FilePath db_config_path) {
 struct TryToCreateTable {
     bool error = false;
     mysql::Connection& conn_;
-    std::array<CStringView, 13> sorted_tables = tables;
+    std::array<CStringView, 17> sorted_tables = tables;
 
     explicit TryToCreateTable(mysql::Connection& conn) : conn_(conn) {
         std::sort(sorted_tables.begin(), sorted_tables.end());
@@ -279,6 +280,7 @@ int main(int argc, char** argv) {
             "`name` VARBINARY(", decltype(Problem::name)::max_len, ") NOT NULL,"
             "`label` VARBINARY(", decltype(Problem::label)::max_len, ") NOT NULL,"
             "`simfile` mediumblob NOT NULL,"
+            "`parallel_judging` BOOLEAN NOT NULL DEFAULT FALSE,"
             "`owner_id` bigint unsigned NULL,"
             "`created_at` datetime NOT NULL,"
             "`updated_at` datetime NOT NULL,"
@@ -408,6 +410,20 @@ int main(int argc, char** argv) {
         ") ENGINE=InnoDB DEFAULT CHARSET=utf8 COLLATE=utf8_bin"));
     // clang-format on
 
+    using sim::contest_ranking_snapshots::ContestRankingSnapshot;
+    // clang-format off
+    try_to_create_table("contest_ranking_snapshots", concat(
+        "CREATE TABLE IF NOT EXISTS `contest_ranking_snapshots` ("
+            "`contest_round_id` bigint unsigned NOT NULL,"
+            "`generation` bigint unsigned NOT NULL,"
+            "`created_at` datetime NOT NULL,"
+            "`valid_until` BINARY(", decltype(ContestRankingSnapshot::valid_until)::max_len, ") NOT NULL,"
+            "`data` mediumblob NOT NULL,"
+            "PRIMARY KEY (contest_round_id),"
+            "FOREIGN KEY (contest_round_id) REFERENCES contest_rounds(id) ON DELETE CASCADE"
+        ") ENGINE=InnoDB DEFAULT CHARSET=utf8 COLLATE=utf8_bin"));
+    // clang-format on
+
     // clang-format off
     try_to_create_table("submissions",
         "CREATE TABLE IF NOT EXISTS `submissions` ("
@@ -430,8 +446,6 @@ int main(int argc, char** argv) {
             "`submit_time` datetime NOT NULL,"
             "`score` bigint NULL DEFAULT NULL,"
             "`last_judgment` datetime NOT NULL,"
-            "`initial_report` mediumblob NOT NULL,"
-            "`final_report` mediumblob NOT NULL,"
             "PRIMARY KEY (id),"
             /* All needed by submissions API */
             // With owner
@@ -483,6 +497,31 @@ int main(int argc, char** argv) {
         ") ENGINE=InnoDB AUTO_INCREMENT=1 DEFAULT CHARSET=utf8 COLLATE=utf8_bin");
     // clang-format on
 
+    // clang-format off
+    try_to_create_table("submission_reports",
+        "CREATE TABLE IF NOT EXISTS `submission_reports` ("
+            "`submission_id` bigint unsigned NOT NULL,"
+            "`initial_report` mediumblob NOT NULL,"
+            "`final_report` mediumblob NOT NULL,"
+            "PRIMARY KEY (submission_id),"
+            "FOREIGN KEY (submission_id) REFERENCES submissions(id) ON DELETE CASCADE"
+        ") ENGINE=InnoDB DEFAULT CHARSET=utf8 COLLATE=utf8_bin");
+    // clang-format on
+
+    // clang-format off
+    try_to_create_table("user_problem_statuses",
+        "CREATE TABLE IF NOT EXISTS `user_problem_statuses` ("
+            "`user_id` bigint unsigned NOT NULL,"
+            "`problem_id` bigint unsigned NOT NULL,"
+            "`full_status` tinyint unsigned NOT NULL,"
+            "`score` bigint NOT NULL,"
+            "PRIMARY KEY (user_id, problem_id),"
+            "KEY (problem_id),"
+            "FOREIGN KEY (user_id) REFERENCES users(id) ON DELETE CASCADE,"
+            "FOREIGN KEY (problem_id) REFERENCES problems(id) ON DELETE CASCADE"
+        ") ENGINE=InnoDB DEFAULT CHARSET=utf8 COLLATE=utf8_bin");
+    // clang-format on
+
     // clang-format off
     try_to_create_table("jobs", concat(
         "CREATE TABLE IF NOT EXISTS `jobs` ("
@@ -496,7 +535,6 @@ int main(int argc, char** argv) {
             "`added` datetime NOT NULL,"
             "`aux_id` bigint unsigned DEFAULT NULL,"
             "`info` blob NOT NULL,"
-            "`data` mediumblob NOT NULL,"
             "PRIMARY KEY (id),"
             "KEY (status, priority DESC, id), "
             "KEY (type, aux_id, id DESC),"
@@ -509,6 +547,18 @@ int main(int argc, char** argv) {
         ") ENGINE=InnoDB DEFAULT CHARSET=utf8 COLLATE=utf8_bin"));
     // clang-format on
 
+    // clang-format off
+    try_to_create_table("job_logs",
+        "CREATE TABLE IF NOT EXISTS `job_logs` ("
+            "`job_id` bigint unsigned NOT NULL,"
+            "`pos` bigint unsigned NOT NULL,"
+            "`compressed` BOOLEAN NOT NULL DEFAULT FALSE,"
+            "`data` mediumblob NOT NULL,"
+            "PRIMARY KEY (job_id, pos),"
+            "FOREIGN KEY (job_id) REFERENCES jobs(id) ON DELETE CASCADE"
+        ") ENGINE=InnoDB DEFAULT CHARSET=utf8 COLLATE=utf8_bin");
+    // clang-format on
+
     if (try_to_create_table.error) {
         return 7;
     }
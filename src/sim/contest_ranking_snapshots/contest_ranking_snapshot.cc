@@ -0,0 +1,64 @@
+#include <sim/contest_ranking_snapshots/contest_ranking_snapshot.hh>
+#include <simlib/concat.hh>
+#include <simlib/time.hh>
+
+namespace {
+
+// @p contest_round_ids_sql has to select contest round ids
+template <class... Params>
+void invalidate_impl(
+    mysql::Connection& mysql, StringView contest_round_ids_sql, Params&&... params
+) {
+    STACK_UNWINDING_MARK;
+
+    mysql
+        .prepare(
+            "INSERT INTO contest_ranking_snapshots(contest_round_id, generation,"
+            " created_at, valid_until, data) ",
+            contest_round_ids_sql,
+            " ON DUPLICATE KEY UPDATE generation=generation+1, valid_until='#', data=''"
+        )
+        .bind_and_execute(std::forward<Params>(params)...);
+}
+
+} // namespace
+
+namespace sim::contest_ranking_snapshots {
+
+void invalidate_of_contest_round(
+    mysql::Connection& mysql, decltype(contest_rounds::ContestRound::id) contest_round_id
+) {
+    invalidate_impl(mysql, "SELECT ?, 1, ?, '#', ''", contest_round_id, mysql_date());
+}
+
+void invalidate_of_contest_problem(
+    mysql::Connection& mysql, decltype(contest_problems::ContestProblem::id) contest_problem_id
+) {
+    invalidate_impl(
+        mysql,
+        "SELECT contest_round_id, 1, ?, '#', '' FROM contest_problems WHERE id=?",
+        mysql_date(),
+        contest_problem_id
+    );
+}
+
+void invalidate_of_contest(mysql::Connection& mysql, decltype(contests::Contest::id) contest_id) {
+    invalidate_impl(
+        mysql,
+        "SELECT id, 1, ?, '#', '' FROM contest_rounds WHERE contest_id=?",
+        mysql_date(),
+        contest_id
+    );
+}
+
+void invalidate_of_user(mysql::Connection& mysql, decltype(users::User::id) user_id) {
+    invalidate_impl(
+        mysql,
+        "SELECT DISTINCT contest_round_id, 1, ?, '#', '' FROM submissions "
+        "WHERE owner=? AND contest_final=1",
+        mysql_date(),
+        user_id
+    );
+}
+
+} // namespace sim::contest_ranking_snapshots
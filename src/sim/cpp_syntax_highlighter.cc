@@ -1,5 +1,8 @@
+#include <algorithm>
+#include <cstring>
 #include <limits>
 #include <sim/cpp_syntax_highlighter.hh>
+#include <simlib/aho_corasick.hh>
 #include <simlib/debug.hh>
 #include <simlib/logger.hh>
 #include <simlib/meta.hh>
@@ -21,6 +24,10 @@ using std::vector;
 #define DEBUG_CSH(...)
 #endif
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace {
 
 using StyleType = int8_t;
@@ -251,19 +258,64 @@ static_assert(
     "KEYWORD are probably unsorted"
 );
 
-namespace sim {
+namespace {
 
-CppSyntaxHighlighter::CppSyntaxHighlighter() {
-    static_assert(
-        words[0].size == 0,
-        "First (zero) element of words is a guard - because "
-        "Aho-Corasick implementation takes only positive IDs"
-    );
-    for (uint i = 1; i < words.size(); ++i) {
-        aho.add_pattern({words[i].str, words[i].size}, i);
+// The automaton is immutable after construction, so one instance is shared by all highlighters
+// (and threads) instead of being rebuilt for every one of them
+const AhoCorasick& words_aho() {
+    static const AhoCorasick aho = [] {
+        static_assert(
+            words[0].size == 0,
+            "First (zero) element of words is a guard - because "
+            "Aho-Corasick implementation takes only positive IDs"
+        );
+        AhoCorasick res;
+        for (uint i = 1; i < words.size(); ++i) {
+            res.add_pattern({words[i].str, words[i].size}, i);
+        }
+        res.build_fail_edges();
+        return res;
+    }();
+    return aho;
+}
+
+constexpr auto is_comment_or_literal_beginning = [] {
+    array<bool, 256> res{};
+    res['/'] = res['"'] = res['\''] = true;
+    return res;
+}();
+
+// Returns pointer to the first '/', '"' or '\'' in [beg, end) or end if there is none. Most of
+// the code consists of identifiers and white-spaces, so it is worth to skip them in bulk.
+const char* find_comment_or_literal_beginning(const char* beg, const char* end) noexcept {
+#ifdef __SSE2__
+    const __m128i slashes = _mm_set1_epi8('/');
+    const __m128i double_quotes = _mm_set1_epi8('"');
+    const __m128i single_quotes = _mm_set1_epi8('\'');
+    for (; end - beg >= 16; beg += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(beg));
+        __m128i matches = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, slashes), _mm_cmpeq_epi8(chunk, double_quotes)),
+            _mm_cmpeq_epi8(chunk, single_quotes)
+        );
+        if (int mask = _mm_movemask_epi8(matches); mask != 0) {
+            return beg + __builtin_ctz(mask);
+        }
     }
+#endif
+    while (beg != end and not is_comment_or_literal_beginning[static_cast<unsigned char>(*beg)])
+    {
+        ++beg;
+    }
+    return beg;
+}
 
-    aho.build_fail_edges();
+} // anonymous namespace
+
+namespace sim {
+
+CppSyntaxHighlighter::CppSyntaxHighlighter() {
+    words_aho(); // Build the shared automaton now rather than during the first highlighting
 }
 
 string CppSyntaxHighlighter::operator()(CStringView input) const {
@@ -271,12 +323,20 @@ string CppSyntaxHighlighter::operator()(CStringView input) const {
     // Remove (stupid) windows newlines as they impede parsing a lot
     if (input.find("\r\n") != CStringView::npos) {
         filtered_input.reserve(input.size());
-        for (size_t i = 0; i < input.size(); ++i) {
-            // i + 1 is safe - std::string adds extra '\0' at the end
-            if (input[i] == '\r' and input[i + 1] == '\n') {
-                ++i;
+        const char* pos = input.data();
+        const char* input_end = input.data() + input.size();
+        for (;;) {
+            const auto* cr = static_cast<const char*>(std::memchr(pos, '\r', input_end - pos));
+            if (cr == nullptr) {
+                filtered_input.append(pos, input_end);
+                break;
+            }
+            filtered_input.append(pos, cr);
+            // cr + 1 is safe - input is null-terminated
+            if (cr[1] != '\n') {
+                filtered_input += '\r';
             }
-            filtered_input += input[i];
+            pos = cr + 1;
         }
 
         input = filtered_input;
@@ -300,14 +360,21 @@ string CppSyntaxHighlighter::operator()(CStringView input) const {
     string str(BEGIN_GUARDS, GUARD_CHARACTER); // input without "\\\n" sequences
     str.reserve(end + 64); // Pre-allocation
 
-    for (int i = 0; i < end; ++i) {
-        // i + 1 is safe - std::string adds extra '\0' at the end
-        if (input[i] == '\\' && input[i + 1] == '\n') {
-            ++i;
-            continue;
+    for (const char *pos = input.data(), *input_end = input.data() + end;;) {
+        const auto* backslash =
+            static_cast<const char*>(std::memchr(pos, '\\', input_end - pos));
+        if (backslash == nullptr) {
+            str.append(pos, input_end);
+            break;
+        }
+        str.append(pos, backslash);
+        // backslash + 1 is safe - input is null-terminated
+        if (backslash[1] == '\n') {
+            pos = backslash + 2;
+        } else {
+            str += '\\';
+            pos = backslash + 1;
         }
-
-        str += input[i];
     }
 
     end = str.size();
@@ -323,6 +390,12 @@ string CppSyntaxHighlighter::operator()(CStringView input) const {
     /* Mark comments string / character literals */
 
     for (int i = BEGIN; i < end; ++i) {
+        // Nothing but the below characters can begin a comment or a literal
+        i = find_comment_or_literal_beginning(str.data() + i, str.data() + end) - str.data();
+        if (i == end) {
+            break;
+        }
+
         // Comments
         if (str[i] == '/') {
             if (str[i + 1] == '/') { // (One-)line comment
@@ -335,7 +408,7 @@ string CppSyntaxHighlighter::operator()(CStringView input) const {
 
             } else if (str[i + 1] == '*') { // Multi-line comment
                 begs[i] = COMMENT;
-                i += 3;
+                i = std::min(i + 3, end); // "/*" may be at the very end
                 while (i < end && !(str[i - 1] == '*' && str[i] == '/')) {
                     ++i;
                 }
@@ -648,6 +721,7 @@ string CppSyntaxHighlighter::operator()(CStringView input) const {
             return;
         }
 
+        const auto& aho = words_aho();
         auto aho_res = aho.search_in(substring(str, beg, endi));
         // Handle last one to eliminate right boundary checks
         for (int i = endi - 1; i >= beg;) {
@@ -698,11 +772,26 @@ string CppSyntaxHighlighter::operator()(CStringView input) const {
 
     /* Parse styles and produce result */
 
-    string res = "<table class=\"code-view\">"
-                 "<tbody>"
-                 "<tr><td id=\"L1\" line=\"1\"></td><td>";
+    string res;
+    {
+        // Pre-allocate the whole output at once instead of growing it repeatedly: every line and
+        // every style adds a bounded amount of markup to the (possibly escaped) code
+        constexpr size_t LINE_MARKUP_LEN = 64;
+        constexpr size_t STYLE_MARKUP_LEN = 56;
+        auto lines =
+            static_cast<size_t>(std::count(str.begin() + BEGIN, str.begin() + end, '\n'));
+        auto styles = begs.size() - static_cast<size_t>(std::count(begs.begin(), begs.end(), -1));
+        res.reserve(
+            (end - BEGIN) + (end - BEGIN) / 8 + lines * LINE_MARKUP_LEN +
+            styles * STYLE_MARKUP_LEN + 128
+        );
+    }
+    res += "<table class=\"code-view\">"
+           "<tbody>"
+           "<tr><td id=\"L1\" line=\"1\"></td><td>";
     // Stack of styles (needed to properly break on '\n')
     vector<StyleType> style_stack;
+    style_stack.reserve(8);
     int first_unescaped = BEGIN;
     // i iterates over str, j iterates over input
     for (int i = BEGIN, j = 0, line = 1; i < end; ++i, ++j) {
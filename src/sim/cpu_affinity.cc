@@ -0,0 +1,67 @@
+#include <cerrno>
+#include <pthread.h>
+#include <sched.h>
+#include <sim/cpu_affinity.hh>
+#include <simlib/concat_tostr.hh>
+#include <simlib/debug.hh>
+
+namespace sim::cpu_affinity {
+
+std::vector<int> cpus_from_config(const ConfigFile& cf, StringView var_name) {
+    STACK_UNWINDING_MARK;
+
+    std::vector<int> cpus;
+    const auto& var = cf[var_name];
+    if (not var.is_set()) {
+        return cpus;
+    }
+    for (const auto& cpu_str : var.as_array()) {
+        auto cpu = str2num<int>(cpu_str);
+        if (not cpu or *cpu < 0 or *cpu >= CPU_SETSIZE) {
+            THROW("sim.conf: ", var_name, " has to be an array of cpu numbers");
+        }
+        cpus.emplace_back(*cpu);
+    }
+    return cpus;
+}
+
+std::vector<int> judging_cpus_from_config(const ConfigFile& cf) {
+    auto cpus = cpus_from_config(cf, "js_judge_cpus");
+    auto parallel_judging_cpus = cpus_from_config(cf, "js_parallel_judging_cpus");
+    cpus.insert(cpus.end(), parallel_judging_cpus.begin(), parallel_judging_cpus.end());
+    return cpus;
+}
+
+void pin_current_thread_to(int cpu) {
+    STACK_UNWINDING_MARK;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set)) {
+        errno = rc;
+        THROW("pthread_setaffinity_np()", errmsg());
+    }
+}
+
+void exclude_from_current_thread(const std::vector<int>& cpus) {
+    STACK_UNWINDING_MARK;
+
+    cpu_set_t set;
+    if (int rc = pthread_getaffinity_np(pthread_self(), sizeof(set), &set)) {
+        errno = rc;
+        THROW("pthread_getaffinity_np()", errmsg());
+    }
+    for (int cpu : cpus) {
+        CPU_CLR(cpu, &set);
+    }
+    if (CPU_COUNT(&set) == 0) {
+        return; // Nothing would be left
+    }
+    if (int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set)) {
+        errno = rc;
+        THROW("pthread_setaffinity_np()", errmsg());
+    }
+}
+
+} // namespace sim::cpu_affinity
@@ -1,7 +1,11 @@
 #include "../../job_server/notify_file.hh"
 
+#include <algorithm>
+#include <cstring>
 #include <sim/jobs/utils.hh>
 #include <simlib/time.hh>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include <utime.h>
 
 namespace sim::jobs {
@@ -30,8 +34,8 @@ void restart_job(
         // Delete temporary files created during problem adding
         mysql
             .prepare("INSERT INTO jobs(file_id, creator, type, priority,"
-                     " status, added, aux_id, info, data) "
-                     "SELECT tmp_file_id, NULL, ?, ?, ?, ?, NULL, '', '' "
+                     " status, added, aux_id, info) "
+                     "SELECT tmp_file_id, NULL, ?, ?, ?, ?, NULL, '' "
                      "FROM jobs "
                      "WHERE id=? AND tmp_file_id IS NOT NULL")
             .bind_and_execute(
@@ -55,6 +59,17 @@ void restart_job(
 
         transaction.commit();
 
+    } else if (job_type == JT::REJUDGE_PROBLEM_BATCH) {
+        // Claim the submissions from the beginning, the already rejudged ones will be skipped
+        RejudgeProblemBatchInfo info{job_info};
+        info.last_claimed_submission_id = 0;
+        info.chunks_in_progress = 0;
+        ++info.generation;
+        info.all_claimed = false;
+
+        mysql.prepare("UPDATE jobs SET status=?, info=? WHERE id=?")
+            .bind_and_execute(EnumVal(Job::Status::PENDING), info.dump(), job_id);
+
     } else {
         // Restart job of other type
         mysql.prepare("UPDATE jobs SET status=? WHERE id=?")
@@ -77,6 +92,106 @@ void restart_job(mysql::Connection& mysql, StringView job_id, bool notify_job_se
     }
 }
 
-void notify_job_server() noexcept { utime(job_server::notify_file.data(), nullptr); }
+void save_log_part(
+    mysql::Connection& mysql,
+    decltype(Job::id) job_id,
+    uint64_t pos,
+    StringView log_part,
+    uint64_t pos_end
+) {
+    STACK_UNWINDING_MARK;
+
+    // The parts after pos are the stale ones, e.g. left by the previous run of the job
+    mysql.prepare("DELETE FROM job_logs WHERE job_id=? AND pos>=? AND pos<?")
+        .bind_and_execute(job_id, pos, pos_end);
+    if (not log_part.empty()) {
+        // Upsert, as a concurrent writer of the same positions may have inserted the part again
+        mysql
+            .prepare("INSERT INTO job_logs(job_id, pos, compressed, data) VALUES(?, ?, FALSE, ?) "
+                     "ON DUPLICATE KEY UPDATE compressed=FALSE, data=VALUES(data)")
+            .bind_and_execute(job_id, pos, log_part);
+    }
+}
+
+void append_log_part(
+    mysql::Connection& mysql, decltype(Job::id) job_id, StringView log_part, uint64_t pos_end
+) {
+    STACK_UNWINDING_MARK;
+
+    if (log_part.empty()) {
+        return;
+    }
+
+    mysql::Optional<uint64_t> log_end;
+    auto stmt = mysql.prepare("SELECT MAX(pos + IF(compressed, UNCOMPRESSED_LENGTH(data),"
+                              " LENGTH(data))) FROM job_logs WHERE job_id=? AND pos<?");
+    stmt.bind_and_execute(job_id, pos_end);
+    stmt.res_bind_all(log_end);
+    throw_assert(stmt.next());
+
+    uint64_t pos = log_end.to_opt().value_or(0);
+    if (pos >= job_log_max_size) {
+        return; // The log is full
+    }
+    log_part = log_part.substr(0, std::min<uint64_t>(log_part.size(), job_log_max_size - pos));
+    throw_assert(pos < pos_end and log_part.size() <= pos_end - pos);
+    mysql.prepare("INSERT INTO job_logs(job_id, pos, compressed, data) VALUES(?, ?, FALSE, ?)")
+        .bind_and_execute(job_id, pos, log_part);
+}
+
+void save_final_log(mysql::Connection& mysql, decltype(Job::id) job_id, StringView log) {
+    STACK_UNWINDING_MARK;
+
+    std::string truncated_log;
+    if (log.size() > job_log_max_size) {
+        truncated_log = concat_tostr(log.substr(0, job_log_max_size), "\n(log truncated)\n");
+        log = truncated_log;
+    }
+
+    mysql.prepare("DELETE FROM job_logs WHERE job_id=?").bind_and_execute(job_id);
+    if (not log.empty()) {
+        mysql
+            .prepare("INSERT INTO job_logs(job_id, pos, compressed, data) "
+                     "VALUES(?, 0, TRUE, COMPRESS(?))")
+            .bind_and_execute(job_id, log);
+    }
+}
+
+std::string load_log(mysql::Connection& mysql, decltype(Job::id) job_id, uint64_t max_size) {
+    STACK_UNWINDING_MARK;
+
+    std::string log;
+    InplaceBuff<1 << 16> log_part;
+    // The parts are fetched one by one, so that only the needed ones are read
+    auto stmt = mysql.prepare("SELECT IF(compressed, UNCOMPRESS(data), data) FROM job_logs "
+                              "WHERE job_id=? ORDER BY pos");
+    stmt.bind_and_execute(job_id);
+    stmt.res_bind_all(log_part);
+    while (log.size() < max_size and stmt.next()) {
+        log.append(log_part.data(), log_part.size);
+    }
+    return log;
+}
+
+void notify_job_server() noexcept {
+    // One socket per process is enough, as sendto() is thread-safe
+    static const int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd != -1) {
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        constexpr auto path = job_server::notify_socket;
+        static_assert(path.size() < sizeof(addr.sun_path));
+        std::memcpy(addr.sun_path, path.data(), path.size() + 1);
+
+        char msg = 'n'; // the content is irrelevant
+        auto rc =
+            sendto(fd, &msg, 1, MSG_NOSIGNAL, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        if (rc == 1) {
+            return;
+        }
+    }
+    // The job server does not listen (e.g. it is an older one) or its socket buffer is full
+    utime(job_server::notify_file.data(), nullptr);
+}
 
 } // namespace sim::jobs
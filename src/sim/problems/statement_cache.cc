@@ -0,0 +1,34 @@
+#include <cstdio>
+#include <sim/problems/statement_cache.hh>
+#include <simlib/config_file.hh>
+#include <simlib/debug.hh>
+#include <simlib/file_manip.hh>
+#include <simlib/libzip.hh>
+#include <simlib/opened_temporary_file.hh>
+#include <simlib/sim/problem_package.hh>
+
+namespace sim::problems {
+
+void extract_statement_to_cache(
+    decltype(internal_files::InternalFile::id) problem_file_id, StringView simfile
+) {
+    STACK_UNWINDING_MARK;
+
+    ConfigFile cf;
+    cf.add_vars("statement");
+    cf.load_config_from_string(simfile.to_string());
+    auto& statement = cf.get_var("statement").as_string();
+
+    ZipFile zip(internal_files::path_of(problem_file_id), ZIP_RDONLY);
+    auto contents =
+        zip.extract_to_str(zip.get_index(concat(sim::zip_package_main_dir(zip), statement)));
+
+    // Write to a temporary file and rename it to make the write atomic
+    OpenedTemporaryFile tmp_file(concat_tostr(internal_files::cache_dir, "tmp.XXXXXX"));
+    write_all_throw(tmp_file, contents);
+    if (rename(tmp_file.path(), internal_files::statement_path_of(problem_file_id))) {
+        THROW("rename()", errmsg());
+    }
+}
+
+} // namespace sim::problems
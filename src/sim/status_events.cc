@@ -0,0 +1,49 @@
+#include <cstring>
+#include <sim/status_events.hh>
+#include <simlib/concat.hh>
+#include <simlib/string_transform.hh>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace sim::status_events {
+
+void publish(Kind kind, uint64_t id) noexcept {
+    // One socket per process is enough, as sendto() is thread-safe
+    static const int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd == -1) {
+        return;
+    }
+
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    static_assert(socket_path.size() < sizeof(addr.sun_path));
+    std::memcpy(addr.sun_path, socket_path.data(), socket_path.size() + 1);
+
+    auto msg = concat<24>(static_cast<char>(kind), id);
+    (void)sendto(
+        fd, msg.data(), msg.size, MSG_NOSIGNAL, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)
+    );
+}
+
+std::optional<std::pair<Kind, uint64_t>> parse(StringView datagram) noexcept {
+    if (datagram.empty()) {
+        return std::nullopt;
+    }
+
+    Kind kind{};
+    switch (datagram[0]) {
+    case static_cast<char>(Kind::SUBMISSION): kind = Kind::SUBMISSION; break;
+    case static_cast<char>(Kind::JOB): kind = Kind::JOB; break;
+    case static_cast<char>(Kind::USER): kind = Kind::USER; break;
+    case static_cast<char>(Kind::PROBLEM): kind = Kind::PROBLEM; break;
+    default: return std::nullopt;
+    }
+
+    auto id = str2num<uint64_t>(datagram.substring(1, datagram.size()));
+    if (not id) {
+        return std::nullopt;
+    }
+    return std::pair{kind, *id};
+}
+
+} // namespace sim::status_events
@@ -28,6 +28,9 @@ update_problem_final(mysql::Connection& mysql, uint64_t submission_owner, uint64
             .prepare("UPDATE submissions SET problem_final=0 "
                      "WHERE owner=? AND problem_id=? AND problem_final=1")
             .bind_and_execute(submission_owner, problem_id);
+        mysql
+            .prepare("DELETE FROM user_problem_statuses WHERE user_id=? AND problem_id=?")
+            .bind_and_execute(submission_owner, problem_id);
         return; // Nothing more to be done
     }
 
@@ -57,6 +60,12 @@ update_problem_final(mysql::Connection& mysql, uint64_t submission_owner, uint64
         .prepare("UPDATE submissions SET problem_final=IF(id=?, 1, 0) "
                  "WHERE owner=? AND problem_id=? AND (problem_final=1 OR id=?)")
         .bind_and_execute(new_final_id, submission_owner, problem_id, new_final_id);
+
+    mysql
+        .prepare("INSERT INTO user_problem_statuses(user_id, problem_id, full_status, score) "
+                 "VALUES(?, ?, ?, ?) "
+                 "ON DUPLICATE KEY UPDATE full_status=VALUES(full_status), score=VALUES(score)")
+        .bind_and_execute(submission_owner, problem_id, full_status, final_score);
 }
 
 static void update_contest_final(
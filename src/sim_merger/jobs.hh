@@ -4,11 +4,18 @@
 #include "submissions.hh"
 #include "users.hh"
 
+#include <map>
 #include <sim/jobs/utils.hh>
+#include <string>
 
 namespace sim_merger {
 
-class JobsMerger : public Merger<sim::jobs::Job> {
+// Logs are kept in the job_logs table, but are merged along with the jobs
+struct JobWithLog : sim::jobs::Job {
+    std::string log;
+};
+
+class JobsMerger : public Merger<JobWithLog> {
     const InternalFilesMerger& internal_files_;
     const UsersMerger& users_;
     const SubmissionsMerger& submissions_;
@@ -21,15 +28,31 @@ class JobsMerger : public Merger<sim::jobs::Job> {
         STACK_UNWINDING_MARK;
         using sim::jobs::Job;
 
-        Job job;
+        // Logs consist of parts, so they are loaded apart from the jobs
+        std::map<decltype(Job::id), std::string> logs;
+        {
+            decltype(Job::id) job_id = 0;
+            InplaceBuff<1 << 16> log_part;
+            auto stmt = conn.prepare(
+                "SELECT job_id, IF(compressed, UNCOMPRESS(data), data) FROM ",
+                record_set.sql_table_prefix,
+                "job_logs ORDER BY job_id, pos"
+            );
+            stmt.bind_and_execute();
+            stmt.res_bind_all(job_id, log_part);
+            while (stmt.next()) {
+                logs[job_id].append(log_part.data(), log_part.size);
+            }
+        }
+
+        JobWithLog job;
         mysql::Optional<decltype(job.file_id)::value_type> m_file_id;
         mysql::Optional<decltype(job.tmp_file_id)::value_type> m_tmp_file_id;
         mysql::Optional<decltype(job.creator)::value_type> m_creator;
         mysql::Optional<decltype(job.aux_id)::value_type> m_aux_id;
         auto stmt = conn.prepare(
             "SELECT id, file_id, tmp_file_id, creator, type,"
-            " priority, status, added, aux_id, info, data "
-            "FROM ",
+            " priority, status, added, aux_id, info FROM ",
             record_set.sql_table_name
         );
         stmt.bind_and_execute();
@@ -43,10 +66,14 @@ class JobsMerger : public Merger<sim::jobs::Job> {
             job.status,
             job.added,
             m_aux_id,
-            job.info,
-            job.data
+            job.info
         );
         while (stmt.next()) {
+            if (auto it = logs.find(job.id); it != logs.end()) {
+                job.log = std::move(it->second);
+            } else {
+                job.log.clear();
+            }
             job.file_id = m_file_id.to_opt();
             job.tmp_file_id = m_tmp_file_id.to_opt();
             job.creator = m_creator.to_opt();
@@ -89,6 +116,22 @@ class JobsMerger : public Merger<sim::jobs::Job> {
                 break;
             }
 
+            case Job::Type::REJUDGE_PROBLEM_BATCH: {
+                job.aux_id = problems_.new_id(job.aux_id.value(), record_set.kind);
+                auto info = sim::jobs::RejudgeProblemBatchInfo(job.info);
+                if (info.contest_problem_id) {
+                    info.contest_problem_id =
+                        contest_problems_.new_id(info.contest_problem_id.value(), record_set.kind);
+                }
+                // Submission ids change, so the progress is reset; the already rejudged
+                // submissions are skipped anyway
+                info.last_claimed_submission_id = 0;
+                info.chunks_in_progress = 0;
+                info.all_claimed = false;
+                job.info = info.dump();
+                break;
+            }
+
             case Job::Type::MERGE_USERS: {
                 job.aux_id = users_.new_id(job.aux_id.value(), record_set.kind);
                 auto info = sim::jobs::MergeUsersInfo(job.info);
@@ -132,7 +175,7 @@ class JobsMerger : public Merger<sim::jobs::Job> {
 
     void merge() override {
         STACK_UNWINDING_MARK;
-        Merger::merge([&](const sim::jobs::Job& /*unused*/) { return nullptr; });
+        Merger::merge([&](const JobWithLog& /*unused*/) { return nullptr; });
     }
 
 public:
@@ -144,9 +187,12 @@ public:
             "INSERT INTO ",
             sql_table_name(),
             "(id, file_id, tmp_file_id, creator, type, priority,"
-            " status, added, aux_id, info, data) "
-            "VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"
+            " status, added, aux_id, info) "
+            "VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"
         );
+        conn.update("TRUNCATE job_logs");
+        auto log_stmt = conn.prepare("INSERT INTO job_logs(job_id, pos, compressed, data) "
+                                     "VALUES(?, 0, TRUE, COMPRESS(?))");
 
         ProgressBar progress_bar("Jobs saved:", new_table_.size(), 128);
         for (const NewRecord& new_record : new_table_) {
@@ -162,9 +208,11 @@ public:
                 x.status,
                 x.added,
                 x.aux_id,
-                x.info,
-                x.data
+                x.info
             );
+            if (not x.log.empty()) {
+                log_stmt.bind_and_execute(x.id, x.log);
+            }
         }
 
         conn.update("ALTER TABLE ", sql_table_name(), " AUTO_INCREMENT=", last_new_id_ + 1);
@@ -134,6 +134,15 @@ struct PrimaryKeysFromJobs {
                 problems.add_id(sim::jobs::MergeProblemsInfo(info).target_problem_id, added);
                 break;
 
+            case Job::Type::REJUDGE_PROBLEM_BATCH: {
+                problems.add_id(aux_id.value(), added);
+                auto cpid = sim::jobs::RejudgeProblemBatchInfo(info).contest_problem_id;
+                if (cpid.has_value()) {
+                    contest_problems.add_id(cpid.value(), added);
+                }
+                break;
+            }
+
             case Job::Type::DELETE_USER: users.add_id(aux_id.value(), added); break;
 
             case Job::Type::MERGE_USERS:
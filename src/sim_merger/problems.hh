@@ -45,7 +45,7 @@ class ProblemsMerger : public Merger<sim::problems::Problem> {
         mysql::Optional<decltype(prob.owner_id)::value_type> m_owner_id;
         auto stmt = conn.prepare(
             "SELECT id, file_id, type, name, label, "
-            "simfile, owner_id, created_at, updated_at FROM ",
+            "simfile, parallel_judging, owner_id, created_at, updated_at FROM ",
             record_set.sql_table_name
         );
         stmt.bind_and_execute();
@@ -56,6 +56,7 @@ class ProblemsMerger : public Merger<sim::problems::Problem> {
             prob.name,
             prob.label,
             prob.simfile,
+            prob.parallel_judging,
             m_owner_id,
             prob.created_at,
             prob.updated_at
@@ -146,8 +147,8 @@ public:
             "INSERT INTO ",
             sql_table_name(),
             "(id, file_id, type, name, label, simfile,"
-            " owner_id, created_at, updated_at) "
-            "VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?)"
+            " parallel_judging, owner_id, created_at, updated_at) "
+            "VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"
         );
 
         ProgressBar progress_bar("Problems saved:", new_table_.size(), 128);
@@ -161,6 +162,7 @@ public:
                 x.name,
                 x.label,
                 x.simfile,
+                x.parallel_judging,
                 x.owner_id,
                 x.created_at,
                 x.updated_at
@@ -192,7 +194,7 @@ public:
         for (auto [src_id, dest_id] : to_merge_) {
             throw_assert(src_id != dest_id);
             conn.prepare("INSERT jobs (creator, status, priority, type, added,"
-                         " aux_id, info, data) VALUES(NULL, ?, ?, ?, ?, ?, ?, '')")
+                         " aux_id, info) VALUES(NULL, ?, ?, ?, ?, ?, ?)")
                 .bind_and_execute(
                     EnumVal(sim::jobs::Job::Status::PENDING),
                     default_priority(sim::jobs::Job::Type::MERGE_PROBLEMS),
@@ -219,8 +221,8 @@ private:
     static void schedule_reseting_problem_time_limits(decltype(sim::problems::Problem::id
     ) problem_new_id) {
         conn.prepare("INSERT jobs (creator, status, priority, type, added, aux_id,"
-                     " info, data) "
-                     "VALUES(NULL, ?, ?, ?, ?, ?, '', '')")
+                     " info) "
+                     "VALUES(NULL, ?, ?, ?, ?, ?, '')")
             .bind_and_execute(
                 EnumVal(sim::jobs::Job::Status::PENDING),
                 default_priority(
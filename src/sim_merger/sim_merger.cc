@@ -338,6 +338,15 @@ static int true_main(int argc, char** argv) {
         merger->save_merged();
         saves_to_rollback.emplace_back(merger);
     }
+    // Ranking snapshots are derived data and will be recreated on demand
+    stdlog("> \033[1;36mcontest_ranking_snapshots\033[m...");
+    conn.update("TRUNCATE contest_ranking_snapshots");
+    // Problem statuses of users are derived from the final submissions
+    stdlog("> \033[1;36muser_problem_statuses\033[m...");
+    conn.update("DELETE FROM user_problem_statuses");
+    conn.update("INSERT INTO user_problem_statuses(user_id, problem_id, full_status, score) "
+                "SELECT owner, problem_id, full_status, score FROM submissions "
+                "WHERE problem_final=1 AND owner IS NOT NULL");
     conn.update("SET FOREIGN_KEY_CHECKS=1");
 
     stdlog("\033[1;36mRunning after-saving hooks:\033[m");
@@ -349,6 +358,12 @@ static int true_main(int argc, char** argv) {
     conn.update("COMMIT");
     conn.update("SET AUTOCOMMIT=1");
 
+    // Cached data is keyed by internal file ids, which have changed
+    stdlog("\033[1;33mClearing internal files cache\033[m");
+    auto internal_files_cache_path = concat(main_sim_build, sim::internal_files::cache_dir);
+    (void)remove_r(internal_files_cache_path);
+    (void)mkdir(internal_files_cache_path);
+
     stdlog("\033[1;32mSim merging is complete\033[m");
     saves_to_rollback.clear();
     merge_successful = true;
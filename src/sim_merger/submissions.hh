@@ -4,9 +4,18 @@
 #include "internal_files.hh"
 #include "problems.hh"
 
+#include <sim/sql_fields/blob.hh>
+#include <sim/submissions/submission.hh>
+
 namespace sim_merger {
 
-class SubmissionsMerger : public Merger<sim::submissions::Submission> {
+// Reports are kept in the submission_reports table, but are merged along with the submissions
+struct SubmissionWithReports : sim::submissions::Submission {
+    sim::sql_fields::Blob<0> initial_report;
+    sim::sql_fields::Blob<0> final_report;
+};
+
+class SubmissionsMerger : public Merger<SubmissionWithReports> {
     const InternalFilesMerger& internal_files_;
     const UsersMerger& users_;
     const ProblemsMerger& problems_;
@@ -17,7 +26,7 @@ class SubmissionsMerger : public Merger<sim::submissions::Submission> {
     void load(RecordSet& record_set) override {
         STACK_UNWINDING_MARK;
 
-        sim::submissions::Submission s;
+        SubmissionWithReports s;
         mysql::Optional<decltype(s.owner)::value_type> m_owner;
         mysql::Optional<decltype(s.contest_problem_id)::value_type> m_contest_problem_id;
         mysql::Optional<decltype(s.contest_round_id)::value_type> m_contest_round_id;
@@ -29,9 +38,12 @@ class SubmissionsMerger : public Merger<sim::submissions::Submission> {
             " type, language, final_candidate, problem_final,"
             " contest_final, contest_initial_final, initial_status,"
             " full_status, submit_time, score, last_judgment,"
-            " initial_report, final_report "
+            " COALESCE(r.initial_report, ''), COALESCE(r.final_report, '') "
             "FROM ",
-            record_set.sql_table_name
+            record_set.sql_table_name,
+            " s LEFT JOIN ",
+            record_set.sql_table_prefix,
+            "submission_reports r ON r.submission_id=s.id"
         );
         stmt.bind_and_execute();
         stmt.res_bind_all(
@@ -88,7 +100,7 @@ class SubmissionsMerger : public Merger<sim::submissions::Submission> {
 
     void merge() override {
         STACK_UNWINDING_MARK;
-        Merger::merge([&](const sim::submissions::Submission& /*unused*/) { return nullptr; });
+        Merger::merge([&](const SubmissionWithReports& /*unused*/) { return nullptr; });
     }
 
 public:
@@ -103,11 +115,12 @@ public:
             " contest_round_id, contest_id, type, language,"
             " final_candidate, problem_final, contest_final,"
             " contest_initial_final, initial_status, full_status,"
-            " submit_time, score, last_judgment, initial_report,"
-            " final_report) "
-            "VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?,"
-            " ?, ?, ?, ?)"
+            " submit_time, score, last_judgment) "
+            "VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"
         );
+        conn.update("TRUNCATE submission_reports");
+        auto report_stmt = conn.prepare("INSERT INTO submission_reports(submission_id,"
+                                        " initial_report, final_report) VALUES(?, ?, ?)");
 
         ProgressBar progress_bar("Submissions saved:", new_table_.size(), 128);
         for (const NewRecord& new_record : new_table_) {
@@ -131,10 +144,11 @@ public:
                 x.full_status,
                 x.submit_time,
                 x.score,
-                x.last_judgment,
-                x.initial_report,
-                x.final_report
+                x.last_judgment
             );
+            if (not x.initial_report.empty() or not x.final_report.empty()) {
+                report_stmt.bind_and_execute(x.id, x.initial_report, x.final_report);
+            }
         }
 
         conn.update("ALTER TABLE ", sql_table_name(), " AUTO_INCREMENT=", last_new_id_ + 1);
@@ -173,6 +173,22 @@ static int perform_upgrade() {
     conn.update("ALTER TABLE problems RENAME COLUMN owner TO owner_id");
     conn.update("ALTER TABLE problems RENAME COLUMN added TO created_at");
     conn.update("ALTER TABLE problems RENAME COLUMN last_edit TO updated_at");
+    conn.update("ALTER TABLE problems ADD COLUMN parallel_judging BOOLEAN NOT NULL DEFAULT FALSE "
+                "AFTER simfile");
+
+    // Table user_problem_statuses is created by setup-installation run during the installation
+    conn.update("INSERT IGNORE INTO user_problem_statuses(user_id, problem_id, full_status, score) "
+                "SELECT owner, problem_id, full_status, score FROM submissions "
+                "WHERE problem_final=1 AND owner IS NOT NULL");
+
+    // Tables submission_reports and job_logs are created by setup-installation as well
+    conn.update("INSERT IGNORE INTO submission_reports(submission_id, initial_report,"
+                " final_report) SELECT id, initial_report, final_report FROM submissions "
+                "WHERE initial_report!='' OR final_report!=''");
+    conn.update("INSERT IGNORE INTO job_logs(job_id, pos, data) "
+                "SELECT id, 0, data FROM jobs WHERE data!=''");
+    conn.update("ALTER TABLE submissions DROP COLUMN initial_report, DROP COLUMN final_report");
+    conn.update("ALTER TABLE jobs DROP COLUMN data");
 
     // update_db_schema([&] { conn.update("RENAME TABLE session TO sessions"); });
 
@@ -4,7 +4,7 @@
 #include <simlib/string_view.hh>
 
 // Tables in topological order (every table depends only on the previous tables)
-constexpr std::array<CStringView, 13> tables = {{
+constexpr std::array<CStringView, 17> tables = {{
     "internal_files",
     "users",
     "sessions",
@@ -16,6 +16,10 @@ constexpr std::array<CStringView, 13> tables = {{
     "contest_users",
     "contest_files",
     "contest_entry_tokens",
+    "contest_ranking_snapshots",
     "submissions",
+    "submission_reports",
+    "user_problem_statuses",
     "jobs",
+    "job_logs",
 }};
@@ -340,6 +340,7 @@ Response use(Context& ctx, StringView token_or_short_token) {
         if (stmt.affected_rows() == 0) {
             return ctx.response_400("You already participate in the contest");
         }
+        ctx.invalidate_contest_permissions_after_commit = ctx.session->user_id;
         return ctx.response_ok();
     });
 }
@@ -0,0 +1,70 @@
+#include "contest_permissions_cache.hh"
+
+namespace web_server {
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+ContestPermissionsCache contest_permissions_cache;
+
+std::optional<sim::contests::Permissions>
+ContestPermissionsCache::find(UserId user_id, ContestId contest_id) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = entries_.find(Key{user_id, contest_id});
+    if (it == entries_.end()) {
+        return std::nullopt;
+    }
+    if (it->second.expires <= std::chrono::steady_clock::now()) {
+        entries_.erase(it);
+        return std::nullopt;
+    }
+    return it->second.perms;
+}
+
+uint64_t ContestPermissionsCache::generation() noexcept {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return generation_;
+}
+
+void ContestPermissionsCache::insert(
+    UserId user_id, ContestId contest_id, sim::contests::Permissions perms, uint64_t read_generation
+) {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (read_generation != generation_) {
+        return; // The permissions might have been read before the invalidation
+    }
+
+    if (entries_.size() >= MAX_ENTRIES) {
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            it = (it->second.expires <= now ? entries_.erase(it) : std::next(it));
+        }
+        if (entries_.size() >= MAX_ENTRIES) {
+            entries_.clear();
+        }
+    }
+
+    entries_.insert_or_assign(Key{user_id, contest_id}, Entry{perms, now + TTL});
+}
+
+void ContestPermissionsCache::invalidate(UserId user_id, ContestId contest_id) noexcept {
+    std::lock_guard<std::mutex> lock(mtx_);
+    ++generation_;
+    entries_.erase(Key{user_id, contest_id});
+}
+
+void ContestPermissionsCache::invalidate_user(UserId user_id) noexcept {
+    std::lock_guard<std::mutex> lock(mtx_);
+    ++generation_;
+    entries_.erase(
+        entries_.lower_bound(Key{user_id, 0}), entries_.upper_bound(Key{user_id, ~ContestId{0}})
+    );
+}
+
+void ContestPermissionsCache::invalidate_contest(ContestId contest_id) noexcept {
+    std::lock_guard<std::mutex> lock(mtx_);
+    ++generation_;
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        it = (it->first.second == contest_id ? entries_.erase(it) : std::next(it));
+    }
+}
+
+} // namespace web_server
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <sim/contests/permissions.hh>
+#include <utility>
+
+namespace web_server {
+
+// Process-wide cache of sim::contests::Permissions of users (0 denotes the anonymous user) in
+// contests. Entries expire after TTL, which bounds staleness caused by changes the web server
+// is not notified about (e.g. deleting a contest). Changes made by the web server and merging
+// users (via sim::status_events) invalidate the affected entries explicitly.
+class ContestPermissionsCache {
+public:
+    using UserId = uint64_t;
+    using ContestId = uint64_t;
+
+    static constexpr std::chrono::seconds TTL{10};
+    static constexpr size_t MAX_ENTRIES = 1 << 16;
+
+private:
+    struct Entry {
+        sim::contests::Permissions perms;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    using Key = std::pair<UserId, ContestId>;
+
+    std::mutex mtx_;
+    uint64_t generation_ = 0; // incremented by every invalidation
+    std::map<Key, Entry> entries_;
+
+public:
+    ContestPermissionsCache() = default;
+
+    ContestPermissionsCache(const ContestPermissionsCache&) = delete;
+    ContestPermissionsCache(ContestPermissionsCache&&) = delete;
+    ContestPermissionsCache& operator=(const ContestPermissionsCache&) = delete;
+    ContestPermissionsCache& operator=(ContestPermissionsCache&&) = delete;
+    ~ContestPermissionsCache() = default;
+
+    std::optional<sim::contests::Permissions> find(UserId user_id, ContestId contest_id);
+
+    // Has to be taken before reading the permissions from the database and passed to insert(),
+    // so that permissions read before a concurrent invalidation are not cached
+    uint64_t generation() noexcept;
+
+    void insert(
+        UserId user_id,
+        ContestId contest_id,
+        sim::contests::Permissions perms,
+        uint64_t read_generation
+    );
+
+    // Invalidation functions have to be called after the change is committed
+    void invalidate(UserId user_id, ContestId contest_id) noexcept;
+
+    void invalidate_user(UserId user_id) noexcept;
+
+    void invalidate_contest(ContestId contest_id) noexcept;
+};
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+extern ContestPermissionsCache contest_permissions_cache;
+
+} // namespace web_server
@@ -0,0 +1,65 @@
+#include "conditional_get.hh"
+
+#include <algorithm>
+#include <simlib/time.hh>
+#include <string_view>
+
+namespace web_server::http {
+
+namespace {
+
+std::string_view without_weak_prefix(std::string_view etag) noexcept {
+    if (etag.substr(0, 2) == "W/") {
+        etag.remove_prefix(2);
+    }
+    return etag;
+}
+
+bool etag_list_matches(std::string_view etag_list, std::string_view etag) noexcept {
+    etag = without_weak_prefix(etag);
+    while (not etag_list.empty()) {
+        auto elem = etag_list.substr(0, etag_list.find(','));
+        etag_list.remove_prefix(std::min(elem.size() + 1, etag_list.size()));
+        auto beg = elem.find_first_not_of(' ');
+        if (beg == std::string_view::npos) {
+            continue;
+        }
+        elem = elem.substr(beg, elem.find_last_not_of(' ') + 1 - beg);
+        if (elem == "*" or without_weak_prefix(elem) == etag) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+bool is_not_modified(
+    const Request& req, StringView etag, std::optional<time_t> last_modified
+) noexcept {
+    if (auto if_none_match = req.headers.get("if-none-match"); if_none_match) {
+        return etag_list_matches(
+            std::string_view{if_none_match->data(), if_none_match->size()},
+            std::string_view{etag.data(), etag.size()}
+        );
+    }
+
+    auto if_modified_since = req.headers.get("if-modified-since");
+    if (not if_modified_since or not last_modified) {
+        return false;
+    }
+    struct tm client_mtime = {};
+    return strptime(if_modified_since->data(), "%a, %d %b %Y %H:%M:%S GMT", &client_mtime) !=
+        nullptr and
+        timegm(&client_mtime) >= *last_modified;
+}
+
+void set_validators(Response& resp, StringView etag, std::optional<time_t> last_modified) {
+    resp.headers["etag"] = etag.to_string();
+    if (last_modified) {
+        resp.headers["last-modified"] = date("%a, %d %b %Y %H:%M:%S GMT", *last_modified);
+    }
+    resp.headers["cache-control"] = "private, no-cache";
+}
+
+} // namespace web_server::http
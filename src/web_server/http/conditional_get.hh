@@ -0,0 +1,22 @@
+#pragma once
+
+#include "request.hh"
+#include "response.hh"
+
+#include <ctime>
+#include <optional>
+#include <simlib/string_view.hh>
+
+namespace web_server::http {
+
+// Returns true if the copy cached by the client is still valid for the representation with
+// validators @p etag and @p last_modified. Checks If-None-Match (weak comparison) or, only in its
+// absence, If-Modified-Since.
+bool is_not_modified(
+    const Request& req, StringView etag, std::optional<time_t> last_modified
+) noexcept;
+
+// Sets ETag, Last-Modified (if present) and makes the client revalidate the response on every use
+void set_validators(Response& resp, StringView etag, std::optional<time_t> last_modified);
+
+} // namespace web_server::http
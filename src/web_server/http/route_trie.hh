@@ -0,0 +1,415 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <simlib/string_view.hh>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace web_server::http {
+
+// Method the route is bound to. ANY routes match requests of every method.
+enum class RouteMethod : uint8_t { ANY, GET, POST };
+
+struct RouteCapture {
+    std::string_view str; // raw (not URI-decoded) segment, without the literal prefix of {u64}
+    uint64_t u64 = 0; // set only for {u64}
+};
+
+struct RouteMatch {
+    static constexpr size_t MAX_CAPTURES = 8;
+    static constexpr size_t NONE = std::numeric_limits<size_t>::max();
+
+    size_t route = NONE; // index of the matched pattern
+    size_t captures_num = 0;
+    std::array<RouteCapture, MAX_CAPTURES> captures{};
+    // Part of the path matched by the trailing "/**", it is empty or begins with '/'
+    std::string_view rest;
+
+    constexpr explicit operator bool() const noexcept { return route != NONE; }
+};
+
+namespace detail {
+
+enum class SegmentKind : uint8_t { LITERAL, U64, STRING }; // in the order of precedence
+
+struct Segment {
+    SegmentKind kind;
+    std::string_view literal; // the literal or the prefix of {u64}
+};
+
+constexpr Segment parse_segment(std::string_view segment) noexcept {
+    constexpr std::string_view U64_CAPTURE = "{u64}";
+    if (segment == "{string}" or segment == "{custom}") {
+        return {SegmentKind::STRING, {}};
+    }
+    if (segment.size() >= U64_CAPTURE.size() and
+        segment.substr(segment.size() - U64_CAPTURE.size()) == U64_CAPTURE)
+    {
+        return {SegmentKind::U64, segment.substr(0, segment.size() - U64_CAPTURE.size())};
+    }
+    return {SegmentKind::LITERAL, segment};
+}
+
+constexpr bool is_rest(std::string_view segment) noexcept { return segment == "**"; }
+
+// Splits off the method that the @p pattern begins with
+constexpr RouteMethod extract_method(std::string_view& pattern) noexcept {
+    constexpr std::string_view GET = "GET ";
+    constexpr std::string_view POST = "POST ";
+    if (pattern.substr(0, GET.size()) == GET) {
+        pattern.remove_prefix(GET.size());
+        return RouteMethod::GET;
+    }
+    if (pattern.substr(0, POST.size()) == POST) {
+        pattern.remove_prefix(POST.size());
+        return RouteMethod::POST;
+    }
+    return RouteMethod::ANY;
+}
+
+constexpr std::optional<uint64_t> parse_u64(std::string_view str) noexcept {
+    if (str.empty()) {
+        return std::nullopt;
+    }
+    uint64_t res = 0;
+    for (char c : str) {
+        if (c < '0' or c > '9') {
+            return std::nullopt;
+        }
+        auto digit = static_cast<uint64_t>(c - '0');
+        if (res > (std::numeric_limits<uint64_t>::max() - digit) / 10) {
+            return std::nullopt;
+        }
+        res = res * 10 + digit;
+    }
+    return res;
+}
+
+// Splits off the first segment of the @p path that begins with '/'
+constexpr std::string_view extract_segment(std::string_view& path) noexcept {
+    path.remove_prefix(1);
+    auto segment = path.substr(0, path.find('/'));
+    path.remove_prefix(segment.size());
+    return segment;
+}
+
+template <size_t N>
+constexpr size_t slashes_num(const std::string_view (&patterns)[N]) noexcept {
+    size_t res = 0;
+    for (auto pattern : patterns) {
+        for (char c : pattern) {
+            res += (c == '/');
+        }
+    }
+    return res;
+}
+
+} // namespace detail
+
+// Returns the number of the trie nodes sufficient for the patterns from @p pattern_lists
+template <size_t... N>
+constexpr size_t route_trie_nodes_bound(const std::string_view (&... pattern_lists)[N]) noexcept {
+    return 1 + (detail::slashes_num(pattern_lists) + ... + 0); // 1 for the root
+}
+
+// Returns the index of the pattern of @p path_pattern bound to @p method in @p patterns or
+// RouteMatch::NONE
+template <size_t N>
+constexpr size_t route_index(
+    const std::string_view (&patterns)[N], RouteMethod method, std::string_view path_pattern
+) noexcept {
+    for (size_t i = 0; i < N; ++i) {
+        auto pattern = patterns[i];
+        if (detail::extract_method(pattern) == method and pattern == path_pattern) {
+            return i;
+        }
+    }
+    return RouteMatch::NONE;
+}
+
+// URL router meant to be built at compile time. A pattern is an optional method ("GET " or
+// "POST ", without it the route matches every method) followed by a sequence of segments, each
+// preceded by '/'. A segment is either a literal or a capture: {u64} (a decimal number, it may be
+// preceded by a literal prefix, e.g. c{u64} matches "c42") or {string} / {custom} (a non-empty
+// segment, that is parsed by the caller). The last segment may be ** that matches the rest of the
+// path (also the empty one). The path is matched segment by segment in a single pass
+// (backtracking happens only if more than one child matches a segment) and without
+// allocations. The path is not URI-decoded, so literals containing special characters have to be
+// written encoded (e.g. "id%3C").
+template <size_t MAX_NODES>
+class RouteTrie {
+    using SegmentKind = detail::SegmentKind;
+    // Indexed by RouteMethod
+    using Routes = std::array<size_t, 3>;
+
+    struct Node {
+        SegmentKind kind = SegmentKind::LITERAL;
+        std::string_view literal; // the literal or the prefix of {u64}
+        size_t first_child = RouteMatch::NONE;
+        size_t next_sibling = RouteMatch::NONE;
+        Routes routes = {RouteMatch::NONE, RouteMatch::NONE, RouteMatch::NONE};
+        // Routes ending with "/**"
+        Routes rest_routes = {RouteMatch::NONE, RouteMatch::NONE, RouteMatch::NONE};
+    };
+
+    std::array<Node, MAX_NODES> nodes_{};
+    size_t nodes_num_ = 1; // the root
+    size_t routes_num_ = 0;
+
+public:
+    constexpr RouteTrie() = default;
+
+    // Route indexes are the indexes of the patterns in the concatenation of @p pattern_lists
+    template <size_t... N>
+    constexpr explicit RouteTrie(const std::string_view (&... pattern_lists)[N]) {
+        (add_all(pattern_lists), ...);
+    }
+
+    // Returns index of the added route. Throws on an invalid or duplicated pattern and if there
+    // is not enough nodes, which in the constant evaluation results in a compilation error.
+    constexpr size_t add(std::string_view pattern) {
+        auto method = detail::extract_method(pattern);
+        if (pattern.empty() or pattern[0] != '/') {
+            throw std::invalid_argument("Route pattern has to begin with '/'");
+        }
+
+        size_t node = 0;
+        size_t captures_num = 0;
+        bool is_rest = false;
+        while (not pattern.empty()) {
+            auto segment = detail::extract_segment(pattern);
+            if (detail::is_rest(segment)) {
+                if (not pattern.empty()) {
+                    throw std::invalid_argument("** has to be the last segment of the pattern");
+                }
+                is_rest = true;
+                break;
+            }
+            auto parsed = detail::parse_segment(segment);
+            if (parsed.kind != SegmentKind::LITERAL and
+                ++captures_num > RouteMatch::MAX_CAPTURES)
+            {
+                throw std::invalid_argument("Too many captures in the route pattern");
+            }
+            node = child(node, parsed);
+        }
+
+        auto& routes = is_rest ? nodes_[node].rest_routes : nodes_[node].routes;
+        auto& route = routes[static_cast<size_t>(method)];
+        if (route != RouteMatch::NONE) {
+            throw std::invalid_argument("Duplicated route pattern");
+        }
+        return route = routes_num_++;
+    }
+
+    [[nodiscard]] constexpr size_t routes_num() const noexcept { return routes_num_; }
+
+    // Matches the path of @p target (the query part is ignored) requested with @p method (HEAD
+    // requests should be matched as GET). Routes bound to @p method take precedence over the ones
+    // bound to ANY and routes ending with "/**" are matched only if nothing else matches.
+    [[nodiscard]] constexpr RouteMatch
+    match(RouteMethod method, std::string_view target) const noexcept {
+        RouteMatch res;
+        (void)match_from(0, path_of(target), method, res);
+        return res;
+    }
+
+private:
+    template <size_t N>
+    constexpr void add_all(const std::string_view (&patterns)[N]) {
+        for (auto pattern : patterns) {
+            add(pattern);
+        }
+    }
+
+    static constexpr std::string_view path_of(std::string_view target) noexcept {
+        return target.substr(0, target.find('?'));
+    }
+
+    static constexpr size_t route_for(const Routes& routes, RouteMethod method) noexcept {
+        auto route = routes[static_cast<size_t>(method)];
+        return route != RouteMatch::NONE ? route : routes[static_cast<size_t>(RouteMethod::ANY)];
+    }
+
+    constexpr size_t child(size_t node, detail::Segment segment) {
+        // Children are kept in the order of precedence
+        size_t* link = &nodes_[node].first_child;
+        while (*link != RouteMatch::NONE and nodes_[*link].kind <= segment.kind) {
+            auto& ch = nodes_[*link];
+            if (ch.kind == segment.kind and ch.literal == segment.literal) {
+                return *link;
+            }
+            link = &ch.next_sibling;
+        }
+
+        if (nodes_num_ == MAX_NODES) {
+            throw std::length_error("RouteTrie: too many nodes");
+        }
+        auto& new_node = nodes_[nodes_num_];
+        new_node.kind = segment.kind;
+        new_node.literal = segment.literal;
+        new_node.next_sibling = *link;
+        *link = nodes_num_;
+        return nodes_num_++;
+    }
+
+    constexpr bool match_from(
+        size_t node, std::string_view path, RouteMethod method, RouteMatch& res
+    ) const noexcept {
+        if (path.empty()) {
+            res.route = route_for(nodes_[node].routes, method);
+            if (res.route != RouteMatch::NONE) {
+                res.rest = path;
+                return true;
+            }
+        } else {
+            auto rest = path;
+            auto segment = detail::extract_segment(rest);
+            for (size_t ch = nodes_[node].first_child; ch != RouteMatch::NONE;
+                 ch = nodes_[ch].next_sibling)
+            {
+                const auto& child_node = nodes_[ch];
+                switch (child_node.kind) {
+                case SegmentKind::LITERAL: {
+                    if (child_node.literal != segment) {
+                        continue;
+                    }
+                    if (match_from(ch, rest, method, res)) {
+                        return true;
+                    }
+                } break;
+                case SegmentKind::U64: {
+                    const auto& prefix = child_node.literal;
+                    if (segment.substr(0, prefix.size()) != prefix or
+                        res.captures_num == RouteMatch::MAX_CAPTURES)
+                    {
+                        continue;
+                    }
+                    auto digits = segment.substr(prefix.size());
+                    auto num = detail::parse_u64(digits);
+                    if (not num) {
+                        continue;
+                    }
+                    res.captures[res.captures_num++] = {digits, *num};
+                    if (match_from(ch, rest, method, res)) {
+                        return true;
+                    }
+                    --res.captures_num;
+                } break;
+                case SegmentKind::STRING: {
+                    if (segment.empty() or res.captures_num == RouteMatch::MAX_CAPTURES) {
+                        continue;
+                    }
+                    res.captures[res.captures_num++] = {segment, 0};
+                    if (match_from(ch, rest, method, res)) {
+                        return true;
+                    }
+                    --res.captures_num;
+                } break;
+                }
+            }
+        }
+
+        res.route = route_for(nodes_[node].rest_routes, method);
+        res.rest = path;
+        return res.route != RouteMatch::NONE;
+    }
+};
+
+namespace detail {
+
+template <const char* pattern>
+constexpr size_t captures_num() noexcept {
+    size_t res = 0;
+    std::string_view path = pattern;
+    (void)extract_method(path);
+    while (not path.empty()) {
+        res += parse_segment(extract_segment(path)).kind != SegmentKind::LITERAL;
+    }
+    return res;
+}
+
+// For each capture of @p pattern: the index of its custom parser or RouteMatch::NONE
+template <const char* pattern>
+constexpr auto custom_parser_indexes() noexcept {
+    std::array<size_t, captures_num<pattern>()> res{};
+    size_t i = 0;
+    size_t customs = 0;
+    std::string_view path = pattern;
+    (void)extract_method(path);
+    while (not path.empty()) {
+        auto segment = extract_segment(path);
+        if (segment == "{custom}") {
+            res[i++] = customs++;
+        } else if (parse_segment(segment).kind != SegmentKind::LITERAL) {
+            res[i++] = RouteMatch::NONE;
+        }
+    }
+    return res;
+}
+
+} // namespace detail
+
+// Converts the captures of a RouteMatch of @p pattern to the handler parameters. {u64} captures
+// are converted to integers, {string} ones to StringView and {custom} ones using the consecutive
+// @p CustomParsers, each taking StringView and returning an optional-like value.
+template <const char* pattern, auto... CustomParsers>
+class RouteCaptures {
+    static constexpr auto parser_idxs = detail::custom_parser_indexes<pattern>();
+
+public:
+    // Returns std::nullopt if any of the custom parsers fails or a {u64} capture does not fit in
+    // its parameter, so that the route is treated as not matching
+    template <class... Params, class Func>
+    static auto call(const RouteMatch& match, Func&& func)
+        -> std::optional<std::invoke_result_t<Func&&, Params...>> {
+        static_assert(
+            parser_idxs.size() == sizeof...(Params), "Handler does not match the route pattern"
+        );
+        return call_impl<Params...>(
+            match, std::forward<Func>(func), std::index_sequence_for<Params...>{}
+        );
+    }
+
+private:
+    template <class... Params, class Func, size_t... I>
+    static auto call_impl(const RouteMatch& match, Func&& func, std::index_sequence<I...> /**/)
+        -> std::optional<std::invoke_result_t<Func&&, Params...>> {
+        std::tuple<std::optional<std::decay_t<Params>>...> args{
+            convert<std::decay_t<Params>, I>(match)...
+        };
+        if (not(std::get<I>(args).has_value() and ...)) {
+            return std::nullopt;
+        }
+        return std::forward<Func>(func)(std::move(*std::get<I>(args))...);
+    }
+
+    template <class Param, size_t I>
+    static std::optional<Param> convert(const RouteMatch& match) {
+        StringView str{match.captures[I].str.data(), match.captures[I].str.size()};
+        if constexpr (parser_idxs[I] != RouteMatch::NONE) {
+            auto opt = std::get<parser_idxs[I]>(std::tuple{CustomParsers...})(str);
+            if (not opt) {
+                return std::nullopt;
+            }
+            return Param(std::move(*opt));
+        } else if constexpr (std::is_integral_v<Param>) {
+            auto num = match.captures[I].u64;
+            if (num > static_cast<uint64_t>(std::numeric_limits<Param>::max())) {
+                return std::nullopt;
+            }
+            return static_cast<Param>(num);
+        } else {
+            return Param(str);
+        }
+    }
+};
+
+} // namespace web_server::http
@@ -1,9 +1,27 @@
 #include "../../job_server/logs.hh"
 #include "../../web_server/logs.hh"
 #include "../../web_server/old/sim.hh"
+#include "../../web_server/old/status_events_listener.hh"
+#include "../../web_server/routes.hh"
+#include "../../web_server/submissions_display_cache.hh"
 
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <poll.h>
+#include <sim/random.hh>
+#include <simlib/call_in_destructor.hh>
 #include <simlib/file_contents.hh>
 #include <simlib/file_descriptor.hh>
+#include <simlib/sha.hh>
+#include <string>
+#include <string_view>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <utility>
+#include <variant>
+#include <vector>
+#include <zlib.h>
 
 using sim::users::User;
 
@@ -13,8 +31,9 @@ void Sim::api_handle() {
     STACK_UNWINDING_MARK;
 
     // Allow download queries to pass without POST
+    auto route = routes::old_route(route_match);
     StringView next_arg = url_args.extract_next_arg();
-    if (next_arg == "download") {
+    if (route == routes::Old::API_DOWNLOAD) {
         next_arg = url_args.extract_next_arg();
         if (is_one_of(next_arg, "submission", "problem", "contest_file")) {
             auto id = url_args.extract_next_arg();
@@ -45,7 +64,9 @@ void Sim::api_handle() {
         // Update url_args to reflect the changed URL
         url_args = RequestUriParser(request.target);
         url_args.extract_next_arg(); // extract "/api"
-        next_arg = url_args.extract_next_arg();
+        url_args.extract_next_arg(); // extract the API subsystem
+        route_match = routes::match(request.method, request.target);
+        route = routes::old_route(route_match);
 
     } else if (request.method != http::Request::POST) {
         return api_error403("To access API you have to use POST");
@@ -53,54 +74,302 @@ void Sim::api_handle() {
         resp.headers["Content-type"] = "text/plain; charset=utf-8";
     }
 
-    if (next_arg == "contest") {
-        return api_contest();
+    using routes::Old;
+    switch (route) {
+    case Old::API_BATCH: return api_batch();
+    case Old::API_CONTEST_CREATE:
+    case Old::API_CONTEST_CLONE:
+    case Old::API_CONTEST_VIEW:
+    case Old::API_CONTEST_RANKING:
+    case Old::API_CONTEST_RANKING_ROWS:
+    case Old::API_CONTEST_EDIT:
+    case Old::API_CONTEST_DELETE:
+    case Old::API_CONTEST_CREATE_ROUND:
+    case Old::API_CONTEST_CLONE_ROUND:
+    case Old::API_CONTEST_ROUND_VIEW:
+    case Old::API_CONTEST_ROUND_RANKING:
+    case Old::API_CONTEST_ROUND_RANKING_ROWS:
+    case Old::API_CONTEST_ROUND_ATTACH_PROBLEM:
+    case Old::API_CONTEST_ROUND_EDIT:
+    case Old::API_CONTEST_ROUND_DELETE:
+    case Old::API_CONTEST_PROBLEM_VIEW:
+    case Old::API_CONTEST_PROBLEM_STATEMENT:
+    case Old::API_CONTEST_PROBLEM_RANKING:
+    case Old::API_CONTEST_PROBLEM_RANKING_ROWS:
+    case Old::API_CONTEST_PROBLEM_REJUDGE_ALL_SUBMISSIONS:
+    case Old::API_CONTEST_PROBLEM_EDIT:
+    case Old::API_CONTEST_PROBLEM_DELETE: return api_contest();
+    case Old::API_CONTEST_FILE_ADD:
+    case Old::API_CONTEST_FILE_DOWNLOAD:
+    case Old::API_CONTEST_FILE_EDIT:
+    case Old::API_CONTEST_FILE_DELETE: return api_contest_file();
+    case Old::API_CONTEST_FILES: return api_contest_files();
+    case Old::API_CONTEST_USER_ADD:
+    case Old::API_CONTEST_USER_CHANGE_MODE:
+    case Old::API_CONTEST_USER_EXPEL: return api_contest_user();
+    case Old::API_CONTEST_USERS: return api_contest_users();
+    case Old::API_CONTESTS: return api_contests();
+    case Old::API_JOB_CANCEL:
+    case Old::API_JOB_RESTART:
+    case Old::API_JOB_LOG:
+    case Old::API_JOB_WAIT_FOR_STATUS_CHANGE:
+    case Old::API_JOB_UPLOADED_PACKAGE:
+    case Old::API_JOB_UPLOADED_STATEMENT: return api_job();
+    case Old::API_JOBS: return api_jobs();
+    case Old::API_LOGS: return api_logs();
+    case Old::API_PROBLEM_ADD:
+    case Old::API_PROBLEM_STATEMENT:
+    case Old::API_PROBLEM_DOWNLOAD:
+    case Old::API_PROBLEM_REJUDGE_ALL_SUBMISSIONS:
+    case Old::API_PROBLEM_RESET_TIME_LIMITS:
+    case Old::API_PROBLEM_REUPLOAD:
+    case Old::API_PROBLEM_EDIT_TAGS_ADD:
+    case Old::API_PROBLEM_EDIT_TAGS_EDIT:
+    case Old::API_PROBLEM_EDIT_TAGS_DELETE:
+    case Old::API_PROBLEM_EDIT_PARALLEL_JUDGING:
+    case Old::API_PROBLEM_CHANGE_STATEMENT:
+    case Old::API_PROBLEM_DELETE:
+    case Old::API_PROBLEM_MERGE_INTO_ANOTHER:
+    case Old::API_PROBLEM_ATTACHING_CONTEST_PROBLEMS: return api_problem();
+    case Old::API_PROBLEMS: return api_problems();
+    case Old::API_SUBMISSION_ADD:
+    case Old::API_SUBMISSION_SOURCE:
+    case Old::API_SUBMISSION_DOWNLOAD:
+    case Old::API_SUBMISSION_WAIT_FOR_STATUS_CHANGE:
+    case Old::API_SUBMISSION_REJUDGE:
+    case Old::API_SUBMISSION_CHANGE_TYPE:
+    case Old::API_SUBMISSION_DELETE: return api_submission();
+    case Old::API_SUBMISSIONS: return api_submissions();
+    default: return api_error404();
     }
-    if (next_arg == "contest_file") {
-        return api_contest_file();
+}
+
+namespace {
+
+enum class BatchedApi { NONE, OLD, NEW };
+
+// Only the requests that do not modify anything may be batched. The old API (that uses POST) takes
+// precedence over the GET requests to the new API.
+BatchedApi batched_api_of(StringView target) noexcept {
+    using routes::Old;
+    auto target_sv = std::string_view{target.data(), target.size()};
+    switch (routes::old_route(routes::match(http::Request::POST, target_sv))) {
+    case Old::API_CONTESTS:
+    case Old::API_CONTEST_FILES:
+    case Old::API_CONTEST_USERS:
+    case Old::API_JOBS:
+    case Old::API_PROBLEMS:
+    case Old::API_SUBMISSIONS:
+    // Views of a contest, its round or its problem and their rankings
+    case Old::API_CONTEST_VIEW:
+    case Old::API_CONTEST_RANKING:
+    case Old::API_CONTEST_ROUND_VIEW:
+    case Old::API_CONTEST_ROUND_RANKING:
+    case Old::API_CONTEST_PROBLEM_VIEW:
+    case Old::API_CONTEST_PROBLEM_RANKING: return BatchedApi::OLD;
+    default: break;
     }
-    if (next_arg == "contest_files") {
-        return api_contest_files();
+    if (has_prefix(target, "/api/") and
+        routes::is_web_worker(routes::match(http::Request::GET, target_sv)))
+    {
+        return BatchedApi::NEW;
     }
-    if (next_arg == "contest_user") {
-        return api_contest_user();
+    return BatchedApi::NONE;
+}
+
+} // namespace
+
+void Sim::api_batch() {
+    STACK_UNWINDING_MARK;
+    constexpr size_t MAX_TARGETS = 16;
+
+    std::vector<std::pair<StringView, BatchedApi>> targets;
+    StringView targets_str = request.form_fields.get("targets").value_or("");
+    while (not targets_str.empty()) {
+        auto pos = std::min(targets_str.find('\n'), targets_str.size());
+        auto target = targets_str.substring(0, pos);
+        targets_str.remove_prefix(std::min(pos + 1, targets_str.size()));
+        if (target.empty()) {
+            continue;
+        }
+        auto api = batched_api_of(target);
+        if (api == BatchedApi::NONE) {
+            return api_error400(concat_tostr("Request cannot be batched: ", target));
+        }
+        targets.emplace_back(target, api);
     }
-    if (next_arg == "contest_users") {
-        return api_contest_users();
+    if (targets.empty() or targets.size() > MAX_TARGETS) {
+        return api_error400(
+            concat_tostr("Number of requests has to be in range [1, ", MAX_TARGETS, ']')
+        );
     }
-    if (next_arg == "contests") {
-        return api_contests();
+
+    std::string res = R"([{"columns":["status","body"]})";
+    {
+        // Every request is handled as if it was a separate one, but they share the transaction,
+        // so they see the same snapshot of the database
+        batch_display_cache_generation = submissions_display_cache.generation();
+        auto transaction = mysql.start_transaction();
+        in_batch = true;
+        auto batch_resp = std::move(resp);
+        auto batch_target = std::move(request.target);
+        CallInDtor batch_state_restorer([&] {
+            in_batch = false;
+            resp = std::move(batch_resp);
+            request.target = std::move(batch_target);
+            route_match = routes::match(request.method, request.target);
+        });
+
+        for (auto [target, api] : targets) {
+            resp = http::Response(http::Response::TEXT);
+            request.target = target.to_string();
+            if (api == BatchedApi::NEW) {
+                auto sub_request = request;
+                sub_request.method = http::Request::GET;
+                auto sub_res = web_worker->handle(std::move(sub_request), true);
+                if (auto* response = std::get_if<http::Response>(&sub_res)) {
+                    resp = std::move(*response);
+                } else {
+                    api_error404();
+                }
+            } else {
+                url_args = RequestUriParser{request.target};
+                url_args.extract_next_arg(); // extract "/api"
+                route_match = routes::match(request.method, request.target);
+                api_handle();
+            }
+
+            // Successful responses of the batchable requests are JSON
+            throw_assert(resp.content_type == http::Response::TEXT);
+            back_insert(res, ",[", json_stringify(resp.status_code), ',');
+            if (has_prefix(resp.status_code, "200") and resp.content.size > 0) {
+                back_insert(res, resp.content);
+            } else {
+                back_insert(res, json_stringify(resp.content));
+            }
+            back_insert(res, ']');
+        }
+        transaction.commit();
     }
-    if (next_arg == "job") {
-        return api_job();
+    back_insert(res, ']');
+    append(res);
+}
+
+namespace {
+
+constexpr size_t LOGS_FIRST_CHUNK_MAX_LEN = 16 << 10; // 16 KiB
+constexpr size_t LOGS_OTHER_CHUNK_MAX_LEN = 128 << 10; // 128 KiB
+
+off64_t file_size(int fd) {
+    off64_t fsize = lseek64(fd, 0, SEEK_END);
+    if (fsize == -1) {
+        THROW("lseek64()", errmsg());
     }
-    if (next_arg == "jobs") {
-        return api_jobs();
+    return fsize;
+}
+
+void pread_all_throw(int fd, char* buff, size_t len, off64_t offset) {
+    while (len > 0) {
+        auto rc = pread64(fd, buff, len, offset);
+        if (rc == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            THROW("pread64()", errmsg());
+        }
+        if (rc == 0) {
+            THROW("pread64(): unexpected end of file");
+        }
+
+        buff += rc;
+        len -= rc;
+        offset += rc;
     }
-    if (next_arg == "logs") {
-        return api_logs();
+}
+
+constexpr bool is_utf8_continuation_byte(char c) noexcept {
+    return (static_cast<unsigned char>(c) & 0xc0) == 0x80;
+}
+
+// Returns the length of the UTF-8 sequence at the end of @p data that is cut off
+size_t incomplete_utf8_suffix_len(StringView data) noexcept {
+    for (size_t len = 1; len <= std::min<size_t>(4, data.size()); ++len) {
+        auto c = static_cast<unsigned char>(data[data.size() - len]);
+        if (is_utf8_continuation_byte(static_cast<char>(c))) {
+            continue;
+        }
+
+        size_t seq_len = c < 0x80 ? 1 : c < 0xe0 ? 2 : c < 0xf0 ? 3 : 4;
+        return seq_len > len ? len : 0;
     }
-    if (next_arg == "problem") {
-        return api_problem();
+    return 0; // Invalid UTF-8, there is nothing to preserve
+}
+
+struct LogChunk {
+    off64_t beg;
+    off64_t end;
+    StringView data;
+};
+
+// Reads the bytes from the range [@p beg, @p end) of the log @p fd. The range is narrowed so that
+// no UTF-8 character is split between the chunks, so that each chunk may be decoded separately.
+LogChunk read_log_chunk(int fd, off64_t beg, off64_t end, std::string& buff) {
+    buff.resize(end - beg);
+    pread_all_throw(fd, buff.data(), buff.size(), beg);
+
+    StringView data = buff;
+    if (beg > 0) {
+        for (int i = 0; i < 3 and not data.empty() and is_utf8_continuation_byte(data[0]); ++i) {
+            data.remove_prefix(1);
+        }
     }
-    if (next_arg == "problems") {
-        return api_problems();
+    data.remove_suffix(incomplete_utf8_suffix_len(data));
+
+    beg += data.data() - buff.data();
+    return {beg, beg + static_cast<off64_t>(data.size()), data};
+}
+
+// Compresses the response content if the client accepts it; logs compress very well
+void gzip_if_accepted(const http::Request& request, http::Response& resp) {
+    STACK_UNWINDING_MARK;
+    constexpr size_t MIN_LEN_WORTH_COMPRESSING = 1 << 10;
+
+    resp.headers["Vary"] = "Accept-Encoding";
+    auto accept_encoding = request.headers.get("accept-encoding");
+    if (resp.content.size < MIN_LEN_WORTH_COMPRESSING or not accept_encoding or
+        accept_encoding->find("gzip") == StringView::npos)
+    {
+        return;
     }
-    if (next_arg == "submission") {
-        return api_submission();
+
+    z_stream zs = {};
+    constexpr int GZIP_MAX_WINDOW_BITS = 15 + 16; // +16 selects the gzip wrapper
+    if (deflateInit2(&zs, Z_BEST_SPEED, Z_DEFLATED, GZIP_MAX_WINDOW_BITS, 8, Z_DEFAULT_STRATEGY) !=
+        Z_OK)
+    {
+        THROW("deflateInit2() failed");
     }
-    if (next_arg == "submissions") {
-        return api_submissions();
+    CallInDtor zs_ender([&] { (void)deflateEnd(&zs); });
+
+    std::string compressed(deflateBound(&zs, resp.content.size), '\0');
+    zs.next_in = reinterpret_cast<Bytef*>(resp.content.data());
+    zs.avail_in = resp.content.size;
+    zs.next_out = reinterpret_cast<Bytef*>(compressed.data());
+    zs.avail_out = compressed.size();
+    if (deflate(&zs, Z_FINISH) != Z_STREAM_END) {
+        THROW("deflate() failed");
     }
-    return api_error404();
+
+    compressed.resize(zs.total_out);
+    resp.content = compressed;
+    resp.headers["Content-Encoding"] = "gzip";
 }
 
+} // namespace
+
 void Sim::api_logs() {
     STACK_UNWINDING_MARK;
 
-    constexpr unsigned LOGS_FIRST_CHUNK_MAX_LEN = 16 << 10; // 16 KiB
-    constexpr unsigned LOGS_OTHER_CHUNK_MAX_LEN = 128 << 10; // 128 KiB
-
     if (not session.has_value() || session->user_type != User::Type::ADMIN) {
         return api_error403();
     }
@@ -119,9 +388,24 @@ void Sim::api_logs() {
         return api_error404();
     }
 
+    StringView next_arg = url_args.extract_next_arg();
+    if (next_arg == "tail") {
+        api_logs_tail(filename);
+    } else if (next_arg.empty()) {
+        api_logs_before(filename);
+    } else {
+        return api_error404();
+    }
+
+    gzip_if_accepted(request, resp);
+}
+
+void Sim::api_logs_before(CStringView filename) {
+    STACK_UNWINDING_MARK;
+
     off64_t end_offset = 0;
     StringView query = url_args.extract_query();
-    uint chunk_max_len = LOGS_FIRST_CHUNK_MAX_LEN;
+    size_t chunk_max_len = LOGS_FIRST_CHUNK_MAX_LEN;
     if (!query.empty()) {
         auto opt = str2num<off64_t>(query);
         if (not opt or *opt < 0) {
@@ -133,37 +417,134 @@ void Sim::api_logs() {
     }
 
     FileDescriptor fd(filename, O_RDONLY | O_CLOEXEC);
-    off64_t fsize = lseek64(fd, 0, SEEK_END);
-    throw_assert(fsize >= 0);
+    if (fd == -1) {
+        THROW("open()", errmsg());
+    }
+    off64_t fsize = file_size(fd);
     if (query.empty() or end_offset > fsize) {
         end_offset = fsize;
     }
 
-    size_t len = 0;
-    if (end_offset < chunk_max_len) {
-        len = end_offset;
-        if (lseek64(fd, 0, SEEK_SET) == -1) {
-            THROW("lseek64()", errmsg());
+    std::string buff;
+    auto chunk = read_log_chunk(
+        fd, std::max<off64_t>(0, end_offset - static_cast<off64_t>(chunk_max_len)), end_offset, buff
+    );
+    append(chunk.beg, '\n', chunk.end, '\n', chunk.data);
+}
+
+void Sim::api_logs_tail(CStringView filename) {
+    STACK_UNWINDING_MARK;
+    // Below the usual timeouts of the proxies
+    constexpr auto LONG_POLLING_TIMEOUT = std::chrono::seconds(25);
+
+    auto offset_opt = str2num<off64_t>(url_args.extract_next_arg());
+    if (not offset_opt or *offset_opt < 0) {
+        return api_error400();
+    }
+    off64_t offset = *offset_opt;
+
+    FileDescriptor fd(filename, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        THROW("open()", errmsg());
+    }
+
+    bool long_polled = false;
+    off64_t fsize = file_size(fd);
+    // Wait for the new data only if it won't take the last workers
+    if (fsize == offset and status_events_listener.try_reserve_waiter()) {
+        CallInDtor waiter_releaser([] { status_events_listener.release_waiter(); });
+        long_polled = true;
+
+        FileDescriptor ifd(inotify_init1(IN_CLOEXEC));
+        if (ifd == -1) {
+            THROW("inotify_init1()", errmsg());
+        }
+        if (inotify_add_watch(ifd, filename.c_str(), IN_MODIFY) == -1) {
+            THROW("inotify_add_watch()", errmsg());
         }
 
-    } else {
-        len = chunk_max_len;
-        if (lseek64(fd, end_offset - chunk_max_len, SEEK_SET) == -1) {
-            THROW("lseek64()", errmsg());
+        auto deadline = std::chrono::steady_clock::now() + LONG_POLLING_TIMEOUT;
+        // The watch has been added before the check, so no change is missed
+        while ((fsize = file_size(fd)) == offset) {
+            auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()
+            );
+            if (timeout.count() <= 0) {
+                break;
+            }
+
+            pollfd pfd = {ifd, POLLIN, 0};
+            int rc = poll(&pfd, 1, static_cast<int>(timeout.count()));
+            if (rc == -1 and errno != EINTR) {
+                THROW("poll()", errmsg());
+            }
+            if (rc > 0) {
+                // Drain the events, they are only wake-ups
+                std::array<char, 4096> events; // NOLINT(cppcoreguidelines-pro-type-member-init)
+                (void)read(ifd, events.data(), events.size());
+            }
         }
     }
 
-    // Read the data
-    InplaceBuff<meta::max(LOGS_FIRST_CHUNK_MAX_LEN, LOGS_OTHER_CHUNK_MAX_LEN)> buff(len);
-    auto ret = read_all(fd, buff.data(), len);
-    // TODO: read_all() and write_all() - support offset argument -
-    // p(write|read)
-    if (ret != len) {
-        THROW("read()", errmsg());
+    if (fsize < offset) {
+        offset = 0; // The log has been truncated, start over
+    }
+
+    std::string buff;
+    auto chunk = read_log_chunk(
+        fd, offset, std::min(fsize, offset + static_cast<off64_t>(LOGS_OTHER_CHUNK_MAX_LEN)), buff
+    );
+    append(chunk.beg, '\n', chunk.end, '\n', (long_polled ? '1' : '0'), '\n', chunk.data);
+}
+
+namespace {
+
+// The token does not reveal the status, because the client may be not allowed to see all of it
+// (e.g. the full status of a contest submission before the full results)
+std::string status_token(sim::status_events::Kind kind, uint64_t id, uint64_t status) {
+    // Server restart invalidates the tokens, but it only causes a spurious change
+    static const auto secret = sim::generate_random_token(32);
+    auto hash = sha3_512(concat(secret, static_cast<char>(kind), id, ':', status));
+    return intentional_unsafe_string_view(hash).substring(0, 32).to_string();
+}
+
+} // namespace
+
+void Sim::api_wait_for_status_change(
+    sim::status_events::Kind kind, uint64_t id, const std::function<uint64_t()>& read_status
+) {
+    STACK_UNWINDING_MARK;
+    // Below the usual timeouts of the proxies
+    constexpr auto LONG_POLLING_TIMEOUT = std::chrono::seconds(25);
+
+    // Without a token the current one is returned immediately
+    StringView known_token = url_args.extract_next_arg();
+    // Subscribe before reading the status, so that no change is missed
+    auto subscription = [&]() -> std::optional<StatusEventsListener::Subscription> {
+        if (known_token.empty()) {
+            return std::nullopt;
+        }
+        return status_events_listener.subscribe(kind, id);
+    }();
+
+    auto token = status_token(kind, id, read_status());
+    if (subscription) {
+        auto deadline = std::chrono::steady_clock::now() + LONG_POLLING_TIMEOUT;
+        while (token == known_token and subscription->wait_until(deadline)) {
+            token = status_token(kind, id, read_status());
+        }
     }
 
-    append(end_offset - len, '\n'); // New offset
-    append(to_hex(buff)); // Data
+    // If long polling was not possible, the client should delay the next request
+    append(
+        "[{\"fields\":[\"changed\",\"token\",\"long_polled\"]},",
+        (not known_token.empty() and token != known_token ? "true" : "false"),
+        ",\"",
+        token,
+        "\",",
+        (subscription ? "true" : "false"),
+        ']'
+    );
 }
 
 } // namespace web_server::old
@@ -1,3 +1,4 @@
+#include "../routes.hh"
 #include "sim.hh"
 
 #include <sim/contest_files/contest_file.hh>
@@ -21,7 +22,7 @@ void Sim::api_contest_files() {
 
     // We may read data several times (permission checking), so transaction is
     // used to ensure data consistency
-    auto transaction = mysql.start_transaction();
+    auto transaction = start_transaction();
 
     bool allow_access = false; // Either contest or specific id condition must occur
 
@@ -115,11 +116,7 @@ void Sim::api_contest_files() {
                 contest_id_condition_occurred = true;
                 query.append(" AND cf.contest_id=", arg_id);
 
-                auto cperms = sim::contests::get_permissions(
-                    mysql,
-                    arg_id,
-                    (session.has_value() ? std::optional{session->user_id} : std::nullopt)
-                );
+                auto cperms = contests_get_permissions(arg_id);
                 if (not cperms) {
                     return set_empty_response(); // Do allow to query for
                                                  // contest existence (not
@@ -209,13 +206,12 @@ void Sim::api_contest_files() {
 void Sim::api_contest_file() {
     STACK_UNWINDING_MARK;
 
-    StringView contest_file_id = url_args.extract_next_arg();
-    if (contest_file_id == "add") {
+    auto route = routes::old_route(route_match);
+    if (route == routes::Old::API_CONTEST_FILE_ADD) {
         return api_contest_file_add();
     }
-    if (contest_file_id.empty()) {
-        return api_error404();
-    }
+
+    StringView contest_file_id = route_capture(0);
 
     sim::contest_files::Permissions perms;
     {
@@ -231,18 +227,13 @@ void Sim::api_contest_file() {
         perms = perms_opt.value().first;
     }
 
-    StringView next_arg = url_args.extract_next_arg();
-    if (next_arg == "download") {
+    switch (route) {
+    case routes::Old::API_CONTEST_FILE_DOWNLOAD:
         return api_contest_file_download(contest_file_id, perms);
-    }
-    if (next_arg == "edit") {
-        return api_contest_file_edit(contest_file_id, perms);
-    }
-    if (next_arg == "delete") {
+    case routes::Old::API_CONTEST_FILE_EDIT: return api_contest_file_edit(contest_file_id, perms);
+    case routes::Old::API_CONTEST_FILE_DELETE:
         return api_contest_file_delete(contest_file_id, perms);
-    }
-    if (not next_arg.empty()) {
-        return api_error400();
+    default: return api_error404();
     }
 }
 
@@ -270,12 +261,7 @@ void Sim::api_contest_file_download(
 }
 
 void Sim::api_contest_file_add() {
-    StringView contest_id = url_args.extract_next_arg();
-    if (contest_id.empty() or contest_id[0] != 'c' or
-        not is_digit(contest_id = contest_id.substr(1)))
-    {
-        return api_error400();
-    }
+    StringView contest_id = route_capture(0);
 
     auto cperms = sim::contests::get_permissions(
         mysql, contest_id, (session.has_value() ? std::optional{session->user_id} : std::nullopt)
@@ -332,7 +318,7 @@ void Sim::api_contest_file_add() {
         return api_error400(notifications);
     }
 
-    auto transaction = mysql.start_transaction();
+    auto transaction = start_transaction();
 
     mysql.update("INSERT INTO internal_files VALUES()");
     auto internal_file_id = mysql.insert_id();
@@ -430,7 +416,7 @@ void Sim::api_contest_file_edit(StringView contest_file_id, sim::contest_files::
         return api_error400(notifications);
     }
 
-    auto transaction = mysql.start_transaction();
+    auto transaction = start_transaction();
 
     uint64_t internal_file_id = 0;
     CallInDtor internal_file_remover([internal_file_id] {
@@ -450,8 +436,8 @@ void Sim::api_contest_file_edit(StringView contest_file_id, sim::contest_files::
 
         mysql
             .prepare("INSERT INTO jobs(file_id, creator, type, priority,"
-                     " status, added, aux_id, info, data) "
-                     "SELECT file_id, NULL, ?, ?, ?, ?, NULL, '', '' "
+                     " status, added, aux_id, info) "
+                     "SELECT file_id, NULL, ?, ?, ?, ?, NULL, '' "
                      "FROM contest_files WHERE id=?")
             .bind_and_execute(
                 EnumVal(Job::Type::DELETE_FILE),
@@ -493,12 +479,12 @@ void Sim::api_contest_file_delete(
         return api_error403();
     }
 
-    auto transaction = mysql.start_transaction();
+    auto transaction = start_transaction();
 
     mysql
         .prepare("INSERT INTO jobs(file_id, creator, type, priority, status,"
-                 " added, aux_id, info, data) "
-                 "SELECT file_id, NULL, ?, ?, ?, ?, NULL, '', '' "
+                 " added, aux_id, info) "
+                 "SELECT file_id, NULL, ?, ?, ?, ?, NULL, '' "
                  "FROM contest_files WHERE id=?")
         .bind_and_execute(
             EnumVal(Job::Type::DELETE_FILE),
@@ -1,3 +1,5 @@
+#include "../contest_permissions_cache.hh"
+#include "../routes.hh"
 #include "sim.hh"
 
 #include <sim/contest_users/contest_user.hh>
@@ -11,6 +13,14 @@ using std::pair;
 
 namespace web_server::old {
 
+static void invalidate_contest_permissions(StringView contest_id, StringView user_id) {
+    auto cid = str2num<ContestPermissionsCache::ContestId>(contest_id);
+    auto uid = str2num<ContestPermissionsCache::UserId>(user_id);
+    if (cid and uid) {
+        contest_permissions_cache.invalidate(*uid, *cid);
+    }
+}
+
 static Sim::ContestUserPermissions get_overall_perm(std::optional<ContestUser::Mode> viewer_mode
 ) noexcept {
     using PERM = Sim::ContestUserPermissions;
@@ -149,7 +159,7 @@ void Sim::api_contest_users() {
 
     // We may read data several times (permission checking), so transaction is
     // used to ensure data consistency
-    auto transaction = mysql.start_transaction();
+    auto transaction = start_transaction();
 
     InplaceBuff<512> qfields;
     InplaceBuff<512> qwhere;
@@ -330,35 +340,15 @@ void Sim::api_contest_user() {
         return api_error403();
     }
 
-    StringView contest_id = url_args.extract_next_arg();
-    if (contest_id.empty()) {
-        return api_error400("Missing contest id");
-    }
-    if (contest_id[0] != 'c' or not is_digit(contest_id = contest_id.substr(1))) {
-        return api_error400("Invalid contest id");
-    }
-
-    StringView next_arg = url_args.extract_next_arg();
-    if (next_arg == "add") {
-        return api_contest_user_add(contest_id);
-    }
-
-    StringView user_id = next_arg;
-    if (user_id.empty()) {
-        return api_error400("Missing user id");
-    }
-    if (user_id[0] != 'u' or not is_digit(user_id = user_id.substr(1))) {
-        return api_error400("Invalid user id");
-    }
-
-    next_arg = url_args.extract_next_arg();
-    if (next_arg == "change_mode") {
-        return api_contest_user_change_mode(contest_id, user_id);
-    }
-    if (next_arg == "expel") {
-        return api_contest_user_expel(contest_id, user_id);
+    StringView contest_id = route_capture(0);
+    switch (routes::old_route(route_match)) {
+    case routes::Old::API_CONTEST_USER_ADD: return api_contest_user_add(contest_id);
+    case routes::Old::API_CONTEST_USER_CHANGE_MODE:
+        return api_contest_user_change_mode(contest_id, route_capture(1));
+    case routes::Old::API_CONTEST_USER_EXPEL:
+        return api_contest_user_expel(contest_id, route_capture(1));
+    default: return api_error404();
     }
-    return api_error404();
 }
 
 void Sim::api_contest_user_add(StringView contest_id) {
@@ -413,6 +403,7 @@ void Sim::api_contest_user_add(StringView contest_id) {
     if (stmt.affected_rows() == 0) {
         return api_error400("Specified user is already in the contest");
     }
+    invalidate_contest_permissions(contest_id, user_id);
 }
 
 void Sim::api_contest_user_change_mode(StringView contest_id, StringView user_id) {
@@ -448,6 +439,7 @@ void Sim::api_contest_user_change_mode(StringView contest_id, StringView user_id
 
     mysql.prepare("UPDATE contest_users SET mode=? WHERE contest_id=? AND user_id=?")
         .bind_and_execute(new_mode, contest_id, user_id);
+    invalidate_contest_permissions(contest_id, user_id);
 }
 
 void Sim::api_contest_user_expel(StringView contest_id, StringView user_id) {
@@ -461,6 +453,7 @@ void Sim::api_contest_user_expel(StringView contest_id, StringView user_id) {
 
     mysql.prepare("DELETE FROM contest_users WHERE contest_id=? AND user_id=?")
         .bind_and_execute(contest_id, user_id);
+    invalidate_contest_permissions(contest_id, user_id);
 }
 
 } // namespace web_server::old
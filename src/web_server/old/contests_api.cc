@@ -1,11 +1,19 @@
 #include "../capabilities/contests.hh"
+#include "../contest_permissions_cache.hh"
 #include "../http/form_validation.hh"
+#include "../routes.hh"
+#include "../submissions_display_cache.hh"
 #include "sim.hh"
 
+#include <algorithm>
 #include <cstdint>
+#include <chrono>
 #include <map>
+#include <mutex>
+#include <set>
 #include <sim/contest_problems/contest_problem.hh>
 #include <sim/contest_problems/iterate.hh>
+#include <sim/contest_ranking_snapshots/contest_ranking_snapshot.hh>
 #include <sim/contest_rounds/contest_round.hh>
 #include <sim/contest_rounds/iterate.hh>
 #include <sim/contest_users/contest_user.hh>
@@ -16,9 +24,11 @@
 #include <sim/is_username.hh>
 #include <sim/jobs/utils.hh>
 #include <sim/submissions/submission.hh>
+#include <simlib/call_in_destructor.hh>
 #include <simlib/string_view.hh>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 using sim::inf_timestamp_to_InfDatetime;
 using sim::InfDatetime;
@@ -257,12 +267,53 @@ public:
 
 } // namespace
 
+std::optional<sim::contests::Permissions> Sim::contests_get_permissions(StringView contest_id) {
+    STACK_UNWINDING_MARK;
+
+    auto cache_contest_id = str2num<ContestPermissionsCache::ContestId>(contest_id);
+    ContestPermissionsCache::UserId cache_user_id = session.has_value() ? session->user_id : 0;
+    if (cache_contest_id) {
+        if (auto perms = contest_permissions_cache.find(cache_user_id, *cache_contest_id)) {
+            return perms;
+        }
+    }
+
+    auto generation = contest_permissions_cache.generation();
+    auto perms = sim::contests::get_permissions(
+        mysql, contest_id, (session.has_value() ? optional{session->user_id} : std::nullopt)
+    );
+    if (perms and cache_contest_id) {
+        contest_permissions_cache.insert(cache_user_id, *cache_contest_id, *perms, generation);
+    }
+    return perms;
+}
+
+std::optional<std::pair<Contest, sim::contests::Permissions>>
+Sim::contests_get(sim::contests::GetIdKind id_kind, StringView id, CStringView curr_date) {
+    STACK_UNWINDING_MARK;
+
+    auto generation = contest_permissions_cache.generation();
+    auto res = sim::contests::get(
+        mysql,
+        id_kind,
+        id,
+        (session.has_value() ? optional{session->user_id} : std::nullopt),
+        curr_date
+    );
+    if (res) {
+        contest_permissions_cache.insert(
+            session.has_value() ? session->user_id : 0, res->first.id, res->second, generation
+        );
+    }
+    return res;
+}
+
 void Sim::api_contests() {
     STACK_UNWINDING_MARK;
 
     // We may read data several times (permission checking), so transaction is
     // used to ensure data consistency
-    auto transaction = mysql.start_transaction();
+    auto transaction = start_transaction();
 
     InplaceBuff<512> qfields;
     InplaceBuff<512> qwhere;
@@ -387,44 +438,46 @@ void Sim::api_contests() {
 
 void Sim::api_contest() {
     STACK_UNWINDING_MARK;
+    using routes::Old;
 
     auto caps_contests = capabilities::contests_for(session);
-    StringView next_arg = url_args.extract_next_arg();
-    if (next_arg == "create") {
-        return api_contest_create(caps_contests);
-    }
-    if (next_arg == "clone") {
-        return api_contest_clone(caps_contests);
-    }
-    if (next_arg.empty()) {
-        return api_error400();
-    }
-    if (next_arg[0] == 'r' and is_digit(next_arg.substr(1))) {
-        // Select by contest round id
-        return api_contest_round(next_arg.substr(1));
-    }
-    if (next_arg[0] == 'p' and is_digit(next_arg.substr(1))) {
-        // Select by contest problem id
-        return api_contest_problem(next_arg.substr(1));
-    }
-    if (not(next_arg[0] == 'c' and is_digit(next_arg.substr(1)))) {
-        return api_error404();
-    }
-
-    StringView contest_id = next_arg.substr(1);
+    auto route = routes::old_route(route_match);
+    switch (route) {
+    case Old::API_CONTEST_CREATE: return api_contest_create(caps_contests);
+    case Old::API_CONTEST_CLONE: return api_contest_clone(caps_contests);
+    case Old::API_CONTEST_VIEW:
+    case Old::API_CONTEST_RANKING:
+    case Old::API_CONTEST_RANKING_ROWS:
+    case Old::API_CONTEST_EDIT:
+    case Old::API_CONTEST_DELETE:
+    case Old::API_CONTEST_CREATE_ROUND:
+    case Old::API_CONTEST_CLONE_ROUND: break;
+    // Select by contest round id
+    case Old::API_CONTEST_ROUND_VIEW:
+    case Old::API_CONTEST_ROUND_RANKING:
+    case Old::API_CONTEST_ROUND_RANKING_ROWS:
+    case Old::API_CONTEST_ROUND_ATTACH_PROBLEM:
+    case Old::API_CONTEST_ROUND_EDIT:
+    case Old::API_CONTEST_ROUND_DELETE: return api_contest_round(route_capture(0));
+    // Select by contest problem id
+    case Old::API_CONTEST_PROBLEM_VIEW:
+    case Old::API_CONTEST_PROBLEM_STATEMENT:
+    case Old::API_CONTEST_PROBLEM_RANKING:
+    case Old::API_CONTEST_PROBLEM_RANKING_ROWS:
+    case Old::API_CONTEST_PROBLEM_REJUDGE_ALL_SUBMISSIONS:
+    case Old::API_CONTEST_PROBLEM_EDIT:
+    case Old::API_CONTEST_PROBLEM_DELETE: return api_contest_problem(route_capture(0));
+    default: return api_error404();
+    }
+
+    StringView contest_id = route_capture(0);
 
     // We read data in several queries - transaction will make the data
     // consistent
-    auto transaction = mysql.start_transaction();
+    auto transaction = start_transaction();
     auto curr_date = mysql_date();
 
-    auto contest_opt = sim::contests::get(
-        mysql,
-        sim::contests::GetIdKind::CONTEST,
-        contest_id,
-        (session.has_value() ? optional{session->user_id} : std::nullopt),
-        curr_date
-    );
+    auto contest_opt = contests_get(sim::contests::GetIdKind::CONTEST, contest_id, curr_date);
     if (not contest_opt) {
         return api_error404();
     }
@@ -434,30 +487,23 @@ void Sim::api_contest() {
         return api_error403(); // Could not participate
     }
 
-    next_arg = url_args.extract_next_arg();
-    if (next_arg == "ranking") {
-        transaction.rollback(); // We only read data...
-        return api_contest_ranking(contest_perms, "contest_id", contest_id);
-    }
-    if (next_arg == "edit") {
-        transaction.rollback(); // We only read data...
-        return api_contest_edit(contest_id, contest_perms, contest.is_public);
-    }
-    if (next_arg == "delete") {
-        transaction.rollback(); // We only read data...
-        return api_contest_delete(contest_id, contest_perms);
-    }
-    if (next_arg == "create_round") {
-        transaction.rollback(); // We only read data...
-        return api_contest_round_create(contest_id, contest_perms);
-    }
-    if (next_arg == "clone_round") {
+    if (route != Old::API_CONTEST_VIEW) {
         transaction.rollback(); // We only read data...
-        return api_contest_round_clone(contest_id, contest_perms);
-    }
-    if (not next_arg.empty()) {
-        transaction.rollback(); // We only read data...
-        return api_error400();
+        switch (route) {
+        case Old::API_CONTEST_RANKING:
+            return api_contest_ranking(contest_perms, "contest_id", contest_id);
+        case Old::API_CONTEST_RANKING_ROWS:
+            parse_route_rest();
+            return api_contest_ranking_rows(contest_perms, "contest_id", contest_id);
+        case Old::API_CONTEST_EDIT:
+            return api_contest_edit(contest_id, contest_perms, contest.is_public);
+        case Old::API_CONTEST_DELETE: return api_contest_delete(contest_id, contest_perms);
+        case Old::API_CONTEST_CREATE_ROUND:
+            return api_contest_round_create(contest_id, contest_perms);
+        case Old::API_CONTEST_CLONE_ROUND:
+            return api_contest_round_clone(contest_id, contest_perms);
+        default: return api_error404();
+        }
     }
 
     ContestInfoResponseBuilder resp_builder(resp.content, caps_contests, contest_perms, curr_date);
@@ -497,15 +543,11 @@ void Sim::api_contest_round(StringView contest_round_id) {
 
     // We read data in several queries - transaction will make the data
     // consistent
-    auto transaction = mysql.start_transaction();
+    auto transaction = start_transaction();
     auto curr_date = mysql_date();
 
-    auto contest_opt = sim::contests::get(
-        mysql,
-        sim::contests::GetIdKind::CONTEST_ROUND,
-        contest_round_id,
-        (session.has_value() ? optional{session->user_id} : std::nullopt),
-        curr_date
+    auto contest_opt = contests_get(
+        sim::contests::GetIdKind::CONTEST_ROUND, contest_round_id, curr_date
     );
     if (not contest_opt) {
         return api_error404();
@@ -532,26 +574,23 @@ void Sim::api_contest_round(StringView contest_round_id) {
 
     auto& contest_round = contest_round_opt.value();
 
-    StringView next_arg = url_args.extract_next_arg();
-    if (next_arg == "ranking") {
+    auto route = routes::old_route(route_match);
+    if (route != routes::Old::API_CONTEST_ROUND_VIEW) {
         transaction.rollback(); // We only read data...
-        return api_contest_ranking(contest_perms, "contest_round_id", contest_round_id);
-    }
-    if (next_arg == "attach_problem") {
-        transaction.rollback(); // We only read data...
-        return api_contest_problem_add(contest.id, contest_round.id, contest_perms);
-    }
-    if (next_arg == "edit") {
-        transaction.rollback(); // We only read data...
-        return api_contest_round_edit(contest_round.id, contest_perms);
-    }
-    if (next_arg == "delete") {
-        transaction.rollback(); // We only read data...
-        return api_contest_round_delete(contest_round.id, contest_perms);
-    }
-    if (not next_arg.empty()) {
-        transaction.rollback(); // We only read data...
-        return api_error404();
+        switch (route) {
+        case routes::Old::API_CONTEST_ROUND_RANKING:
+            return api_contest_ranking(contest_perms, "contest_round_id", contest_round_id);
+        case routes::Old::API_CONTEST_ROUND_RANKING_ROWS:
+            parse_route_rest();
+            return api_contest_ranking_rows(contest_perms, "contest_round_id", contest_round_id);
+        case routes::Old::API_CONTEST_ROUND_ATTACH_PROBLEM:
+            return api_contest_problem_add(contest.id, contest_round.id, contest_perms);
+        case routes::Old::API_CONTEST_ROUND_EDIT:
+            return api_contest_round_edit(contest_round.id, contest_perms);
+        case routes::Old::API_CONTEST_ROUND_DELETE:
+            return api_contest_round_delete(contest_round.id, contest_perms);
+        default: return api_error404();
+        }
     }
 
     auto caps_contests = capabilities::contests_for(session);
@@ -584,15 +623,11 @@ void Sim::api_contest_problem(StringView contest_problem_id) {
 
     // We read data in several queries - transaction will make the data
     // consistent
-    auto transaction = mysql.start_transaction();
+    auto transaction = start_transaction();
     auto curr_date = mysql_date();
 
-    auto contest_opt = sim::contests::get(
-        mysql,
-        sim::contests::GetIdKind::CONTEST_PROBLEM,
-        contest_problem_id,
-        (session.has_value() ? optional{session->user_id} : std::nullopt),
-        curr_date
+    auto contest_opt = contests_get(
+        sim::contests::GetIdKind::CONTEST_PROBLEM, contest_problem_id, curr_date
     );
     if (not contest_opt) {
         return api_error404();
@@ -627,32 +662,29 @@ void Sim::api_contest_problem(StringView contest_problem_id) {
 
     auto problem_id_str = to_string(contest_problem.problem_id);
 
-    StringView next_arg = url_args.extract_next_arg();
-    if (next_arg == "statement") {
-        transaction.rollback(); // We only read data...
-        return api_contest_problem_statement(problem_id_str);
-    }
-    if (next_arg == "ranking") {
-        transaction.rollback(); // We only read data...
-        return api_contest_ranking(contest_perms, "contest_problem_id", contest_problem_id);
-    }
-    if (next_arg == "rejudge_all_submissions") {
+    auto route = routes::old_route(route_match);
+    if (route != routes::Old::API_CONTEST_PROBLEM_VIEW) {
         transaction.rollback(); // We only read data...
-        return api_contest_problem_rejudge_all_submissions(
-            contest_problem_id, contest_perms, problem_id_str
-        );
-    }
-    if (next_arg == "edit") {
-        transaction.rollback(); // We only read data...
-        return api_contest_problem_edit(contest_problem_id, contest_perms);
-    }
-    if (next_arg == "delete") {
-        transaction.rollback(); // We only read data...
-        return api_contest_problem_delete(contest_problem_id, contest_perms);
-    }
-    if (not next_arg.empty()) {
-        transaction.rollback(); // We only read data...
-        return api_error404();
+        switch (route) {
+        case routes::Old::API_CONTEST_PROBLEM_STATEMENT:
+            return api_contest_problem_statement(problem_id_str);
+        case routes::Old::API_CONTEST_PROBLEM_RANKING:
+            return api_contest_ranking(contest_perms, "contest_problem_id", contest_problem_id);
+        case routes::Old::API_CONTEST_PROBLEM_RANKING_ROWS:
+            parse_route_rest();
+            return api_contest_ranking_rows(
+                contest_perms, "contest_problem_id", contest_problem_id
+            );
+        case routes::Old::API_CONTEST_PROBLEM_REJUDGE_ALL_SUBMISSIONS:
+            return api_contest_problem_rejudge_all_submissions(
+                contest_problem_id, contest_perms, problem_id_str
+            );
+        case routes::Old::API_CONTEST_PROBLEM_EDIT:
+            return api_contest_problem_edit(contest_problem_id, contest_perms);
+        case routes::Old::API_CONTEST_PROBLEM_DELETE:
+            return api_contest_problem_delete(contest_problem_id, contest_perms);
+        default: return api_error404();
+        }
     }
 
     auto caps_contests = capabilities::contests_for(session);
@@ -697,7 +729,7 @@ void Sim::api_contest_create(capabilities::Contests caps_contests) {
         return api_error400(notifications);
     }
 
-    auto transaction = mysql.start_transaction();
+    auto transaction = start_transaction();
 
     // Add contest
     auto stmt = mysql.prepare("INSERT contests(name, is_public) VALUES(?, ?)");
@@ -741,15 +773,11 @@ void Sim::api_contest_clone(capabilities::Contests caps_contests) {
         return api_error400(notifications);
     }
 
-    auto transaction = mysql.start_transaction();
+    auto transaction = start_transaction();
     auto curr_date = mysql_date();
 
-    auto source_contest_opt = sim::contests::get(
-        mysql,
-        sim::contests::GetIdKind::CONTEST,
-        source_contest_id,
-        (session.has_value() ? optional{session->user_id} : std::nullopt),
-        curr_date
+    auto source_contest_opt = contests_get(
+        sim::contests::GetIdKind::CONTEST, source_contest_id, curr_date
     );
     if (not source_contest_opt) {
         return api_error404("There is no contest with this id that you can clone");
@@ -896,7 +924,7 @@ void Sim::api_contest_edit(
         return api_error400(notifications);
     }
 
-    auto transaction = mysql.start_transaction();
+    auto transaction = start_transaction();
     // Update contest
     mysql.prepare("UPDATE contests SET name=?, is_public=? WHERE id=?")
         .bind_and_execute(name, will_be_public, contest_id);
@@ -909,7 +937,16 @@ void Sim::api_contest_edit(
             .bind_and_execute(contest_id, EnumVal(ContestUser::Mode::CONTESTANT), contest_id);
     }
 
+    sim::contest_ranking_snapshots::invalidate_of_contest(
+        mysql, WONT_THROW(str2num<decltype(Contest::id)>(contest_id).value())
+    );
     transaction.commit();
+    contest_permissions_cache.invalidate_contest(
+        str2num<ContestPermissionsCache::ContestId>(contest_id).value()
+    );
+    submissions_display_cache.invalidate(
+        SubmissionsDisplayCache::Entity::CONTEST, str2num<uint64_t>(contest_id).value()
+    );
 }
 
 void Sim::api_contest_delete(StringView contest_id, sim::contests::Permissions perms) {
@@ -925,8 +962,8 @@ void Sim::api_contest_delete(StringView contest_id, sim::contests::Permissions p
 
     // Queue deleting job
     auto stmt = mysql.prepare("INSERT jobs (creator, status, priority, type,"
-                              " added, aux_id, info, data) "
-                              "VALUES(?, ?, ?, ?, ?, ?, '', '')");
+                              " added, aux_id, info) "
+                              "VALUES(?, ?, ?, ?, ?, ?, '')");
     stmt.bind_and_execute(
         session->user_id,
         EnumVal(Job::Status::PENDING),
@@ -1019,15 +1056,11 @@ void Sim::api_contest_round_clone(StringView contest_id, sim::contests::Permissi
         return api_error400(notifications);
     }
 
-    auto transaction = mysql.start_transaction();
+    auto transaction = start_transaction();
     auto curr_date = mysql_date();
 
-    auto source_contest_opt = sim::contests::get(
-        mysql,
-        sim::contests::GetIdKind::CONTEST_ROUND,
-        source_contest_round_id,
-        (session.has_value() ? optional{session->user_id} : std::nullopt),
-        curr_date
+    auto source_contest_opt = contests_get(
+        sim::contests::GetIdKind::CONTEST_ROUND, source_contest_round_id, curr_date
     );
     if (not source_contest_opt) {
         return api_error404("There is no contest round with this id that you can clone");
@@ -1180,6 +1213,10 @@ void Sim::api_contest_round_edit(
         inf_timestamp_to_InfDatetime(ranking_expo).to_str(),
         contest_round_id
     );
+    sim::contest_ranking_snapshots::invalidate_of_contest_round(mysql, contest_round_id);
+    submissions_display_cache.invalidate(
+        SubmissionsDisplayCache::Entity::CONTEST_ROUND, contest_round_id
+    );
 }
 
 void Sim::api_contest_round_delete(
@@ -1197,8 +1234,8 @@ void Sim::api_contest_round_delete(
 
     // Queue deleting job
     auto stmt = mysql.prepare("INSERT jobs (creator, status, priority, type,"
-                              " added, aux_id, info, data) "
-                              "VALUES(?, ?, ?, ?, ?, ?, '', '')");
+                              " added, aux_id, info) "
+                              "VALUES(?, ?, ?, ?, ?, ?, '')");
     stmt.bind_and_execute(
         session->user_id,
         EnumVal(Job::Status::PENDING),
@@ -1245,7 +1282,7 @@ void Sim::api_contest_problem_add(
         (score_revealing, params::contest_problem_score_revealing, REQUIRED)
     );
 
-    auto transaction = mysql.start_transaction();
+    auto transaction = start_transaction();
 
     auto stmt = mysql.prepare("SELECT owner_id, type, name FROM problems WHERE id=?");
     stmt.bind_and_execute(problem_id);
@@ -1306,17 +1343,19 @@ void Sim::api_contest_problem_rejudge_all_submissions(
 
     mysql
         .prepare("INSERT jobs (creator, status, priority, type,"
-                 " added, aux_id, info, data) "
-                 "SELECT ?, ?, ?, ?, ?, id, ?, '' "
-                 "FROM submissions WHERE contest_problem_id=? ORDER BY id")
+                 " added, aux_id, info) "
+                 "VALUES(?, ?, ?, ?, ?, ?, ?)")
         .bind_and_execute(
             session->user_id,
             EnumVal(Job::Status::PENDING),
-            default_priority(Job::Type::REJUDGE_SUBMISSION),
-            EnumVal(Job::Type::REJUDGE_SUBMISSION),
+            default_priority(Job::Type::REJUDGE_PROBLEM_BATCH),
+            EnumVal(Job::Type::REJUDGE_PROBLEM_BATCH),
             mysql_date(),
-            sim::jobs::dump_string(problem_id),
-            contest_problem_id
+            problem_id,
+            sim::jobs::RejudgeProblemBatchInfo(
+                WONT_THROW(str2num<decltype(ContestProblem::id)>(contest_problem_id).value())
+            )
+                .dump()
         );
 
     sim::jobs::notify_job_server();
@@ -1338,7 +1377,7 @@ void Sim::api_contest_problem_edit(
     );
 
     // Have to check if it is necessary to reselect problem final submissions
-    auto transaction = mysql.start_transaction();
+    auto transaction = start_transaction();
 
     // Get the old method of choosing final submission and whether the score was revealed
     auto stmt = mysql.prepare("SELECT method_of_choosing_final_submission, score_revealing "
@@ -1363,8 +1402,8 @@ void Sim::api_contest_problem_edit(
     if (reselect_final_sumbissions) {
         // Queue reselecting final submissions
         stmt = mysql.prepare("INSERT jobs (creator, status, priority, type, added,"
-                             " aux_id, info, data) "
-                             "VALUES(?, ?, ?, ?, ?, ?, '', '')");
+                             " aux_id, info) "
+                             "VALUES(?, ?, ?, ?, ?, ?, '')");
         stmt.bind_and_execute(
             session->user_id,
             EnumVal(Job::Status::PENDING),
@@ -1384,8 +1423,15 @@ void Sim::api_contest_problem_edit(
     stmt.bind_and_execute(
         name, score_revealing, method_of_choosing_final_submission, contest_problem_id
     );
+    sim::contest_ranking_snapshots::invalidate_of_contest_problem(
+        mysql, WONT_THROW(str2num<decltype(ContestProblem::id)>(contest_problem_id).value())
+    );
 
     transaction.commit();
+    submissions_display_cache.invalidate(
+        SubmissionsDisplayCache::Entity::CONTEST_PROBLEM,
+        WONT_THROW(str2num<uint64_t>(contest_problem_id).value())
+    );
     sim::jobs::notify_job_server();
 }
 
@@ -1404,8 +1450,8 @@ void Sim::api_contest_problem_delete(
 
     // Queue deleting job
     auto stmt = mysql.prepare("INSERT jobs (creator, status, priority, type,"
-                              " added, aux_id, info, data) "
-                              "VALUES(?, ?, ?, ?, ?, ?, '', '')");
+                              " added, aux_id, info) "
+                              "VALUES(?, ?, ?, ?, ?, ?, '')");
     stmt.bind_and_execute(
         session->user_id,
         EnumVal(Job::Status::PENDING),
@@ -1438,34 +1484,39 @@ void Sim::api_contest_problem_statement(StringView problem_id) {
 
 namespace {
 
-struct SubmissionOwner {
-    uint64_t id;
-    InplaceBuff<32> name; // static size is set manually to save memory
-
-    template <class... Args>
-    explicit SubmissionOwner(uint64_t sowner, Args&&... args) : id(sowner) {
-        name.append(std::forward<Args>(args)...);
-    }
-
-    bool operator<(const SubmissionOwner& s) const noexcept { return id < s.id; }
-
-    bool operator==(const SubmissionOwner& s) const noexcept { return id == s.id; }
+struct RankingCell {
+    decltype(ContestRound::id) contest_round_id;
+    decltype(ContestProblem::id) contest_problem_id;
+    decltype(Submission::id) submission_id; // final or initial final, as the status shown
+    Submission::Status initial_status;
+    Submission::Status full_status;
+    bool show_full_status;
+    std::optional<int64_t> score;
 };
 
-} // anonymous namespace
+struct RankingRow {
+    uint64_t owner_id;
+    InplaceBuff<32> name; // static size is set manually to save memory
+    int64_t total_score = 0;
+    uint64_t place = 0;
+    std::vector<RankingCell> cells;
+};
 
-void Sim::api_contest_ranking(
-    sim::contests::Permissions perms, StringView submissions_query_id_name, StringView query_id
+// Number of rows shown before and after the session user's row in the "around
+// me" view of the ranking
+constexpr uint64_t RANKING_AROUND_ME_RADIUS = 25;
+
+// Gathers the ranking directly from the submissions. Returned rows are sorted
+// by the owner id and every row has at least one cell.
+std::vector<RankingRow> gather_ranking_rows(
+    mysql::Connection& mysql,
+    sim::contests::Permissions perms,
+    StringView submissions_query_id_name,
+    StringView query_id,
+    const decltype(mysql_date())& curr_date
 ) {
     STACK_UNWINDING_MARK;
 
-    if (uint(~perms & sim::contests::Permissions::VIEW)) {
-        return api_error403();
-    }
-
-    // We read data several times, so transaction makes it consistent
-    auto transaction = mysql.start_transaction();
-
     // Gather submissions owners
     auto stmt = mysql.prepare(intentional_unsafe_string_view(concat(
         "SELECT u.id, u.first_name, u.last_name FROM submissions s JOIN "
@@ -1480,9 +1531,11 @@ void Sim::api_contest_ranking(
     decltype(User::last_name) lname;
     stmt.res_bind_all(u_id, fname, lname);
 
-    std::vector<SubmissionOwner> sowners;
+    std::vector<RankingRow> rows;
     while (stmt.next()) {
-        sowners.emplace_back(u_id, fname, ' ', lname);
+        auto& row = rows.emplace_back();
+        row.owner_id = u_id;
+        row.name.append(fname, ' ', lname);
     }
 
     // Gather submissions
@@ -1497,49 +1550,379 @@ void Sim::api_contest_ranking(
     decltype(Submission::id) si_id = 0;
     EnumVal<Submission::Status> si_initial_status{};
 
-    // TODO: there is too much logic duplication (not only below) on whether to
-    // show full or initial status and show or not show the score
-    auto prepare_stmt = [&](auto&& extra_cr_sql, auto&&... extra_bind_params) {
-        // clang-format off
-        stmt = mysql.prepare(
-           "SELECT cr.id, cr.full_results, cp.id, cp.score_revealing, sf.owner,"
-           " sf.id, sf.full_status, sf.score, si.id, si.initial_status "
-           "FROM submissions sf "
-           "JOIN submissions si ON si.owner=sf.owner"
-           " AND si.contest_problem_id=sf.contest_problem_id"
-           " AND si.contest_initial_final=1 "
-           "JOIN contest_rounds cr ON cr.id=sf.contest_round_id ",
-              std::forward<decltype(extra_cr_sql)>(extra_cr_sql), " "
-           "JOIN contest_problems cp ON cp.id=sf.contest_problem_id "
-           "WHERE sf.", submissions_query_id_name, "=? AND sf.contest_final=1 "
-           "ORDER BY sf.owner");
-        // clang-format on
-        stmt.bind_and_execute(
-            std::forward<decltype(extra_bind_params)>(extra_bind_params)..., query_id
+    bool is_admin = uint(perms & sim::contests::Permissions::ADMIN);
+    // clang-format off
+    stmt = mysql.prepare(
+       "SELECT cr.id, cr.full_results, cp.id, cp.score_revealing, sf.owner,"
+       " sf.id, sf.full_status, sf.score, si.id, si.initial_status "
+       "FROM submissions sf "
+       "JOIN submissions si ON si.owner=sf.owner"
+       " AND si.contest_problem_id=sf.contest_problem_id"
+       " AND si.contest_initial_final=1 "
+       "JOIN contest_rounds cr ON cr.id=sf.contest_round_id ",
+          (is_admin ? "" : "AND cr.begins<=? AND cr.ranking_exposure<=? "),
+       "JOIN contest_problems cp ON cp.id=sf.contest_problem_id "
+       "WHERE sf.", submissions_query_id_name, "=? AND sf.contest_final=1 "
+       "ORDER BY sf.owner");
+    // clang-format on
+    if (is_admin) {
+        stmt.bind_and_execute(query_id);
+    } else {
+        stmt.bind_and_execute(curr_date, curr_date, query_id);
+    }
+    stmt.res_bind_all(
+        cr_id,
+        cr_full_results,
+        cp_id,
+        cp_score_revealing,
+        s_owner,
+        sf_id,
+        sf_full_status,
+        sf_score,
+        si_id,
+        si_initial_status
+    );
+
+    auto row_it = rows.end();
+    while (stmt.next()) {
+        if (row_it == rows.end() or row_it->owner_id != s_owner) {
+            row_it = std::lower_bound(
+                rows.begin(), rows.end(), s_owner, [](const RankingRow& row, uint64_t owner) {
+                    return row.owner_id < owner;
+                }
+            );
+            if (row_it == rows.end() or row_it->owner_id != s_owner) {
+                row_it = rows.end();
+                continue; // Ignore submission as there is no owner to bind it
+                          // to (this maybe a little race condition, but if the
+                          // user will query again it will not be the case (with
+                          // the current owner))
+            }
+        }
+
+        bool show_full_status =
+            whether_to_show_full_status(perms, cr_full_results, curr_date, cp_score_revealing);
+        bool show_score =
+            whether_to_show_score(perms, cr_full_results, curr_date, cp_score_revealing);
+
+        row_it->cells.push_back({
+            .contest_round_id = cr_id,
+            .contest_problem_id = cp_id,
+            .submission_id = (show_full_status ? sf_id : si_id),
+            .initial_status = si_initial_status,
+            .full_status = sf_full_status,
+            .show_full_status = show_full_status,
+            .score = (show_score ? std::optional{sf_score} : std::nullopt),
+        });
+        if (show_score) {
+            row_it->total_score += sf_score;
+        }
+    }
+
+    // Users without any visible submission are not shown in the ranking
+    rows.erase(
+        std::remove_if(
+            rows.begin(), rows.end(), [](const RankingRow& row) { return row.cells.empty(); }
+        ),
+        rows.end()
+    );
+    return rows;
+}
+
+std::string dump_ranking_rows(const std::vector<RankingRow>& rows) {
+    STACK_UNWINDING_MARK;
+    using sim::jobs::append_dumped;
+
+    std::string res;
+    append_dumped<uint32_t>(res, rows.size());
+    for (const auto& row : rows) {
+        append_dumped(res, row.owner_id);
+        append_dumped(res, row.name);
+        append_dumped(res, row.total_score);
+        append_dumped<uint32_t>(res, row.cells.size());
+        for (const auto& cell : row.cells) {
+            append_dumped(res, cell.contest_round_id);
+            append_dumped(res, cell.contest_problem_id);
+            append_dumped(res, cell.submission_id);
+            append_dumped(res, EnumVal(cell.initial_status).to_int());
+            append_dumped(res, EnumVal(cell.full_status).to_int());
+            append_dumped(res, cell.show_full_status);
+            append_dumped(res, cell.score);
+        }
+    }
+    return res;
+}
+
+std::vector<RankingRow> extract_ranking_rows(StringView dumped_str) {
+    STACK_UNWINDING_MARK;
+    using sim::jobs::extract_dumped;
+    using sim::jobs::extract_dumped_int;
+
+    std::vector<RankingRow> rows(extract_dumped_int<uint32_t>(dumped_str));
+    for (auto& row : rows) {
+        extract_dumped(row.owner_id, dumped_str);
+        row.name.append(sim::jobs::extract_dumped_string(dumped_str));
+        extract_dumped(row.total_score, dumped_str);
+        row.cells.resize(extract_dumped_int<uint32_t>(dumped_str));
+        for (auto& cell : row.cells) {
+            extract_dumped(cell.contest_round_id, dumped_str);
+            extract_dumped(cell.contest_problem_id, dumped_str);
+            extract_dumped(cell.submission_id, dumped_str);
+            using StatusVal = EnumVal<Submission::Status>;
+            cell.initial_status = StatusVal(extract_dumped_int<StatusVal::ValType>(dumped_str));
+            cell.full_status = StatusVal(extract_dumped_int<StatusVal::ValType>(dumped_str));
+            extract_dumped(cell.show_full_status, dumped_str);
+            extract_dumped(cell.score, dumped_str);
+        }
+    }
+    return rows;
+}
+
+// Contest rounds whose ranking snapshots are being rebuilt by a worker of this process
+class RankingSnapshotRebuilds {
+    std::mutex mtx_;
+    std::set<decltype(ContestRound::id)> rebuilt_rounds_;
+
+public:
+    // Returns false if the snapshot is already being rebuilt
+    bool try_claim(decltype(ContestRound::id) contest_round_id) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return rebuilt_rounds_.emplace(contest_round_id).second;
+    }
+
+    void release(decltype(ContestRound::id) contest_round_id) noexcept {
+        std::lock_guard<std::mutex> lock(mtx_);
+        rebuilt_rounds_.erase(contest_round_id);
+    }
+};
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+RankingSnapshotRebuilds ranking_snapshot_rebuilds;
+
+// Returns the ranking of the contest round as seen by non-admins, served from the round's
+// snapshot, which is read-only for the readers. A snapshot older than
+// sim::contest_ranking_snapshots::refresh_interval is rebuilt by a single worker at a time, while
+// the others keep serving the older one. Only if there is no usable snapshot (none yet, it was
+// invalidated or the round's full results were revealed) and another worker rebuilds it, the
+// ranking is gathered without saving it.
+std::vector<RankingRow> load_round_ranking_snapshot(
+    mysql::Connection& mysql,
+    decltype(ContestRound::id) contest_round_id,
+    const sim::InfDatetime& round_full_results,
+    const decltype(mysql_date())& curr_date
+) {
+    STACK_UNWINDING_MARK;
+
+    auto stmt = mysql.prepare("SELECT generation, valid_until>?, created_at>?, data "
+                              "FROM contest_ranking_snapshots WHERE contest_round_id=?");
+    stmt.bind_and_execute(
+        curr_date,
+        mysql_date(
+            std::chrono::system_clock::now() - sim::contest_ranking_snapshots::refresh_interval
+        ),
+        contest_round_id
+    );
+    decltype(sim::contest_ranking_snapshots::ContestRankingSnapshot::generation) generation = 0;
+    uint8_t is_valid = false;
+    uint8_t is_fresh = false;
+    InplaceBuff<4096> data;
+    stmt.res_bind_all(generation, is_valid, is_fresh, data);
+    bool exists = stmt.next();
+    if (exists and is_valid and is_fresh) {
+        return extract_ranking_rows(data);
+    }
+
+    bool rebuild = ranking_snapshot_rebuilds.try_claim(contest_round_id);
+    CallInDtor rebuild_releaser([&] {
+        if (rebuild) {
+            ranking_snapshot_rebuilds.release(contest_round_id);
+        }
+    });
+    if (exists and is_valid and not rebuild) {
+        return extract_ranking_rows(data); // Slightly stale
+    }
+
+    auto rows = gather_ranking_rows(
+        mysql,
+        sim::contests::Permissions::VIEW,
+        "contest_round_id",
+        intentional_unsafe_string_view(to_string(contest_round_id)),
+        curr_date
+    );
+
+    sim::InfDatetime valid_until;
+    if (curr_date < round_full_results) {
+        valid_until = round_full_results;
+    } else {
+        valid_until.set_inf();
+    }
+    if (not rebuild) {
+        return rows;
+    }
+
+    // The data was read before the below (locking) queries, so the snapshot
+    // is saved only if there was no invalidation in the meantime
+    if (exists) {
+        mysql
+            .prepare("UPDATE contest_ranking_snapshots "
+                     "SET created_at=?, valid_until=?, data=? "
+                     "WHERE contest_round_id=? AND generation=?")
+            .bind_and_execute(
+                curr_date,
+                valid_until.to_str(),
+                dump_ranking_rows(rows),
+                contest_round_id,
+                generation
+            );
+    } else {
+        mysql
+            .prepare("INSERT IGNORE INTO contest_ranking_snapshots(contest_round_id,"
+                     " generation, created_at, valid_until, data) "
+                     "VALUES(?, 0, ?, ?, ?)")
+            .bind_and_execute(
+                contest_round_id, curr_date, valid_until.to_str(), dump_ranking_rows(rows)
+            );
+    }
+
+    return rows;
+}
+
+// Returns the ranking rows sorted by the owner id. Admins get the ranking
+// gathered directly from the submissions, others -- from the rounds'
+// snapshots.
+std::vector<RankingRow> load_ranking_rows(
+    mysql::Connection& mysql,
+    sim::contests::Permissions perms,
+    StringView submissions_query_id_name,
+    StringView query_id,
+    const decltype(mysql_date())& curr_date
+) {
+    STACK_UNWINDING_MARK;
+
+    if (uint(perms & sim::contests::Permissions::ADMIN)) {
+        return gather_ranking_rows(mysql, perms, submissions_query_id_name, query_id, curr_date);
+    }
+
+    // Select the rounds that are visible in the ranking
+    StringView rounds_sql = [&]() -> StringView {
+        if (submissions_query_id_name == "contest_id") {
+            return "SELECT cr.id, cr.full_results FROM contest_rounds cr "
+                   "WHERE cr.contest_id=? AND cr.begins<=? AND cr.ranking_exposure<=?";
+        }
+        if (submissions_query_id_name == "contest_round_id") {
+            return "SELECT cr.id, cr.full_results FROM contest_rounds cr "
+                   "WHERE cr.id=? AND cr.begins<=? AND cr.ranking_exposure<=?";
+        }
+        throw_assert(submissions_query_id_name == "contest_problem_id");
+        return "SELECT cr.id, cr.full_results FROM contest_problems cp "
+               "JOIN contest_rounds cr ON cr.id=cp.contest_round_id "
+               "WHERE cp.id=? AND cr.begins<=? AND cr.ranking_exposure<=?";
+    }();
+
+    auto stmt = mysql.prepare(rounds_sql);
+    stmt.bind_and_execute(query_id, curr_date, curr_date);
+    decltype(ContestRound::id) cr_id = 0;
+    decltype(ContestRound::full_results) cr_full_results;
+    stmt.res_bind_all(cr_id, cr_full_results);
+
+    std::vector<pair<decltype(cr_id), sim::InfDatetime>> rounds;
+    while (stmt.next()) {
+        rounds.emplace_back(cr_id, cr_full_results.as_inf_datetime());
+    }
+
+    std::vector<RankingRow> rows;
+    for (const auto& [round_id, round_full_results] : rounds) {
+        auto round_rows =
+            load_round_ranking_snapshot(mysql, round_id, round_full_results, curr_date);
+        rows.insert(
+            rows.end(),
+            std::make_move_iterator(round_rows.begin()),
+            std::make_move_iterator(round_rows.end())
         );
-        stmt.res_bind_all(
-            cr_id,
-            cr_full_results,
-            cp_id,
-            cp_score_revealing,
-            s_owner,
-            sf_id,
-            sf_full_status,
-            sf_score,
-            si_id,
-            si_initial_status
+    }
+
+    if (submissions_query_id_name == "contest_problem_id") {
+        auto cp_id = WONT_THROW(str2num<decltype(ContestProblem::id)>(query_id).value());
+        for (auto& row : rows) {
+            row.total_score = 0;
+            row.cells.erase(
+                std::remove_if(
+                    row.cells.begin(),
+                    row.cells.end(),
+                    [&](const RankingCell& cell) { return cell.contest_problem_id != cp_id; }
+                ),
+                row.cells.end()
+            );
+            for (const auto& cell : row.cells) {
+                row.total_score += cell.score.value_or(0);
+            }
+        }
+        rows.erase(
+            std::remove_if(
+                rows.begin(), rows.end(), [](const RankingRow& row) { return row.cells.empty(); }
+            ),
+            rows.end()
         );
-    };
+    }
 
-    auto curr_date = mysql_date();
+    if (rounds.size() > 1) {
+        // Merge rows of the same owner from different rounds
+        std::stable_sort(rows.begin(), rows.end(), [](const RankingRow& a, const RankingRow& b) {
+            return a.owner_id < b.owner_id;
+        });
+        size_t new_size = 0;
+        for (auto& row : rows) {
+            if (new_size > 0 and rows[new_size - 1].owner_id == row.owner_id) {
+                auto& merged = rows[new_size - 1];
+                merged.total_score += row.total_score;
+                merged.cells.insert(merged.cells.end(), row.cells.begin(), row.cells.end());
+            } else {
+                if (&rows[new_size] != &row) {
+                    rows[new_size] = std::move(row);
+                }
+                ++new_size;
+            }
+        }
+        rows.resize(new_size);
+    }
 
-    bool is_admin = uint(perms & sim::contests::Permissions::ADMIN);
-    if (is_admin) {
-        prepare_stmt("");
-    } else {
-        prepare_stmt("AND cr.begins<=? AND cr.ranking_exposure<=?", curr_date, curr_date);
+    return rows;
+}
+
+// Sorts rows by the total score (descending) and the owner id and assigns
+// places in the same way as the client did it: users with equal total score
+// share the place
+void rank_ranking_rows(std::vector<RankingRow>& rows) {
+    // Rows are sorted by the owner id, so stable sort gives the owner id tie breaking
+    std::stable_sort(rows.begin(), rows.end(), [](const RankingRow& a, const RankingRow& b) {
+        return a.total_score > b.total_score;
+    });
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (i == 0 or rows[i].total_score != rows[i - 1].total_score) {
+            rows[i].place = i + 1;
+        } else {
+            rows[i].place = rows[i - 1].place;
+        }
+    }
+}
+
+} // anonymous namespace
+
+void Sim::api_contest_ranking(
+    sim::contests::Permissions perms, StringView submissions_query_id_name, StringView query_id
+) {
+    STACK_UNWINDING_MARK;
+
+    if (uint(~perms & sim::contests::Permissions::VIEW)) {
+        return api_error403();
     }
 
+    // We read data several times, so transaction makes it consistent
+    auto transaction = start_transaction();
+    auto curr_date = mysql_date();
+    auto rows = load_ranking_rows(mysql, perms, submissions_query_id_name, query_id, curr_date);
+    transaction.commit(); // Snapshots may have been saved
+
     append('[');
     // Column names
     // clang-format off
@@ -1557,74 +1940,205 @@ void Sim::api_contest_ranking(
            "]}");
     // clang-format on
 
+    bool is_admin = uint(perms & sim::contests::Permissions::ADMIN);
     const uint64_t session_uid = (session.has_value() ? session->user_id : 0);
 
-    bool first_owner = true;
-    std::optional<decltype(s_owner)> prev_owner;
-    bool show_owner_and_submission_id = false;
-
-    while (stmt.next()) {
-        // Owner changes
-        if (first_owner or s_owner != prev_owner.value()) {
-            auto it = binary_find(sowners, SubmissionOwner(s_owner));
-            if (it == sowners.end()) {
-                continue; // Ignore submission as there is no owner to bind it
-                          // to (this maybe a little race condition, but if the
-                          // user will query again it will not be the case (with
-                          // the current owner))
-            }
+    for (const auto& row : rows) {
+        bool show_owner_and_submission_id =
+            (is_admin or (session.has_value() and session_uid == row.owner_id));
+        // Owner
+        if (show_owner_and_submission_id) {
+            append(",\n[", row.owner_id);
+        } else {
+            append(",\n[null");
+        }
+        // Owner name
+        append(',', json_stringify(row.name), ",[");
 
-            if (first_owner) {
-                append(",\n[");
-                first_owner = false;
+        for (const auto& cell : row.cells) {
+            append("\n[");
+            if (show_owner_and_submission_id) {
+                append(cell.submission_id, ',');
             } else {
-                --resp.content.size; // remove trailing ','
-                append("\n]],[");
+                append("null,");
             }
-
-            prev_owner = s_owner;
-            show_owner_and_submission_id =
-                (is_admin or (session.has_value() and session_uid == s_owner));
-            // Owner
-            if (show_owner_and_submission_id) {
-                append(s_owner);
+            append(cell.contest_round_id, ',', cell.contest_problem_id, ',');
+            append_submission_status(cell.initial_status, cell.full_status, cell.show_full_status);
+            if (cell.score) {
+                append(',', *cell.score, "],");
             } else {
-                append("null");
+                append(",null],");
             }
-            // Owner name
-            append(',', json_stringify(it->name), ",[");
         }
+        --resp.content.size; // remove trailing ',' (every row has at least one cell)
+        append("\n]]");
+    }
 
-        bool show_full_status =
-            whether_to_show_full_status(perms, cr_full_results, curr_date, cp_score_revealing);
+    append(']');
+}
 
-        append("\n[");
-        if (not show_owner_and_submission_id) {
-            append("null,");
-        } else if (show_full_status) {
-            append(sf_id, ',');
-        } else {
-            append(si_id, ',');
-        }
+void Sim::api_contest_ranking_rows(
+    sim::contests::Permissions perms, StringView submissions_query_id_name, StringView query_id
+) {
+    STACK_UNWINDING_MARK;
 
-        append(cr_id, ',', cp_id, ',');
-        append_submission_status(si_initial_status, sf_full_status, show_full_status);
+    if (uint(~perms & sim::contests::Permissions::VIEW)) {
+        return api_error403();
+    }
 
-        bool show_score =
-            whether_to_show_score(perms, cr_full_results, curr_date, cp_score_revealing);
-        if (show_score) {
-            append(',', sf_score, "],");
-        } else {
-            append(",null],");
+    // Page selection:
+    //   (nothing)               -- the first page
+    //   /offset/<n>             -- page starting at the n-th row (counting from 0)
+    //   /after/<score>/<uid>    -- page starting just after the row (score, uid); admins only, as
+    //                              bisecting uid would reveal the owners of anonymised rows
+    //   /around_me              -- rows around the session user's row
+    enum class PageKind { OFFSET, AFTER, AROUND_ME } page_kind = PageKind::OFFSET;
+    uint64_t offset = 0;
+    int64_t after_score = 0;
+    uint64_t after_uid = 0;
+    auto rows_limit = API_FIRST_QUERY_ROWS_LIMIT;
+
+    StringView next_arg = url_args.extract_next_arg();
+    if (next_arg == "offset") {
+        auto opt = str2num<uint64_t>(url_args.extract_next_arg());
+        if (not opt) {
+            return api_error400("Invalid offset");
+        }
+        offset = *opt;
+        rows_limit = API_OTHER_QUERY_ROWS_LIMIT;
+    } else if (next_arg == "after") {
+        if (uint(~perms & sim::contests::Permissions::ADMIN)) {
+            return api_error403();
         }
+        auto score_opt = str2num<int64_t>(url_args.extract_next_arg());
+        auto uid_opt = str2num<uint64_t>(url_args.extract_next_arg());
+        if (not score_opt or not uid_opt) {
+            return api_error400("Invalid keyset");
+        }
+        page_kind = PageKind::AFTER;
+        after_score = *score_opt;
+        after_uid = *uid_opt;
+        rows_limit = API_OTHER_QUERY_ROWS_LIMIT;
+    } else if (next_arg == "around_me") {
+        if (not session.has_value()) {
+            return api_error403();
+        }
+        page_kind = PageKind::AROUND_ME;
+    } else if (not next_arg.empty()) {
+        return api_error400();
     }
 
-    if (first_owner) { // no submission was appended
-        append(']');
+    // We read data several times, so transaction makes it consistent
+    auto transaction = start_transaction();
+    auto curr_date = mysql_date();
+    auto rows = load_ranking_rows(mysql, perms, submissions_query_id_name, query_id, curr_date);
+    transaction.commit(); // Snapshots may have been saved
+    rank_ranking_rows(rows);
+
+    size_t beg = 0;
+    size_t end = 0;
+    switch (page_kind) {
+    case PageKind::OFFSET: {
+        beg = std::min<uint64_t>(offset, rows.size());
+        end = std::min<uint64_t>(beg + rows_limit, rows.size());
+        break;
+    }
+    case PageKind::AFTER: {
+        beg = std::upper_bound(
+                  rows.begin(),
+                  rows.end(),
+                  std::pair{after_score, after_uid},
+                  [](const pair<int64_t, uint64_t>& key, const RankingRow& row) {
+                      return key.first > row.total_score or
+                          (key.first == row.total_score and key.second < row.owner_id);
+                  }
+              ) -
+            rows.begin();
+        end = std::min<uint64_t>(beg + rows_limit, rows.size());
+        break;
+    }
+    case PageKind::AROUND_ME: {
+        auto it = std::find_if(rows.begin(), rows.end(), [&](const RankingRow& row) {
+            return row.owner_id == session->user_id;
+        });
+        if (it != rows.end()) {
+            auto pos = static_cast<size_t>(it - rows.begin());
+            beg = pos - std::min<uint64_t>(pos, RANKING_AROUND_ME_RADIUS);
+            end = std::min<uint64_t>(pos + RANKING_AROUND_ME_RADIUS + 1, rows.size());
+        }
+        break;
+    }
+    }
+
+    bool is_admin = uint(perms & sim::contests::Permissions::ADMIN);
+    const uint64_t session_uid = (session.has_value() ? session->user_id : 0);
+
+    // clang-format off
+    append("[\n{\"fields\":["
+               "\"rows_total\",\"next\","
+               "{\"name\":\"rows\",\"columns\":["
+                   "\"place\",\"id\",\"name\",\"score\","
+                   "{\"name\":\"submissions\",\"columns\":["
+                       "\"id\",\"contest_round_id\","
+                       "\"contest_problem_id\","
+                       "{\"name\":\"status\",\"fields\":["
+                           "\"class\","
+                           "\"text\""
+                       "]},"
+                       "\"score\""
+                   "]}"
+               "]}"
+           "]},\n", rows.size(), ',');
+    // clang-format on
+
+    // The keyset cursor reveals the owner id, so it is given only to those
+    // who may see ids of all users
+    if (page_kind == PageKind::AROUND_ME or end == rows.size()) {
+        append("null");
+    } else if (is_admin) {
+        append("\"after/", rows[end - 1].total_score, '/', rows[end - 1].owner_id, '"');
     } else {
+        append("\"offset/", end, '"');
+    }
+
+    append(",[");
+    for (size_t i = beg; i < end; ++i) {
+        const auto& row = rows[i];
+        bool show_owner_and_submission_id =
+            (is_admin or (session.has_value() and session_uid == row.owner_id));
+
+        append("\n[", row.place, ',');
+        if (show_owner_and_submission_id) {
+            append(row.owner_id);
+        } else {
+            append("null");
+        }
+        append(',', json_stringify(row.name), ',', row.total_score, ",[");
+
+        for (const auto& cell : row.cells) {
+            append("\n[");
+            if (show_owner_and_submission_id) {
+                append(cell.submission_id, ',');
+            } else {
+                append("null,");
+            }
+            append(cell.contest_round_id, ',', cell.contest_problem_id, ',');
+            append_submission_status(cell.initial_status, cell.full_status, cell.show_full_status);
+            if (cell.score) {
+                append(',', *cell.score, "],");
+            } else {
+                append(",null],");
+            }
+        }
+        if (not row.cells.empty()) {
+            --resp.content.size; // remove trailing ','
+        }
+        append("]],");
+    }
+    if (beg < end) {
         --resp.content.size; // remove trailing ','
-        append("\n]]]");
     }
+    append("\n]]");
 }
 
 } // namespace web_server::old
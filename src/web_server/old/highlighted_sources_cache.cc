@@ -0,0 +1,159 @@
+#include "highlighted_sources_cache.hh"
+
+#include <cstdio>
+#include <simlib/concat.hh>
+#include <simlib/debug.hh>
+#include <simlib/file_contents.hh>
+#include <simlib/file_descriptor.hh>
+#include <simlib/file_manip.hh>
+#include <simlib/logger.hh>
+#include <simlib/opened_temporary_file.hh>
+#include <sys/stat.h>
+
+namespace web_server::old {
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+HighlightedSourcesCache highlighted_sources_cache;
+
+namespace {
+
+// Format of the file header: "<highlighter version> <inode> <mtime_ns>\n"
+auto disk_file_header(const uint64_t inode, const uint64_t mtime_ns) {
+    return concat<64>(sim::CppSyntaxHighlighter::version, ' ', inode, ' ', mtime_ns, '\n');
+}
+
+} // namespace
+
+std::shared_ptr<const std::string> HighlightedSourcesCache::get(
+    decltype(sim::internal_files::InternalFile::id) file_id,
+    const sim::CppSyntaxHighlighter& highlighter
+) {
+    STACK_UNWINDING_MARK;
+
+    auto source_path = sim::internal_files::path_of(file_id);
+    auto render = [&] {
+        return std::make_shared<const std::string>(
+            highlighter(intentional_unsafe_cstring_view(get_file_contents(source_path)))
+        );
+    };
+
+    struct stat st = {};
+    if (stat(source_path.to_cstr().data(), &st)) {
+        return render(); // Let it fail in the same way as without the cache
+    }
+
+    Entry entry = {
+        .file_id = file_id,
+        .inode = st.st_ino,
+        .mtime_ns = static_cast<uint64_t>(st.st_mtim.tv_sec) * 1'000'000'000 +
+            static_cast<uint64_t>(st.st_mtim.tv_nsec),
+        .html = nullptr,
+    };
+
+    if (auto html = find_in_memory(entry)) {
+        return html;
+    }
+
+    if (save_on_disk_) {
+        entry.html = load_from_disk(entry);
+    }
+    if (not entry.html) {
+        entry.html = render();
+        if (save_on_disk_) {
+            save_to_disk(entry);
+        }
+    }
+
+    auto html = entry.html;
+    insert_into_memory(std::move(entry));
+    return html;
+}
+
+std::shared_ptr<const std::string> HighlightedSourcesCache::find_in_memory(const Entry& key) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = entries_.find(key.file_id);
+    if (it == entries_.end()) {
+        return nullptr;
+    }
+
+    auto lru_it = it->second;
+    if (lru_it->inode != key.inode or lru_it->mtime_ns != key.mtime_ns) {
+        // The file id was reused
+        used_memory_ -= lru_it->html->size();
+        lru_.erase(lru_it);
+        entries_.erase(it);
+        return nullptr;
+    }
+
+    lru_.splice(lru_.begin(), lru_, lru_it);
+    return lru_it->html;
+}
+
+void HighlightedSourcesCache::insert_into_memory(Entry entry) {
+    if (entry.html->size() > max_memory_) {
+        return; // Would evict everything and still not fit
+    }
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (auto it = entries_.find(entry.file_id); it != entries_.end()) {
+        // Other worker has just inserted it
+        used_memory_ -= it->second->html->size();
+        lru_.erase(it->second);
+        entries_.erase(it);
+    }
+
+    used_memory_ += entry.html->size();
+    auto file_id = entry.file_id;
+    lru_.emplace_front(std::move(entry));
+    entries_.emplace(file_id, lru_.begin());
+
+    while (used_memory_ > max_memory_) {
+        auto& victim = lru_.back();
+        used_memory_ -= victim.html->size();
+        entries_.erase(victim.file_id);
+        lru_.pop_back();
+    }
+}
+
+std::shared_ptr<const std::string> HighlightedSourcesCache::load_from_disk(const Entry& key) {
+    STACK_UNWINDING_MARK;
+
+    FileDescriptor fd(
+        sim::internal_files::highlighted_source_path_of(key.file_id), O_RDONLY | O_CLOEXEC
+    );
+    if (not fd.is_open()) {
+        return nullptr;
+    }
+
+    try {
+        auto contents = get_file_contents(fd);
+        auto header = disk_file_header(key.inode, key.mtime_ns);
+        if (not has_prefix(contents, header)) {
+            return nullptr; // Stale file (other highlighter version or reused file id)
+        }
+        contents.erase(0, header.size);
+        return std::make_shared<const std::string>(std::move(contents));
+    } catch (const std::exception& e) {
+        ERRLOG_CATCH(e);
+        return nullptr;
+    }
+}
+
+void HighlightedSourcesCache::save_to_disk(const Entry& entry) noexcept {
+    STACK_UNWINDING_MARK;
+
+    try {
+        // Write to a temporary file and rename it to make the write atomic
+        OpenedTemporaryFile tmp_file(concat_tostr(sim::internal_files::cache_dir, "tmp.XXXXXX"));
+        write_all_throw(tmp_file, disk_file_header(entry.inode, entry.mtime_ns));
+        write_all_throw(tmp_file, *entry.html);
+        auto dest_path = sim::internal_files::highlighted_source_path_of(entry.file_id);
+        if (rename(tmp_file.path(), dest_path)) {
+            THROW("rename()", errmsg());
+        }
+    } catch (const std::exception& e) {
+        ERRLOG_CATCH(e);
+    }
+}
+
+} // namespace web_server::old
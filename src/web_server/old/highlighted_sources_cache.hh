@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sim/cpp_syntax_highlighter.hh>
+#include <sim/internal_files/internal_file.hh>
+#include <string>
+
+namespace web_server::old {
+
+// Process-wide LRU cache of submission sources rendered by sim::CppSyntaxHighlighter.
+// Internal files are immutable, but their ids may be reused after deletion, so an entry is
+// identified by the file id, the file's inode and modification time and the highlighter
+// version. Rendered sources may also be saved in sim::internal_files::cache_dir, so they
+// survive server restarts (the DELETE_FILE job removes them).
+class HighlightedSourcesCache {
+    struct Entry {
+        decltype(sim::internal_files::InternalFile::id) file_id;
+        uint64_t inode;
+        uint64_t mtime_ns;
+        std::shared_ptr<const std::string> html;
+    };
+
+    std::mutex mtx_;
+    size_t max_memory_ = 0;
+    size_t used_memory_ = 0;
+    bool save_on_disk_ = false;
+    std::list<Entry> lru_; // the most recently used entry is at the front
+    std::map<decltype(Entry::file_id), std::list<Entry>::iterator> entries_;
+
+public:
+    HighlightedSourcesCache() = default;
+
+    HighlightedSourcesCache(const HighlightedSourcesCache&) = delete;
+    HighlightedSourcesCache(HighlightedSourcesCache&&) = delete;
+    HighlightedSourcesCache& operator=(const HighlightedSourcesCache&) = delete;
+    HighlightedSourcesCache& operator=(HighlightedSourcesCache&&) = delete;
+    ~HighlightedSourcesCache() = default;
+
+    // Not thread-safe, should be called before the workers start
+    void configure(size_t max_memory, bool save_on_disk) noexcept {
+        max_memory_ = max_memory;
+        save_on_disk_ = save_on_disk;
+    }
+
+    // Returns the highlighted source of the internal file @p file_id; on cache miss it is
+    // rendered using @p highlighter
+    std::shared_ptr<const std::string>
+    get(decltype(sim::internal_files::InternalFile::id) file_id,
+        const sim::CppSyntaxHighlighter& highlighter);
+
+private:
+    std::shared_ptr<const std::string> find_in_memory(const Entry& key);
+
+    void insert_into_memory(Entry entry);
+
+    static std::shared_ptr<const std::string> load_from_disk(const Entry& key);
+
+    static void save_to_disk(const Entry& entry) noexcept;
+};
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+extern HighlightedSourcesCache highlighted_sources_cache;
+
+} // namespace web_server::old
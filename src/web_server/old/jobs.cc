@@ -58,6 +58,7 @@ Sim::JobPermissions Sim::jobs_get_permissions(
 
         case JT::JUDGE_SUBMISSION:
         case JT::REJUDGE_SUBMISSION:
+        case JT::REJUDGE_PROBLEM_BATCH:
         case JT::EDIT_PROBLEM:
         case JT::DELETE_PROBLEM:
         case JT::MERGE_PROBLEMS:
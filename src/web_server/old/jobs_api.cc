@@ -1,3 +1,4 @@
+#include "../routes.hh"
 #include "sim.hh"
 
 #include <sim/jobs/utils.hh>
@@ -16,6 +17,7 @@ static constexpr const char* job_type_str(Job::Type type) noexcept {
     switch (type) {
     case JT::JUDGE_SUBMISSION: return "Judge submission";
     case JT::REJUDGE_SUBMISSION: return "Rejudge submission";
+    case JT::REJUDGE_PROBLEM_BATCH: return "Rejudge problem submissions";
     case JT::ADD_PROBLEM: return "Add problem";
     case JT::REUPLOAD_PROBLEM: return "Reupload problem";
     case JT::ADD_PROBLEM__JUDGE_MODEL_SOLUTION: return "Add problem - set time limits";
@@ -50,7 +52,7 @@ void Sim::api_jobs() {
 
     // We may read data several times (permission checking), so transaction is
     // used to ensure data consistency
-    auto transaction = mysql.start_transaction();
+    auto transaction = start_transaction();
 
     // Get the overall permissions to the job queue
     jobs_perms = jobs_get_overall_permissions();
@@ -73,7 +75,6 @@ void Sim::api_jobs() {
         JINFO,
         CREATOR,
         CREATOR_USERNAME,
-        JOB_LOG_VIEW
     };
 
     auto append_column_names = [&] {
@@ -101,6 +102,7 @@ void Sim::api_jobs() {
 
     bool allow_access = uint(jobs_perms & PERM::VIEW_ALL);
     bool select_specified_job = false;
+    decltype(Job::id) specified_job_id = 0;
 
     PERM granted_perms = PERM::NONE;
 
@@ -137,9 +139,12 @@ void Sim::api_jobs() {
             if (not stmt.next()) {
                 return api_error404();
             }
+            specified_job_id = WONT_THROW(str2num<decltype(Job::id)>(arg_id).value());
 
             // Grant permissions if possible
-            if (is_problem_management_job(jtype) and aux_id) {
+            if ((is_problem_management_job(jtype) or jtype == Job::Type::REJUDGE_PROBLEM_BATCH) and
+                aux_id)
+            {
                 granted_perms |= jobs_granted_permissions_problem(
                     intentional_unsafe_string_view(concat(aux_id.value()))
                 );
@@ -156,7 +161,6 @@ void Sim::api_jobs() {
                 qwhere.append(" AND creator=", session->user_id);
             }
 
-            qfields.append(", SUBSTR(data, 1, ", sim::jobs::job_log_view_max_size + 1, ')');
             qwhere.append(" AND j.id", arg);
             mask |= ID_COND;
 
@@ -180,6 +184,8 @@ void Sim::api_jobs() {
                 EnumVal(Job::Type::DELETE_PROBLEM).to_int(),
                 ',',
                 EnumVal(Job::Type::EDIT_PROBLEM).to_int(),
+                ',',
+                EnumVal(Job::Type::REJUDGE_PROBLEM_BATCH).to_int(),
                 ')'
             );
 
@@ -219,6 +225,13 @@ void Sim::api_jobs() {
         return set_empty_response();
     }
 
+    // The log is fetched before the query, as the connection is busy with its results afterwards
+    std::string log_view;
+    if (select_specified_job) {
+        log_view =
+            sim::jobs::load_log(mysql, specified_job_id, sim::jobs::job_log_view_max_size + 1);
+    }
+
     // Execute query
     qfields.append(qwhere, " ORDER BY j.id DESC LIMIT ", rows_limit);
     auto res = mysql.query(qfields);
@@ -327,6 +340,16 @@ void Sim::api_jobs() {
             break;
         }
 
+        case Job::Type::REJUDGE_PROBLEM_BATCH: {
+            append("\"problem\":", res[AUX_ID]);
+            sim::jobs::RejudgeProblemBatchInfo info(res[JINFO]);
+            if (info.contest_problem_id) {
+                append(",\"contest problem\":", info.contest_problem_id.value());
+            }
+            append(",\"judged submissions\":", info.judged_submissions);
+            break;
+        }
+
         case Job::Type::DELETE_PROBLEM: {
             append("\"problem\":", res[AUX_ID]);
             break;
@@ -427,9 +450,11 @@ void Sim::api_jobs() {
         if (select_specified_job and uint(perms & PERM::DOWNLOAD_LOG)) {
             append(
                 ",[",
-                res[JOB_LOG_VIEW].size() > sim::jobs::job_log_view_max_size,
+                log_view.size() > sim::jobs::job_log_view_max_size,
                 ',',
-                json_stringify(res[JOB_LOG_VIEW]),
+                json_stringify(
+                    StringView(log_view).substr(0, sim::jobs::job_log_view_max_size + 1)
+                ),
                 ']'
             );
         }
@@ -448,10 +473,7 @@ void Sim::api_job() {
         return api_error403();
     }
 
-    jobs_jid = url_args.extract_next_arg();
-    if (not is_digit(jobs_jid)) {
-        return api_error400();
-    }
+    jobs_jid = route_capture(0);
 
     mysql::Optional<uint64_t> file_id;
     mysql::Optional<InplaceBuff<32>> jcreator;
@@ -476,7 +498,9 @@ void Sim::api_job() {
         jobs_perms = jobs_get_permissions(creator, jtype, jstatus);
     }
     // Grant permissions if possible
-    if (is_problem_management_job(jtype) and aux_id) {
+    if ((is_problem_management_job(jtype) or jtype == Job::Type::REJUDGE_PROBLEM_BATCH) and
+        aux_id)
+    {
         jobs_perms |=
             jobs_granted_permissions_problem(intentional_unsafe_string_view(concat(aux_id.value()))
             );
@@ -486,23 +510,17 @@ void Sim::api_job() {
         );
     }
 
-    StringView next_arg = url_args.extract_next_arg();
-    if (next_arg == "cancel") {
-        return api_job_cancel();
-    }
-    if (next_arg == "restart") {
-        return api_job_restart(jtype, jinfo);
-    }
-    if (next_arg == "log") {
-        return api_job_download_log();
-    }
-    if (next_arg == "uploaded-package") {
+    switch (routes::old_route(route_match)) {
+    case routes::Old::API_JOB_CANCEL: return api_job_cancel();
+    case routes::Old::API_JOB_RESTART: return api_job_restart(jtype, jinfo);
+    case routes::Old::API_JOB_LOG: return api_job_download_log();
+    case routes::Old::API_JOB_WAIT_FOR_STATUS_CHANGE: return api_job_wait_for_status_change();
+    case routes::Old::API_JOB_UPLOADED_PACKAGE:
         return api_job_download_uploaded_package(file_id, jtype);
-    }
-    if (next_arg == "uploaded-statement") {
+    case routes::Old::API_JOB_UPLOADED_STATEMENT:
         return api_job_download_uploaded_statement(file_id, jtype, jinfo);
+    default: return api_error404();
     }
-    return api_error400();
 }
 
 void Sim::api_job_cancel() {
@@ -523,6 +541,9 @@ void Sim::api_job_cancel() {
     // Cancel job
     mysql.prepare("UPDATE jobs SET status=? WHERE id=?")
         .bind_and_execute(EnumVal(Job::Status::CANCELED), jobs_jid);
+    sim::status_events::publish(
+        sim::status_events::Kind::JOB, WONT_THROW(str2num<uint64_t>(jobs_jid).value())
+    );
 }
 
 void Sim::api_job_restart(Job::Type job_type, StringView job_info) {
@@ -543,6 +564,30 @@ void Sim::api_job_restart(Job::Type job_type, StringView job_info) {
     sim::jobs::restart_job(mysql, jobs_jid, job_type, job_info, true);
 }
 
+void Sim::api_job_wait_for_status_change() {
+    STACK_UNWINDING_MARK;
+    using PERM = JobPermissions;
+
+    if (uint(~jobs_perms & PERM::VIEW)) {
+        return api_error403();
+    }
+
+    EnumVal<Job::Status> jstatus{};
+    auto stmt = mysql.prepare("SELECT status FROM jobs WHERE id=?");
+    stmt.res_bind_all(jstatus);
+    api_wait_for_status_change(
+        sim::status_events::Kind::JOB,
+        WONT_THROW(str2num<uint64_t>(jobs_jid).value()),
+        [&]() -> uint64_t {
+            stmt.bind_and_execute(jobs_jid);
+            if (not stmt.next()) {
+                return 0; // The job has been deleted
+            }
+            return uint64_t{jstatus.to_int()} + 1;
+        }
+    );
+}
+
 void Sim::api_job_download_log() {
     STACK_UNWINDING_MARK;
     using PERM = JobPermissions;
@@ -556,11 +601,16 @@ void Sim::api_job_download_log() {
     resp.headers["Content-Disposition"] =
         concat_tostr("attachment; filename=job-", jobs_jid, "-log");
 
-    // Fetch the log
-    auto stmt = mysql.prepare("SELECT data FROM jobs WHERE id=?");
+    // Fetch the log part by part (jobs without any log have no rows)
+    resp.content.clear();
+    InplaceBuff<1 << 16> log_part;
+    auto stmt = mysql.prepare("SELECT IF(compressed, UNCOMPRESS(data), data) FROM job_logs "
+                              "WHERE job_id=? ORDER BY pos");
     stmt.bind_and_execute(jobs_jid);
-    stmt.res_bind_all(resp.content);
-    throw_assert(stmt.next());
+    stmt.res_bind_all(log_part);
+    while (stmt.next()) {
+        resp.content.append(log_part);
+    }
 }
 
 void Sim::api_job_download_uploaded_package(std::optional<uint64_t> file_id, Job::Type job_type) {
@@ -1,3 +1,5 @@
+#include "../problems/list_changes.hh"
+#include "../routes.hh"
 #include "sim.hh"
 
 #include <cstdint>
@@ -6,13 +8,12 @@
 #include <sim/problem_tags/problem_tag.hh>
 #include <sim/problems/permissions.hh>
 #include <sim/problems/problem.hh>
+#include <sim/problems/statement_cache.hh>
 #include <simlib/config_file.hh>
 #include <simlib/enum_val.hh>
 #include <simlib/file_info.hh>
 #include <simlib/file_manip.hh>
 #include <simlib/humanize.hh>
-#include <simlib/libzip.hh>
-#include <simlib/sim/problem_package.hh>
 #include <simlib/string_view.hh>
 #include <type_traits>
 
@@ -42,17 +43,17 @@ void Sim::api_problems() {
 
     // We may read data several times (permission checking), so transaction is
     // used to ensure data consistency
-    auto transaction = mysql.start_transaction();
+    auto transaction = start_transaction();
 
     InplaceBuff<512> qfields;
     InplaceBuff<512> qwhere;
     qfields.append("SELECT p.id, p.created_at, p.type, p.name, p.label, p.owner_id, "
-                   "u.username, s.full_status");
+                   "u.username, ups.full_status");
     qwhere.append(
         " FROM problems p LEFT JOIN users u ON p.owner_id=u.id "
-        "LEFT JOIN submissions s ON s.owner=",
+        "LEFT JOIN user_problem_statuses ups ON ups.user_id=",
         (session.has_value() ? intentional_unsafe_string_view(to_string(session->user_id)) : "''"),
-        " AND s.problem_id=p.id AND s.problem_final=1 "
+        " AND ups.problem_id=p.id "
         "WHERE TRUE"
     ); // Needed to easily append constraints
 
@@ -379,15 +380,12 @@ void Sim::api_problem() {
         session.has_value() ? std::optional{session->user_type} : std::nullopt
     );
 
-    StringView next_arg = url_args.extract_next_arg();
-    if (next_arg == "add") {
+    auto route = routes::old_route(route_match);
+    if (route == routes::Old::API_PROBLEM_ADD) {
         return api_problem_add(overall_perms);
     }
-    if (not is_digit(next_arg)) {
-        return api_error400();
-    }
 
-    problems_pid = next_arg;
+    problems_pid = route_capture(0);
 
     mysql::Optional<decltype(Problem::owner_id)::value_type> problem_owner_id;
     decltype(Problem::label) problem_label;
@@ -411,38 +409,31 @@ void Sim::api_problem() {
         problem_type
     );
 
-    next_arg = url_args.extract_next_arg();
-    if (next_arg == "statement") {
+    switch (route) {
+    case routes::Old::API_PROBLEM_STATEMENT:
         return api_problem_statement(problem_label, problem_simfile, problem_perms);
-    }
-    if (next_arg == "download") {
+    case routes::Old::API_PROBLEM_DOWNLOAD:
         return api_problem_download(problem_label, problem_perms);
-    }
-    if (next_arg == "rejudge_all_submissions") {
+    case routes::Old::API_PROBLEM_REJUDGE_ALL_SUBMISSIONS:
         return api_problem_rejudge_all_submissions(problem_perms);
-    }
-    if (next_arg == "reset_time_limits") {
+    case routes::Old::API_PROBLEM_RESET_TIME_LIMITS:
         return api_problem_reset_time_limits(problem_perms);
-    }
-    if (next_arg == "reupload") {
-        return api_problem_reupload(problem_perms);
-    }
-    if (next_arg == "edit") {
-        return api_problem_edit(problem_perms);
-    }
-    if (next_arg == "change_statement") {
+    case routes::Old::API_PROBLEM_REUPLOAD: return api_problem_reupload(problem_perms);
+    case routes::Old::API_PROBLEM_EDIT_TAGS_ADD:
+    case routes::Old::API_PROBLEM_EDIT_TAGS_EDIT:
+    case routes::Old::API_PROBLEM_EDIT_TAGS_DELETE: return api_problem_edit_tags(problem_perms);
+    case routes::Old::API_PROBLEM_EDIT_PARALLEL_JUDGING:
+        return api_problem_edit_parallel_judging(problem_perms);
+    case routes::Old::API_PROBLEM_CHANGE_STATEMENT:
         return api_problem_change_statement(problem_perms);
-    }
-    if (next_arg == "delete") {
-        return api_problem_delete(problem_perms);
-    }
-    if (next_arg == "merge_into_another") {
+    case routes::Old::API_PROBLEM_DELETE: return api_problem_delete(problem_perms);
+    case routes::Old::API_PROBLEM_MERGE_INTO_ANOTHER:
         return api_problem_merge_into_another(problem_perms);
-    }
-    if (next_arg == "attaching_contest_problems") {
+    case routes::Old::API_PROBLEM_ATTACHING_CONTEST_PROBLEMS:
+        parse_route_rest();
         return api_problem_attaching_contest_problems(problem_perms);
+    default: return api_error404();
     }
-    return api_error400();
 }
 
 void Sim::api_problem_add_or_reupload_impl(bool reuploading) {
@@ -523,7 +514,7 @@ void Sim::api_problem_add_or_reupload_impl(bool reuploading) {
         reset_scoring,
         ptype};
 
-    auto transaction = mysql.start_transaction();
+    auto transaction = start_transaction();
     mysql.update("INSERT INTO internal_files VALUES()");
     auto job_file_id = mysql.insert_id();
     FileRemover job_file_remover(sim::internal_files::path_of(job_file_id));
@@ -537,8 +528,8 @@ void Sim::api_problem_add_or_reupload_impl(bool reuploading) {
         (reuploading ? Job::Type::REUPLOAD_PROBLEM : Job::Type::ADD_PROBLEM);
     mysql
         .prepare("INSERT jobs(file_id, creator, priority, type, status, added,"
-                 " aux_id, info, data) "
-                 "VALUES(?, ?, ?, ?, ?, ?, ?, ?, '')")
+                 " aux_id, info) "
+                 "VALUES(?, ?, ?, ?, ?, ?, ?, ?)")
         .bind_and_execute(
             job_file_id,
             session->user_id,
@@ -593,10 +584,25 @@ void Sim::api_statement_impl(
         ::http::quote(intentional_unsafe_string_view(concat(problem_label, ext)))
     );
 
-    // TODO: maybe add some cache system for the statements?
-    ZipFile zip(sim::internal_files::path_of(problem_file_id), ZIP_RDONLY);
-    resp.content =
-        zip.extract_to_str(zip.get_index(concat(sim::zip_package_main_dir(zip), statement)));
+    // Packages are immutable, so the package id identifies the statement
+    auto etag = concat<32>('"', problem_file_id, '"');
+    resp.headers["etag"] = etag;
+    resp.set_cache(false, 0, true);
+    auto if_none_match = request.headers.get("if-none-match");
+    if (if_none_match and *if_none_match == etag) {
+        resp.status_code = "304 Not Modified";
+        return;
+    }
+
+    // Statements are extracted from the packages upon adding / changing the problem, but the
+    // cache may have been cleared since then
+    auto statement_path = sim::internal_files::statement_path_of(problem_file_id);
+    if (not path_exists(statement_path)) {
+        sim::problems::extract_statement_to_cache(problem_file_id, simfile);
+    }
+
+    resp.content_type = http::Response::FILE;
+    resp.content = statement_path;
 }
 
 void Sim::api_problem_statement(
@@ -633,17 +639,16 @@ void Sim::api_problem_rejudge_all_submissions(sim::problems::Permissions perms)
 
     mysql
         .prepare("INSERT jobs (creator, status, priority, type, added, aux_id,"
-                 " info, data) "
-                 "SELECT ?, ?, ?, ?, ?, id, ?, '' "
-                 "FROM submissions WHERE problem_id=? ORDER BY id")
+                 " info) "
+                 "VALUES(?, ?, ?, ?, ?, ?, ?)")
         .bind_and_execute(
             session->user_id,
             EnumVal(Job::Status::PENDING),
-            default_priority(Job::Type::REJUDGE_SUBMISSION),
-            EnumVal(Job::Type::REJUDGE_SUBMISSION),
+            default_priority(Job::Type::REJUDGE_PROBLEM_BATCH),
+            EnumVal(Job::Type::REJUDGE_PROBLEM_BATCH),
             mysql_date(),
-            sim::jobs::dump_string(problems_pid),
-            problems_pid
+            problems_pid,
+            sim::jobs::RejudgeProblemBatchInfo(std::nullopt).dump()
         );
 
     sim::jobs::notify_job_server();
@@ -658,8 +663,8 @@ void Sim::api_problem_reset_time_limits(sim::problems::Permissions perms) {
 
     mysql
         .prepare("INSERT jobs (creator, status, priority, type, added, aux_id,"
-                 " info, data) "
-                 "VALUES(?, ?, ?, ?, ?, ?, '', '')")
+                 " info) "
+                 "VALUES(?, ?, ?, ?, ?, ?, '')")
         .bind_and_execute(
             session->user_id,
             EnumVal(Job::Status::PENDING),
@@ -687,8 +692,8 @@ void Sim::api_problem_delete(sim::problems::Permissions perms) {
     // Queue deleting job
     mysql
         .prepare("INSERT jobs (creator, status, priority, type, added, aux_id,"
-                 " info, data) "
-                 "VALUES(?, ?, ?, ?, ?, ?, '', '')")
+                 " info) "
+                 "VALUES(?, ?, ?, ?, ?, ?, '')")
         .bind_and_execute(
             session->user_id,
             EnumVal(Job::Status::PENDING),
@@ -744,8 +749,8 @@ void Sim::api_problem_merge_into_another(sim::problems::Permissions perms) {
     // Queue merging job
     mysql
         .prepare("INSERT jobs (creator, status, priority, type, added, aux_id,"
-                 " info, data) "
-                 "VALUES(?, ?, ?, ?, ?, ?, ?, '')")
+                 " info) "
+                 "VALUES(?, ?, ?, ?, ?, ?, ?)")
         .bind_and_execute(
             session->user_id,
             EnumVal(Job::Status::PENDING),
@@ -777,15 +782,16 @@ void Sim::api_problem_reupload(sim::problems::Permissions perms) {
     api_problem_add_or_reupload_impl(true);
 }
 
-void Sim::api_problem_edit(sim::problems::Permissions perms) {
+void Sim::api_problem_edit_parallel_judging(sim::problems::Permissions perms) {
     STACK_UNWINDING_MARK;
 
-    StringView next_arg = url_args.extract_next_arg();
-    if (next_arg == "tags") {
-        return api_problem_edit_tags(perms);
+    if (uint(~perms & sim::problems::Permissions::EDIT)) {
+        return api_error403();
     }
 
-    return api_error400();
+    bool enabled = (request.form_fields.get("enabled") == "true");
+    mysql.prepare("UPDATE problems SET parallel_judging=? WHERE id=?")
+        .bind_and_execute(enabled, problems_pid);
 }
 
 void Sim::api_problem_edit_tags(sim::problems::Permissions perms) {
@@ -816,6 +822,7 @@ void Sim::api_problem_edit_tags(sim::problems::Permissions perms) {
         if (stmt.affected_rows() == 0) {
             return api_error400("Tag already exist");
         }
+        problems::note_list_change();
     };
 
     auto edit_tag = [&] {
@@ -843,7 +850,7 @@ void Sim::api_problem_edit_tags(sim::problems::Permissions perms) {
             return;
         }
 
-        auto transaction = mysql.start_transaction();
+        auto transaction = start_transaction();
         auto stmt = mysql.prepare("SELECT 1 FROM problem_tags "
                                   "WHERE name=? AND problem_id=? AND is_hidden=?");
         stmt.bind_and_execute(name, problems_pid, is_hidden);
@@ -859,6 +866,7 @@ void Sim::api_problem_edit_tags(sim::problems::Permissions perms) {
         }
 
         transaction.commit();
+        problems::note_list_change();
     };
 
     auto delete_tag = [&] {
@@ -882,19 +890,15 @@ void Sim::api_problem_edit_tags(sim::problems::Permissions perms) {
             .prepare("DELETE FROM problem_tags "
                      "WHERE problem_id=? AND name=? AND is_hidden=?")
             .bind_and_execute(problems_pid, name, is_hidden);
+        problems::note_list_change();
     };
 
-    StringView next_arg = url_args.extract_next_arg();
-    if (next_arg == "add_tag") {
-        return add_tag();
-    }
-    if (next_arg == "edit_tag") {
-        return edit_tag();
-    }
-    if (next_arg == "delete_tag") {
-        return delete_tag();
+    switch (routes::old_route(route_match)) {
+    case routes::Old::API_PROBLEM_EDIT_TAGS_ADD: return add_tag();
+    case routes::Old::API_PROBLEM_EDIT_TAGS_EDIT: return edit_tag();
+    case routes::Old::API_PROBLEM_EDIT_TAGS_DELETE: return delete_tag();
+    default: return api_error404();
     }
-    return api_error400();
 }
 
 void Sim::api_problem_change_statement(sim::problems::Permissions perms) {
@@ -926,7 +930,7 @@ void Sim::api_problem_change_statement(sim::problems::Permissions perms) {
 
     sim::jobs::ChangeProblemStatementInfo cps_info(statement_path);
 
-    auto transaction = mysql.start_transaction();
+    auto transaction = start_transaction();
     mysql.update("INSERT INTO internal_files VALUES()");
     auto job_file_id = mysql.insert_id();
     FileRemover job_file_remover(sim::internal_files::path_of(job_file_id));
@@ -938,8 +942,8 @@ void Sim::api_problem_change_statement(sim::problems::Permissions perms) {
 
     mysql
         .prepare("INSERT jobs (file_id, creator, status, priority, type,"
-                 " added, aux_id, info, data) "
-                 "VALUES(?, ?, ?, ?, ?, ?, ?, ?, '')")
+                 " added, aux_id, info) "
+                 "VALUES(?, ?, ?, ?, ?, ?, ?, ?)")
         .bind_and_execute(
             job_file_id,
             session->user_id,
@@ -969,7 +973,7 @@ void Sim::api_problem_attaching_contest_problems(sim::problems::Permissions perm
 
     // We may read data several times (permission checking), so transaction is
     // used to ensure data consistency
-    auto transaction = mysql.start_transaction();
+    auto transaction = start_transaction();
 
     InplaceBuff<512> query;
     query.append(
@@ -1,5 +1,6 @@
 #include "../http/request.hh"
 #include "../http/response.hh"
+#include "../routes.hh"
 #include "sim.hh"
 
 #include <memory>
@@ -52,7 +53,9 @@ http::Response Sim::handle(http::Request req) {
             STACK_UNWINDING_MARK;
 
             url_args = RequestUriParser{request.target};
-            StringView next_arg = url_args.extract_next_arg();
+            url_args.extract_next_arg(); // The subsystem
+            route_match = routes::match(request.method, request.target);
+            auto route = routes::old_route(route_match);
 
             // Reset state
             page_template_began = false;
@@ -72,7 +75,7 @@ http::Response Sim::handle(http::Request req) {
                 }
             }
 
-            if (next_arg == "kit") {
+            if (route == routes::Old::KIT) {
                 // Subsystems that do not need the session to be opened
                 static_file();
 
@@ -81,38 +84,22 @@ http::Response Sim::handle(http::Request req) {
                 // work properly
                 session_open();
 
-                if (next_arg == "c") {
-                    contests_handle();
-
-                } else if (next_arg == "s") {
-                    submissions_handle();
-
-                } else if (next_arg == "u") {
-                    users_handle();
-
-                } else if (next_arg == "") {
-                    main_page();
-
-                } else if (next_arg == "api") {
-                    api_handle();
-
-                } else if (next_arg == "p") {
-                    problems_handle();
-
-                } else if (next_arg == "contest_file") {
-                    contest_file_handle();
-
-                } else if (next_arg == "jobs") {
-                    jobs_handle();
-
-                } else if (next_arg == "file") {
-                    file_handle();
-
-                } else if (next_arg == "logs") {
-                    view_logs();
-
-                } else {
-                    error404();
+                switch (route) {
+                case routes::Old::CONTESTS: contests_handle(); break;
+                case routes::Old::SUBMISSIONS: submissions_handle(); break;
+                case routes::Old::USERS: users_handle(); break;
+                case routes::Old::MAIN_PAGE: main_page(); break;
+                case routes::Old::PROBLEMS: problems_handle(); break;
+                case routes::Old::CONTEST_FILE: contest_file_handle(); break;
+                case routes::Old::JOBS: jobs_handle(); break;
+                case routes::Old::FILE: file_handle(); break;
+                case routes::Old::LOGS: view_logs(); break;
+                default:
+                    if (routes::is_old_api(route)) {
+                        api_handle();
+                    } else {
+                        error404();
+                    }
                 }
             }
 
@@ -3,18 +3,23 @@
 #include "../capabilities/contests.hh"
 #include "../http/request.hh"
 #include "../http/response.hh"
+#include "../http/route_trie.hh"
 #include "../web_worker/context.hh"
 #include "../web_worker/web_worker.hh"
 
+#include <functional>
+#include <optional>
 #include <sim/contest_files/permissions.hh>
 #include <sim/contest_rounds/contest_round.hh>
 #include <sim/contests/contest.hh>
+#include <sim/contests/get.hh>
 #include <sim/contests/permissions.hh>
 #include <sim/cpp_syntax_highlighter.hh>
 #include <sim/jobs/job.hh>
 #include <sim/mysql/mysql.hh>
 #include <sim/problems/permissions.hh>
 #include <sim/sessions/session.hh>
+#include <sim/status_events.hh>
 #include <sim/submissions/submission.hh>
 #include <sim/users/user.hh>
 #include <simlib/http/response.hh>
@@ -32,11 +37,58 @@ class Sim final {
     http::Request request;
     http::Response resp;
     RequestUriParser url_args{""};
+    // Route of the request, see routes.hh
+    http::RouteMatch route_match;
     sim::CppSyntaxHighlighter cpp_syntax_highlighter;
     // This is part of the new request handling, but it is kept here so that we can integrate
     // it with the old request handling
     std::unique_ptr<web_worker::WebWorker> web_worker;
 
+    // Set while handling the requests of a batch (see api_batch())
+    bool in_batch = false;
+    // submissions_display_cache generation taken before the transaction of the batch
+    uint64_t batch_display_cache_generation = 0;
+
+    // In a batch all the requests are handled in the transaction of the batch, so the
+    // transactions of the handlers do nothing
+    class Transaction {
+        std::optional<mysql::Transaction> transaction_;
+
+    public:
+        explicit Transaction(std::optional<mysql::Transaction> transaction) noexcept
+        : transaction_(std::move(transaction)) {}
+
+        void commit() {
+            if (transaction_) {
+                transaction_->commit();
+            }
+        }
+
+        void rollback() {
+            if (transaction_) {
+                transaction_->rollback();
+            }
+        }
+    };
+
+    Transaction start_transaction() {
+        if (in_batch) {
+            return Transaction{std::nullopt};
+        }
+        return Transaction{mysql.start_transaction()};
+    }
+
+    // Returns the @p i-th capture of route_match
+    StringView route_capture(size_t i) const noexcept {
+        auto str = route_match.captures[i].str;
+        return {str.data(), str.size()};
+    }
+
+    // Makes url_args parse the part of the path matched by the "/**" of route_match
+    void parse_route_rest() {
+        url_args = RequestUriParser{StringView{route_match.rest.data(), route_match.rest.size()}};
+    }
+
     /**
      * @brief Sets headers to make a redirection
      * @details Does not clear response headers and contents
@@ -87,8 +139,26 @@ class Sim final {
     // api.cc
     void api_handle();
 
+    // Handles the read-only API requests with targets from the "targets" form field (one per
+    // line) in a single transaction, responds with their statuses and bodies
+    void api_batch();
+
     void api_logs();
 
+    // Responds with the chunk of the log preceding the offset from the query (the newest one if
+    // not specified)
+    void api_logs_before(CStringView filename);
+
+    // Long polling: responds with the data appended to the log after the offset from the next url
+    // argument, as soon as it appears or after a timeout
+    void api_logs_tail(CStringView filename);
+
+    // Long polling: responds when the status read using @p read_status differs from the one
+    // identified by the token from the next url argument or after a timeout
+    void api_wait_for_status_change(
+        sim::status_events::Kind kind, uint64_t id, const std::function<uint64_t()>& read_status
+    );
+
     // jobs_api.cc
     void api_jobs();
 
@@ -100,6 +170,8 @@ class Sim final {
 
     void api_job_download_log();
 
+    void api_job_wait_for_status_change();
+
     void api_job_download_uploaded_package(
         std::optional<uint64_t> file_id, sim::jobs::Job::Type job_type
     );
@@ -131,10 +203,10 @@ class Sim final {
 
     void api_problem_reupload(sim::problems::Permissions perms);
 
-    void api_problem_edit(sim::problems::Permissions perms);
-
     void api_problem_edit_tags(sim::problems::Permissions perms);
 
+    void api_problem_edit_parallel_judging(sim::problems::Permissions perms);
+
     void api_problem_delete(sim::problems::Permissions perms);
 
     void api_problem_merge_into_another(sim::problems::Permissions perms);
@@ -166,6 +238,8 @@ class Sim final {
 
     void api_submission_download();
 
+    void api_submission_wait_for_status_change();
+
     // contests_api.cc
     void api_contests();
 
@@ -220,6 +294,15 @@ class Sim final {
         StringView query_id
     );
 
+    // Server-side aggregated and sorted variant of api_contest_ranking() that
+    // returns one page of the ranking (selected by offset, keyset or the
+    // session user's neighbourhood)
+    void api_contest_ranking_rows(
+        sim::contests::Permissions perms,
+        StringView submissions_query_id_name,
+        StringView query_id
+    );
+
     // contest_users_api.cc
 
     void api_contest_users();
@@ -563,6 +646,14 @@ private:
 
     void contests_contest_problem(StringView contest_problem_id);
 
+    // Returns the session user's permissions to the contest @p contest_id or std::nullopt if
+    // the contest does not exist. Uses contest_permissions_cache.
+    std::optional<sim::contests::Permissions> contests_get_permissions(StringView contest_id);
+
+    // sim::contests::get() for the session user that also fills contest_permissions_cache
+    std::optional<std::pair<sim::contests::Contest, sim::contests::Permissions>>
+    contests_get(sim::contests::GetIdKind id_kind, StringView id, CStringView curr_date);
+
     /* =========================== Contest users =========================== */
 public:
     enum class ContestUserPermissions : uint {
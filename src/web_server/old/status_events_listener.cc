@@ -0,0 +1,145 @@
+#include "../contest_permissions_cache.hh"
+#include "../problems/list_changes.hh"
+#include "../submissions_display_cache.hh"
+#include "status_events_listener.hh"
+
+#include <cerrno>
+#include <cstring>
+#include <simlib/debug.hh>
+#include <simlib/logger.hh>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+namespace web_server::old {
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+StatusEventsListener status_events_listener;
+
+StatusEventsListener::Subscription::~Subscription() {
+    if (listener_ == nullptr) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(listener_->mtx_);
+    --listener_->subscribers_;
+    if (--entry_->second.subscribers == 0) {
+        listener_->entries_.erase(entry_);
+    }
+}
+
+bool StatusEventsListener::Subscription::wait_until(std::chrono::steady_clock::time_point deadline
+) {
+    std::unique_lock<std::mutex> lock(listener_->mtx_);
+    auto& entry = entry_->second;
+    bool notified = entry.cv.wait_until(lock, deadline, [&] {
+        return entry.events != seen_events_;
+    });
+    seen_events_ = entry.events;
+    return notified;
+}
+
+void StatusEventsListener::start(size_t max_subscribers) noexcept {
+    max_subscribers_ = max_subscribers; // 0 disables long polling, but not the other events
+
+    int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        errlog("Status events: socket()", errmsg());
+        return;
+    }
+
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    constexpr auto path = sim::status_events::socket_path;
+    static_assert(path.size() < sizeof(addr.sun_path));
+    std::memcpy(addr.sun_path, path.data(), path.size() + 1);
+
+    (void)unlink(path.data()); // Left by the previous instance
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr))) {
+        errlog("Status events: bind()", errmsg());
+        (void)close(fd);
+        return;
+    }
+
+    listening_ = true;
+    std::thread([this, fd] { listen(fd); }).detach();
+}
+
+std::optional<StatusEventsListener::Subscription>
+StatusEventsListener::subscribe(sim::status_events::Kind kind, uint64_t id) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (not listening_ or subscribers_ >= max_subscribers_) {
+        return std::nullopt;
+    }
+
+    ++subscribers_;
+    auto it = entries_.try_emplace(Key{kind, id}).first;
+    ++it->second.subscribers;
+    return Subscription{this, it};
+}
+
+bool StatusEventsListener::try_reserve_waiter() noexcept {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (subscribers_ >= max_subscribers_) {
+        return false;
+    }
+
+    ++subscribers_;
+    return true;
+}
+
+void StatusEventsListener::release_waiter() noexcept {
+    std::lock_guard<std::mutex> lock(mtx_);
+    --subscribers_;
+}
+
+void StatusEventsListener::listen(int fd) noexcept {
+    char buff[32];
+    for (;;) {
+        auto len = recv(fd, buff, sizeof(buff), 0);
+        if (len == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            errlog("Status events: recv()", errmsg());
+            std::lock_guard<std::mutex> lock(mtx_);
+            listening_ = false; // Waiters will time out
+            return;
+        }
+
+        auto event = sim::status_events::parse(StringView{buff, static_cast<size_t>(len)});
+        if (not event) {
+            continue;
+        }
+        switch (event->first) {
+        case sim::status_events::Kind::SUBMISSION:
+        case sim::status_events::Kind::JOB: break;
+        case sim::status_events::Kind::USER: {
+            contest_permissions_cache.invalidate_user(event->second);
+            submissions_display_cache.invalidate(
+                SubmissionsDisplayCache::Entity::USER, event->second
+            );
+            problems::note_list_change(); // The user might have owned some problems
+            continue;
+        }
+        case sim::status_events::Kind::PROBLEM: {
+            submissions_display_cache.invalidate(
+                SubmissionsDisplayCache::Entity::PROBLEM, event->second
+            );
+            problems::note_list_change();
+            continue;
+        }
+        }
+
+        std::lock_guard<std::mutex> lock(mtx_);
+        auto it = entries_.find(*event);
+        if (it != entries_.end()) {
+            ++it->second.events;
+            it->second.cv.notify_all();
+        }
+    }
+}
+
+} // namespace web_server::old
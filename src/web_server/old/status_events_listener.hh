@@ -0,0 +1,95 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <sim/status_events.hh>
+#include <utility>
+
+namespace web_server::old {
+
+// Receives sim::status_events notifications (sent by the job server) and wakes up workers that
+// wait for a change of the status of a particular submission / job (long polling). Workers are
+// blocked while waiting, so the number of simultaneous waiters is limited. Notifications about
+// users and problems invalidate the affected caches and validators.
+class StatusEventsListener {
+    struct Entry {
+        size_t subscribers = 0;
+        uint64_t events = 0;
+        std::condition_variable cv;
+    };
+
+    using Key = std::pair<sim::status_events::Kind, uint64_t>;
+
+    std::mutex mtx_;
+    bool listening_ = false;
+    size_t max_subscribers_ = 0;
+    size_t subscribers_ = 0;
+    std::map<Key, Entry> entries_;
+
+public:
+    class Subscription {
+        StatusEventsListener* listener_;
+        std::map<Key, Entry>::iterator entry_;
+        uint64_t seen_events_;
+
+        friend class StatusEventsListener;
+
+        Subscription(
+            StatusEventsListener* listener, std::map<Key, Entry>::iterator entry
+        ) noexcept
+        : listener_(listener)
+        , entry_(entry)
+        , seen_events_(entry->second.events) {}
+
+    public:
+        Subscription(const Subscription&) = delete;
+        Subscription(Subscription&& other) noexcept
+        : listener_(std::exchange(other.listener_, nullptr))
+        , entry_(other.entry_)
+        , seen_events_(other.seen_events_) {}
+        Subscription& operator=(const Subscription&) = delete;
+        Subscription& operator=(Subscription&&) = delete;
+
+        ~Subscription();
+
+        // Returns true if a notification arrived since the subscription or the previous call,
+        // false if @p deadline has been reached
+        bool wait_until(std::chrono::steady_clock::time_point deadline);
+    };
+
+    StatusEventsListener() = default;
+
+    StatusEventsListener(const StatusEventsListener&) = delete;
+    StatusEventsListener(StatusEventsListener&&) = delete;
+    StatusEventsListener& operator=(const StatusEventsListener&) = delete;
+    StatusEventsListener& operator=(StatusEventsListener&&) = delete;
+    ~StatusEventsListener() = default;
+
+    // Binds sim::status_events::socket_path and starts the listening thread. Not thread-safe,
+    // should be called before the workers start. Failures are logged and disable long polling.
+    // @p max_subscribers == 0 disables long polling only.
+    void start(size_t max_subscribers) noexcept;
+
+    // Returns std::nullopt if long polling is disabled or there are already too many waiters.
+    // Subscribe before reading the status, so that no change is missed.
+    std::optional<Subscription> subscribe(sim::status_events::Kind kind, uint64_t id);
+
+    // Reserves a place among the waiters for waiting on something else than a status event
+    // (e.g. a log file). Returns false if there are already too many waiters. Every successful
+    // reservation has to be followed by release_waiter().
+    bool try_reserve_waiter() noexcept;
+
+    void release_waiter() noexcept;
+
+private:
+    void listen(int fd) noexcept;
+};
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+extern StatusEventsListener status_events_listener;
+
+} // namespace web_server::old
@@ -1,6 +1,11 @@
+#include "../routes.hh"
+#include "../submissions_display_cache.hh"
+#include "highlighted_sources_cache.hh"
 #include "sim.hh"
 
+#include <array>
 #include <functional>
+#include <map>
 #include <optional>
 #include <sim/contest_problems/contest_problem.hh>
 #include <sim/contests/contest.hh>
@@ -16,6 +21,7 @@
 #include <simlib/humanize.hh>
 #include <simlib/process.hh>
 #include <simlib/string_view.hh>
+#include <vector>
 
 using sim::InfDatetime;
 using sim::contest_problems::ContestProblem;
@@ -66,64 +72,58 @@ void Sim::api_submissions() {
         return api_error403();
     }
 
+    // Columns read in the transaction are cached only if no invalidation happened since, so the
+    // generation has to be taken before the transaction's snapshot. In a batch the transaction
+    // has already been started by api_batch(), so its generation is used.
+    auto display_cache_generation =
+        in_batch ? batch_display_cache_generation : submissions_display_cache.generation();
+
     // We may read data several times (permission checking), so transaction is
     // used to ensure data consistency
-    auto transaction = mysql.start_transaction();
+    auto transaction = start_transaction();
 
     InplaceBuff<512> qfields;
     InplaceBuff<512> qwhere;
-    qfields.append("SELECT s.id, s.type, s.language, s.owner, cu.mode, p.owner_id,"
-                   " u.username, u.first_name, u.last_name, s.problem_id,"
-                   " p.name, s.contest_problem_id, cp.name,"
-                   " cp.method_of_choosing_final_submission, cp.score_revealing,"
-                   " s.contest_round_id, r.name, r.full_results, r.ends,"
-                   " s.contest_id, c.name, s.submit_time, s.problem_final,"
-                   " s.contest_final, s.contest_initial_final,"
-                   " s.initial_status, s.full_status, s.score");
-    qwhere.append(
-        " FROM submissions s "
-        "LEFT JOIN users u ON u.id=s.owner "
-        "STRAIGHT_JOIN problems p ON p.id=s.problem_id "
-        "LEFT JOIN contest_problems cp ON cp.id=s.contest_problem_id "
-        "LEFT JOIN contest_rounds r ON r.id=s.contest_round_id "
-        "LEFT JOIN contests c ON c.id=s.contest_id "
-        "LEFT JOIN contest_users cu ON cu.contest_id=s.contest_id"
-        " AND cu.user_id=",
-        session->user_id,
-        " WHERE TRUE"
-    ); // Needed to easily append constraints
-
-    enum ColumnIdx {
+    // Only the submissions table is queried, so that the query is a single index range scan;
+    // columns of the other tables are filled in from the submissions_display_cache
+    qfields.append("SELECT s.id, s.type, s.language, s.owner, s.problem_id,"
+                   " s.contest_problem_id, s.contest_round_id, s.contest_id,"
+                   " s.submit_time, s.problem_final, s.contest_final,"
+                   " s.contest_initial_final, s.initial_status, s.full_status, s.score");
+    qwhere.append(" FROM submissions s WHERE TRUE"); // Needed to easily append constraints
+
+    enum ColumnIdx : size_t {
         SID,
         STYPE,
         SLANGUAGE,
         SOWNER,
+        PROB_ID,
+        CPID,
+        CRID,
+        CID,
+        SUBMIT_TIME,
+        PFINAL,
+        CFINAL,
+        CINIFINAL,
+        INITIAL_STATUS,
+        FINAL_STATUS,
+        SCORE,
+        // Not selected from the submissions table
         CUMODE,
         POWNER_ID,
         SOWN_USERNAME,
         SOWN_FNAME,
         SOWN_LNAME,
-        PROB_ID,
         PNAME,
-        CPID,
         CP_NAME,
-        CP_FSM,
         SCORE_REVEALING,
-        CRID,
         CR_NAME,
         FULL_RES,
         CRENDS,
-        CID,
         CNAME,
-        SUBMIT_TIME,
-        PFINAL,
-        CFINAL,
-        CINIFINAL,
-        INITIAL_STATUS,
-        FINAL_STATUS,
-        SCORE,
         INIT_REPORT,
-        FINAL_REPORT
+        FINAL_REPORT,
+        COLUMNS_NUM
     };
 
     bool allow_access = (session->user_type == User::Type::ADMIN);
@@ -269,7 +269,6 @@ void Sim::api_submissions() {
                 select_one = true;
                 allow_access = true; // Permissions will be checked while fetching the data
 
-                qfields.append(", s.initial_report, s.final_report");
                 qwhere.append(" AND s.id", arg);
 
             } else if (cond_c == 'p') { // Problem's id
@@ -326,52 +325,52 @@ void Sim::api_submissions() {
                 }
 
                 if (not allow_access) {
-                    StringView query;
-                    switch (cond_c) {
-                    case 'C':
-                        query = "SELECT cu.mode, c.is_public "
-                                "FROM contests c "
-                                "LEFT JOIN contest_users cu ON cu.user_id=?"
-                                " AND cu.contest_id=c.id "
-                                "WHERE c.id=?";
-                        break;
-
-                    case 'R':
-                        query = "SELECT cu.mode, c.is_public "
-                                "FROM contest_rounds r "
-                                "LEFT JOIN contests c ON c.id=r.contest_id "
-                                "LEFT JOIN contest_users cu"
-                                " ON cu.contest_id=r.contest_id"
-                                " AND cu.user_id=? "
-                                "WHERE r.id=?";
-                        break;
+                    if (cond_c == 'C') {
+                        contest_perms = contests_get_permissions(arg_id);
+                        if (not contest_perms) {
+                            return set_empty_response();
+                        }
+                    } else {
+                        StringView query;
+                        switch (cond_c) {
+                        case 'R':
+                            query = "SELECT cu.mode, c.is_public "
+                                    "FROM contest_rounds r "
+                                    "LEFT JOIN contests c ON c.id=r.contest_id "
+                                    "LEFT JOIN contest_users cu"
+                                    " ON cu.contest_id=r.contest_id"
+                                    " AND cu.user_id=? "
+                                    "WHERE r.id=?";
+                            break;
+
+                        case 'P':
+                            query = "SELECT cu.mode, c.is_public "
+                                    "FROM contest_problems p "
+                                    "LEFT JOIN contests c ON c.id=p.contest_id "
+                                    "LEFT JOIN contest_users cu"
+                                    " ON cu.contest_id=p.contest_id"
+                                    " AND cu.user_id=? "
+                                    "WHERE p.id=?";
+                            break;
+                        default: assert(false);
+                        }
+                        auto stmt = mysql.prepare(query);
+                        stmt.bind_and_execute(session->user_id, arg_id);
+
+                        mysql::Optional<decltype(ContestUser::mode)> cu_mode;
+                        uint8_t is_public = false;
+                        stmt.res_bind_all(cu_mode, is_public);
+                        if (not stmt.next()) {
+                            return set_empty_response();
+                        }
 
-                    case 'P':
-                        query = "SELECT cu.mode, c.is_public "
-                                "FROM contest_problems p "
-                                "LEFT JOIN contests c ON c.id=p.contest_id "
-                                "LEFT JOIN contest_users cu"
-                                " ON cu.contest_id=p.contest_id"
-                                " AND cu.user_id=? "
-                                "WHERE p.id=?";
-                        break;
-                    default: assert(false);
-                    }
-                    auto stmt = mysql.prepare(query);
-                    stmt.bind_and_execute(session->user_id, arg_id);
-
-                    mysql::Optional<decltype(ContestUser::mode)> cu_mode;
-                    uint8_t is_public = false;
-                    stmt.res_bind_all(cu_mode, is_public);
-                    if (not stmt.next()) {
-                        return set_empty_response();
+                        contest_perms = sim::contests::get_permissions(
+                            (session.has_value() ? std::optional{session->user_type}
+                                                 : std::nullopt),
+                            is_public,
+                            cu_mode
+                        );
                     }
-
-                    contest_perms = sim::contests::get_permissions(
-                        (session.has_value() ? std::optional{session->user_type} : std::nullopt),
-                        is_public,
-                        cu_mode
-                    );
                     if (uint(
                             contest_perms.value() &
                             sim::contests::Permissions::VIEW_ALL_CONTEST_SUBMISSIONS
@@ -423,35 +422,177 @@ void Sim::api_submissions() {
     }
 
     // Execute query
-    auto res = mysql.query(intentional_unsafe_string_view(
-        concat(qfields, qwhere, " ORDER BY s.id DESC LIMIT ", rows_limit)
-    ));
+    std::vector<std::array<optional<string>, COLUMNS_NUM>> rows;
+    {
+        auto res = mysql.query(intentional_unsafe_string_view(
+            concat(qfields, qwhere, " ORDER BY s.id DESC LIMIT ", rows_limit)
+        ));
+        while (res.next()) {
+            auto& row = rows.emplace_back();
+            for (size_t i = 0; i < CUMODE; ++i) {
+                if (not res.is_null(i)) {
+                    row[i] = res[i].to_string();
+                }
+            }
+        }
+    }
+
+    // Fills the @p dest_cols of the rows with the columns (selected by @p select_from after the
+    // id) of the entities identified by the @p id_col
+    auto fill_columns = [&](SubmissionsDisplayCache::Entity entity,
+                            ColumnIdx id_col,
+                            std::initializer_list<ColumnIdx> dest_cols,
+                            StringView select_from) {
+        std::map<uint64_t, optional<SubmissionsDisplayCache::Columns>> entities;
+        InplaceBuff<512> missing_ids;
+        for (const auto& row : rows) {
+            if (not row[id_col]) {
+                continue;
+            }
+            auto id = WONT_THROW(str2num<uint64_t>(*row[id_col]).value());
+            auto [it, inserted] = entities.try_emplace(id);
+            if (not inserted) {
+                continue;
+            }
+            it->second = submissions_display_cache.find(entity, id);
+            if (not it->second) {
+                missing_ids.append(missing_ids.size == 0 ? "" : ",", id);
+            }
+        }
+
+        if (missing_ids.size > 0) {
+            auto res = mysql.query(intentional_unsafe_string_view(
+                concat(select_from, " WHERE id IN (", missing_ids, ')')
+            ));
+            while (res.next()) {
+                SubmissionsDisplayCache::Columns columns(dest_cols.size());
+                for (size_t i = 0; i < columns.size(); ++i) {
+                    if (not res.is_null(i + 1)) {
+                        columns[i] = res[i + 1].to_string();
+                    }
+                }
+                auto id = WONT_THROW(str2num<uint64_t>(res[0]).value());
+                submissions_display_cache.insert(entity, id, columns, display_cache_generation);
+                entities[id] = std::move(columns);
+            }
+        }
+
+        for (auto& row : rows) {
+            if (not row[id_col]) {
+                continue;
+            }
+            const auto& columns =
+                entities[WONT_THROW(str2num<uint64_t>(*row[id_col]).value())];
+            if (not columns) {
+                continue; // The entity has just been deleted
+            }
+            size_t i = 0;
+            for (auto dest_col : dest_cols) {
+                row[dest_col] = (*columns)[i++];
+            }
+        }
+    };
+
+    using Entity = SubmissionsDisplayCache::Entity;
+    fill_columns(
+        Entity::USER,
+        SOWNER,
+        {SOWN_USERNAME, SOWN_FNAME, SOWN_LNAME},
+        "SELECT id, username, first_name, last_name FROM users"
+    );
+    fill_columns(
+        Entity::PROBLEM, PROB_ID, {PNAME, POWNER_ID}, "SELECT id, name, owner_id FROM problems"
+    );
+    fill_columns(
+        Entity::CONTEST_PROBLEM,
+        CPID,
+        {CP_NAME, SCORE_REVEALING},
+        "SELECT id, name, score_revealing FROM contest_problems"
+    );
+    fill_columns(
+        Entity::CONTEST_ROUND,
+        CRID,
+        {CR_NAME, FULL_RES, CRENDS},
+        "SELECT id, name, full_results, ends FROM contest_rounds"
+    );
+    fill_columns(Entity::CONTEST, CID, {CNAME}, "SELECT id, name FROM contests");
+
+    // Contest user modes depend on the session user, so they are not cached
+    {
+        InplaceBuff<512> contest_ids;
+        for (const auto& row : rows) {
+            if (row[CID]) {
+                contest_ids.append(contest_ids.size == 0 ? "" : ",", *row[CID]);
+            }
+        }
+        if (contest_ids.size > 0) {
+            std::map<string, string, std::less<>> modes;
+            auto res = mysql.query(intentional_unsafe_string_view(concat(
+                "SELECT contest_id, mode FROM contest_users WHERE user_id=",
+                session->user_id,
+                " AND contest_id IN (",
+                contest_ids,
+                ')'
+            )));
+            while (res.next()) {
+                modes.emplace(res[0].to_string(), res[1].to_string());
+            }
+            for (auto& row : rows) {
+                if (row[CID]) {
+                    auto it = modes.find(*row[CID]);
+                    if (it != modes.end()) {
+                        row[CUMODE] = it->second;
+                    }
+                }
+            }
+        }
+    }
+
+    // Reports are kept apart from the submissions (a submission that was not judged yet has none)
+    if (select_one) {
+        for (auto& row : rows) {
+            row[INIT_REPORT].emplace();
+            row[FINAL_REPORT].emplace();
+            auto res = mysql.query(intentional_unsafe_string_view(concat(
+                "SELECT initial_report, final_report FROM submission_reports "
+                "WHERE submission_id=",
+                *row[SID]
+            )));
+            if (res.next()) {
+                row[INIT_REPORT] = res[0].to_string();
+                row[FINAL_REPORT] = res[1].to_string();
+            }
+        }
+    }
 
     append_column_names();
 
     auto curr_date = mysql_date();
-    while (res.next()) {
+    for (const auto& row : rows) {
+        auto is_null = [&](ColumnIdx idx) { return not row[idx].has_value(); };
+        auto col = [&](ColumnIdx idx) { return StringView{*row[idx]}; };
+
         EnumVal<Submission::Type> stype{
-            WONT_THROW(str2num<Submission::Type::UnderlyingType>(res[STYPE]).value())};
+            WONT_THROW(str2num<Submission::Type::UnderlyingType>(col(STYPE)).value())};
         SubmissionPermissions perms = submissions_get_permissions(
-            (res.is_null(SOWNER)
+            (is_null(SOWNER)
                  ? std::nullopt
                  : optional<decltype(sim::submissions::Submission::owner)::value_type>{WONT_THROW(
                        str2num<decltype(sim::submissions::Submission::owner)::value_type>(
-                           res[SOWNER]
+                           col(SOWNER)
                        )
                            .value()
                    )}),
             stype,
-            (res.is_null(CUMODE)
+            (is_null(CUMODE)
                  ? std::nullopt
                  : std::optional{decltype(ContestUser::mode
-                   ){WONT_THROW(str2num<decltype(ContestUser::mode)::ValType>(res[CUMODE]).value()
+                   ){WONT_THROW(str2num<decltype(ContestUser::mode)::ValType>(col(CUMODE)).value()
                    )}}),
-            (res.is_null(POWNER_ID)
+            (is_null(POWNER_ID)
                  ? std::nullopt
                  : optional<decltype(Problem::owner_id)::value_type>{WONT_THROW(
-                       str2num<decltype(Problem::owner_id)::value_type>(res[POWNER_ID]).value()
+                       str2num<decltype(Problem::owner_id)::value_type>(col(POWNER_ID)).value()
                    )})
         );
 
@@ -459,33 +600,33 @@ void Sim::api_submissions() {
             return set_empty_response();
         }
 
-        bool contest_submission = not res.is_null(CID);
+        bool contest_submission = not is_null(CID);
 
         InfDatetime full_results;
         if (not contest_submission) { // The submission is not in a contest, so
             // full results are visible immediately
             full_results.set_neg_inf();
         } else {
-            full_results.from_str(res[FULL_RES]);
+            full_results.from_str(col(FULL_RES));
         }
 
         bool show_full_results =
             (bool(uint(perms & PERM::VIEW_FINAL_REPORT)) or full_results <= curr_date);
         auto is_problem_final =
-            WONT_THROW(str2num<decltype(Submission::problem_final)::int_type>(res[PFINAL]).value());
+            WONT_THROW(str2num<decltype(Submission::problem_final)::int_type>(col(PFINAL)).value());
         auto is_contest_final =
-            WONT_THROW(str2num<decltype(Submission::contest_final)::int_type>(res[CFINAL]).value());
+            WONT_THROW(str2num<decltype(Submission::contest_final)::int_type>(col(CFINAL)).value());
         auto is_contest_initial_final = WONT_THROW(
-            str2num<decltype(Submission::contest_initial_final)::int_type>(res[CINIFINAL]).value()
+            str2num<decltype(Submission::contest_initial_final)::int_type>(col(CINIFINAL)).value()
         );
 
         // Submission id
-        append(",\n[", res[SID], ',');
+        append(",\n[", col(SID), ',');
 
         optional<decltype(ContestProblem::score_revealing)> score_revealing;
-        if (not res.is_null(SCORE_REVEALING)) {
+        if (not is_null(SCORE_REVEALING)) {
             score_revealing.emplace(WONT_THROW(
-                str2num<decltype(ContestProblem::score_revealing)::ValType>(res[SCORE_REVEALING])
+                str2num<decltype(ContestProblem::score_revealing)::ValType>(col(SCORE_REVEALING))
                     .value()
             ));
         }
@@ -566,69 +707,69 @@ void Sim::api_submissions() {
         append(
             '"',
             to_string(Submission::Language(
-                WONT_THROW(str2num<decltype(Submission::language)::ValType>(res[SLANGUAGE]).value())
+                WONT_THROW(str2num<decltype(Submission::language)::ValType>(col(SLANGUAGE)).value())
             )),
             "\","
         );
 
         // Onwer's id
-        if (res.is_null(SOWNER)) {
+        if (is_null(SOWNER)) {
             append("null,");
         } else {
-            append(res[SOWNER], ',');
+            append(col(SOWNER), ',');
         }
 
         // Onwer's username
-        if (res.is_null(SOWN_USERNAME)) {
+        if (is_null(SOWN_USERNAME)) {
             append("null,");
         } else {
-            append("\"", res[SOWN_USERNAME], "\",");
+            append("\"", col(SOWN_USERNAME), "\",");
         }
 
         // Onwer's first name
-        if (res.is_null(SOWN_FNAME)) {
+        if (is_null(SOWN_FNAME)) {
             append("null,");
         } else {
-            append(json_stringify(res[SOWN_FNAME]), ',');
+            append(json_stringify(col(SOWN_FNAME)), ',');
         }
 
         // Onwer's last name
-        if (res.is_null(SOWN_LNAME)) {
+        if (is_null(SOWN_LNAME)) {
             append("null,");
         } else {
-            append(json_stringify(res[SOWN_LNAME]), ',');
+            append(json_stringify(col(SOWN_LNAME)), ',');
         }
 
         // Problem (id, name)
-        if (res.is_null(PNAME)) {
+        if (is_null(PNAME)) {
             append("null,null,");
         } else {
-            append(res[PROB_ID], ',', json_stringify(res[PNAME]), ',');
+            append(col(PROB_ID), ',', json_stringify(col(PNAME)), ',');
         }
 
         // Contest problem (id, name)
-        if (res.is_null(CP_NAME)) {
+        if (is_null(CP_NAME)) {
             append("null,null,");
         } else {
-            append(res[CPID], ',', json_stringify(res[CP_NAME]), ',');
+            append(col(CPID), ',', json_stringify(col(CP_NAME)), ',');
         }
 
         // Contest round (id, name)
-        if (res.is_null(CR_NAME)) {
+        if (is_null(CR_NAME)) {
             append("null,null,");
         } else {
-            append(res[CRID], ',', json_stringify(res[CR_NAME]), ',');
+            append(col(CRID), ',', json_stringify(col(CR_NAME)), ',');
         }
 
         // Contest (id, name)
-        if (res.is_null(CNAME)) {
+        if (is_null(CNAME)) {
             append("null,null,");
         } else {
-            append(res[CID], ',', json_stringify(res[CNAME]), ',');
+            append(col(CID), ',', json_stringify(col(CNAME)), ',');
         }
 
         // Submit time
-        append("\"", res[SUBMIT_TIME], "\",");
+        append("\"", col(SUBMIT_TIME), "\",");
 
         bool show_full_status = (show_full_results or [&] {
             if (score_revealing) {
@@ -657,17 +798,17 @@ void Sim::api_submissions() {
         // Status: (CSS class, text)
         append_submission_status(
             decltype(Submission::initial_status)(WONT_THROW(
-                str2num<decltype(Submission::initial_status)::ValType>(res[INITIAL_STATUS]).value()
+                str2num<decltype(Submission::initial_status)::ValType>(col(INITIAL_STATUS)).value()
             )),
             decltype(Submission::full_status)(WONT_THROW(
-                str2num<decltype(Submission::full_status)::ValType>(res[FINAL_STATUS]).value()
+                str2num<decltype(Submission::full_status)::ValType>(col(FINAL_STATUS)).value()
             )),
             show_full_status
         );
 
         // Score
-        if (not res.is_null(SCORE) and show_score) {
-            append(',', res[SCORE], ',');
+        if (not is_null(SCORE) and show_score) {
+            append(',', col(SCORE), ',');
         } else {
             append(",null,");
         }
@@ -684,7 +825,7 @@ void Sim::api_submissions() {
             append('j');
         }
         if (uint(perms & PERM::VIEW) and
-            (res.is_null(CRENDS) or curr_date < InfDatetime(res[CRENDS])))
+            (is_null(CRENDS) or curr_date < InfDatetime(col(CRENDS))))
         {
             //  ^ submission to a problem;    ^ Round has not ended
             // TODO: implement it in some way in the UI
@@ -705,9 +846,9 @@ void Sim::api_submissions() {
         // Append
         if (select_one) {
             // Reports (and round full results time if full report isn't shown)
-            append(',', json_stringify(res[INIT_REPORT]));
+            append(',', json_stringify(col(INIT_REPORT)));
             if (show_full_results) {
-                append(',', json_stringify(res[FINAL_REPORT]));
+                append(',', json_stringify(col(FINAL_REPORT)));
             } else {
                 append(",null,\"", full_results.to_api_str(), '"');
             }
@@ -726,15 +867,13 @@ void Sim::api_submission() {
         return api_error403();
     }
 
-    StringView next_arg = url_args.extract_next_arg();
-    if (next_arg == "add") {
+    auto route = routes::old_route(route_match);
+    if (route == routes::Old::API_SUBMISSION_ADD) {
+        parse_route_rest();
         return api_submission_add();
     }
-    if (not is_digit(next_arg)) {
-        return api_error400();
-    }
 
-    submissions_sid = next_arg;
+    submissions_sid = route_capture(0);
 
     mysql::Optional<decltype(Submission::owner)::value_type> sowner;
     mysql::Optional<decltype(Problem::owner_id)::value_type> p_owner_id;
@@ -758,12 +897,12 @@ void Sim::api_submission() {
     submissions_perms = submissions_get_permissions(sowner, stype, cu_mode, p_owner_id);
 
     // Subpages
-    next_arg = url_args.extract_next_arg();
-    if (next_arg == "source") {
-        return api_submission_source();
-    }
-    if (next_arg == "download") {
-        return api_submission_download();
+    switch (route) {
+    case routes::Old::API_SUBMISSION_SOURCE: return api_submission_source();
+    case routes::Old::API_SUBMISSION_DOWNLOAD: return api_submission_download();
+    case routes::Old::API_SUBMISSION_WAIT_FOR_STATUS_CHANGE:
+        return api_submission_wait_for_status_change();
+    default: break;
     }
 
     if (request.method != http::Request::POST) {
@@ -771,17 +910,12 @@ void Sim::api_submission() {
     }
 
     // Subpages causing action
-    if (next_arg == "rejudge") {
-        return api_submission_rejudge();
-    }
-    if (next_arg == "chtype") {
-        return api_submission_change_type();
+    switch (route) {
+    case routes::Old::API_SUBMISSION_REJUDGE: return api_submission_rejudge();
+    case routes::Old::API_SUBMISSION_CHANGE_TYPE: return api_submission_change_type();
+    case routes::Old::API_SUBMISSION_DELETE: return api_submission_delete();
+    default: return api_error404();
     }
-    if (next_arg == "delete") {
-        return api_submission_delete();
-    }
-
-    return api_error404();
 }
 
 void Sim::api_submission_add() {
@@ -923,7 +1057,7 @@ void Sim::api_submission_add() {
         return api_error400(notifications);
     }
 
-    auto transaction = mysql.start_transaction();
+    auto transaction = start_transaction();
 
     mysql.update("INSERT INTO internal_files VALUES()");
     auto file_id = mysql.insert_id();
@@ -940,10 +1074,8 @@ void Sim::api_submission_add() {
     auto stmt = mysql.prepare("INSERT submissions (file_id, owner, problem_id,"
                               " contest_problem_id, contest_round_id,"
                               " contest_id, type, language, initial_status,"
-                              " full_status, submit_time, last_judgment,"
-                              " initial_report, final_report) "
-                              "VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, '',"
-                              " '')");
+                              " full_status, submit_time, last_judgment) "
+                              "VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
     stmt.bind_and_execute(
         file_id,
         session->user_id,
@@ -963,8 +1095,8 @@ void Sim::api_submission_add() {
     auto submission_id = stmt.insert_id();
     mysql
         .prepare("INSERT jobs (file_id, creator, status, priority, type, added,"
-                 " aux_id, info, data) "
-                 "VALUES(NULL, ?, ?, ?, ?, ?, ?, ?, '')")
+                 " aux_id, info) "
+                 "VALUES(NULL, ?, ?, ?, ?, ?, ?, ?)")
         .bind_and_execute(
             session->user_id,
             EnumVal(Job::Status::PENDING),
@@ -989,9 +1121,7 @@ void Sim::api_submission_source() {
         return api_error403();
     }
 
-    append(cpp_syntax_highlighter(intentional_unsafe_cstring_view(
-        get_file_contents(sim::internal_files::path_of(submissions_file_id))
-    )));
+    append(*highlighted_sources_cache.get(submissions_file_id, cpp_syntax_highlighter));
 }
 
 void Sim::api_submission_download() {
@@ -1009,6 +1139,30 @@ void Sim::api_submission_download() {
     resp.content_type = http::Response::FILE;
 }
 
+void Sim::api_submission_wait_for_status_change() {
+    STACK_UNWINDING_MARK;
+
+    if (uint(~submissions_perms & SubmissionPermissions::VIEW)) {
+        return api_error403();
+    }
+
+    EnumVal<Submission::Status> initial_status{};
+    EnumVal<Submission::Status> full_status{};
+    auto stmt = mysql.prepare("SELECT initial_status, full_status FROM submissions WHERE id=?");
+    stmt.res_bind_all(initial_status, full_status);
+    api_wait_for_status_change(
+        sim::status_events::Kind::SUBMISSION,
+        WONT_THROW(str2num<uint64_t>(submissions_sid).value()),
+        [&]() -> uint64_t {
+            stmt.bind_and_execute(submissions_sid);
+            if (not stmt.next()) {
+                return 0; // The submission has been deleted
+            }
+            return ((uint64_t{initial_status.to_int()} << 8) | full_status.to_int()) + 1;
+        }
+    );
+}
+
 void Sim::api_submission_rejudge() {
     STACK_UNWINDING_MARK;
 
@@ -1023,8 +1177,8 @@ void Sim::api_submission_rejudge() {
     throw_assert(stmt.next());
 
     stmt = mysql.prepare("INSERT jobs (file_id, creator, status, priority,"
-                         " type, added, aux_id, info, data) "
-                         "VALUES(NULL, ?, ?, ?, ?, ?, ?, ?, '')");
+                         " type, added, aux_id, info) "
+                         "VALUES(NULL, ?, ?, ?, ?, ?, ?, ?)");
     stmt.bind_and_execute(
         session->user_id,
         EnumVal(Job::Status::PENDING),
@@ -1058,7 +1212,7 @@ void Sim::api_submission_change_type() {
         return api_error400("Invalid type, it must be one of those: I or N");
     }
 
-    auto transaction = mysql.start_transaction();
+    auto transaction = start_transaction();
 
     auto stmt = mysql.prepare("SELECT full_status, owner, problem_id,"
                               " contest_problem_id "
@@ -1101,7 +1255,7 @@ void Sim::api_submission_delete() {
         return api_error403();
     }
 
-    auto transaction = mysql.start_transaction();
+    auto transaction = start_transaction();
 
     auto stmt = mysql.prepare("SELECT owner, problem_id, contest_problem_id "
                               "FROM submissions WHERE id=?");
@@ -1116,8 +1270,8 @@ void Sim::api_submission_delete() {
 
     mysql
         .prepare("INSERT INTO jobs(file_id, creator, type, priority, status,"
-                 " added, aux_id, info, data)"
-                 "SELECT file_id, NULL, ?, ?, ?, ?, NULL, '', ''"
+                 " added, aux_id, info)"
+                 "SELECT file_id, NULL, ?, ?, ?, ?, NULL, ''"
                  " FROM submissions WHERE id=?")
         .bind_and_execute(
             EnumVal(Job::Type::DELETE_FILE),
@@ -1,10 +1,13 @@
 #include "../capabilities/problems.hh"
+#include "../http/conditional_get.hh"
 #include "../http/response.hh"
 #include "../web_worker/context.hh"
 #include "api.hh"
+#include "list_changes.hh"
 
 #include <algorithm>
 #include <cstdint>
+#include <ctime>
 #include <optional>
 #include <sim/problem_tags/problem_tag.hh>
 #include <sim/problems/problem.hh>
@@ -17,6 +20,7 @@
 #include <simlib/mysql/mysql.hh>
 #include <simlib/sql.hh>
 #include <simlib/string_view.hh>
+#include <string>
 #include <tuple>
 
 using sim::problem_tags::ProblemTag;
@@ -25,7 +29,10 @@ using sim::submissions::Submission;
 using sim::users::User;
 using std::optional;
 using web_server::capabilities::ProblemsListCapabilities;
+using web_server::http::is_not_modified;
 using web_server::http::Response;
+using web_server::http::set_validators;
+using web_server::problems::list_changes_version;
 using web_server::web_worker::Context;
 
 namespace capabilities = web_server::capabilities;
@@ -127,20 +134,112 @@ struct ProblemInfo {
     }
 };
 
+// Returns std::nullopt if @p datetime is empty or invalid
+std::optional<time_t> datetime_to_time(StringView datetime) {
+    struct tm tm = {};
+    if (strptime(datetime.to_string().c_str(), "%Y-%m-%d %H:%M:%S", &tm) == nullptr) {
+        return std::nullopt;
+    }
+    return timegm(&tm);
+}
+
+struct ListValidators {
+    std::string etag;
+    std::optional<time_t> last_modified;
+};
+
+// Validators are computed using only aggregates over the listed problems and the session user's
+// final submissions, so they are cheap compared to the list itself. Problems from the next pages
+// (keyset paging) do not affect the validators of the previous ones.
+template <class... Params>
+ListValidators list_validators(Context& ctx, const sql::Condition<Params...>& where_cond) {
+    uint64_t problems_num = 0;
+    decltype(Problem::id) max_problem_id = 0;
+    InplaceBuff<32> max_updated_at;
+    auto stmt = ctx.mysql.prepare_bind_and_execute(
+        sql::Select("COUNT(*), COALESCE(MAX(p.id), 0), COALESCE(MAX(p.updated_at), '')")
+            .from("problems p")
+            .where(where_cond)
+    );
+    stmt.res_bind_all(problems_num, max_problem_id, max_updated_at);
+    throw_assert(stmt.next());
+
+    auto changes_version = list_changes_version();
+    auto updated_at = datetime_to_time(max_updated_at).value_or(0);
+    auto etag = concat_tostr(
+        "W/\"",
+        problems_num,
+        '.',
+        max_problem_id,
+        '.',
+        updated_at,
+        '.',
+        changes_version.counter
+    );
+
+    if (not ctx.session) {
+        etag += '"';
+        // Last-Modified is granular to seconds, so it is not usable for the current second
+        auto last_modified = std::max(updated_at, changes_version.last_change);
+        return {
+            .etag = std::move(etag),
+            .last_modified = last_modified < time(nullptr) ? std::optional{last_modified}
+                                                           : std::nullopt,
+        };
+    }
+
+    // Changes of the final submissions have no common timestamp, so only ETag is used here
+    uint64_t finals_num = 0;
+    uint64_t finals_ids_xor = 0;
+    InplaceBuff<32> finals_last_judgment;
+    auto finals_stmt = ctx.mysql.prepare_bind_and_execute(
+        sql::Select("COUNT(*), BIT_XOR(id), COALESCE(MAX(last_judgment), '')")
+            .from("submissions")
+            .where(
+                sql::Condition("owner=?", ctx.session->user_id) and
+                sql::Condition{"problem_final IS TRUE"}
+            )
+    );
+    finals_stmt.res_bind_all(finals_num, finals_ids_xor, finals_last_judgment);
+    throw_assert(finals_stmt.next());
+
+    etag += concat_tostr(
+        '.',
+        ctx.session->user_id,
+        '.',
+        ctx.session->user_type.to_int(),
+        '.',
+        finals_num,
+        '.',
+        finals_ids_xor,
+        '.',
+        datetime_to_time(finals_last_judgment).value_or(0),
+        '"'
+    );
+    return {.etag = std::move(etag), .last_modified = std::nullopt};
+}
+
 template <class... Params>
 Response do_list(Context& ctx, uint32_t limit, sql::Condition<Params...> where_cond) {
+    auto validators = list_validators(ctx, where_cond);
+    if (is_not_modified(ctx.request, validators.etag, validators.last_modified)) {
+        auto resp = ctx.response_304();
+        set_validators(resp, validators.etag, validators.last_modified);
+        return resp;
+    }
+
     ProblemInfo p;
     auto stmt = ctx.mysql.prepare_bind_and_execute(
         sql::Select("p.id, p.type, p.name, p.label, p.owner_id, u.username, u.first_name, "
-                    "u.last_name, p.created_at, p.updated_at, s.full_status")
+                    "u.last_name, p.created_at, p.updated_at, ups.full_status")
             .from("problems p")
             .left_join("users u")
             .on("u.id=p.owner_id")
-            .left_join("submissions s")
-            .on(sql::Condition{"s.problem_id=p.id"} and
+            .left_join("user_problem_statuses ups")
+            .on(sql::Condition{"ups.problem_id=p.id"} and
                 sql::Condition{
-                    "s.owner=?", ctx.session ? optional{ctx.session->user_id} : std::nullopt} and
-                sql::Condition{"s.problem_final IS TRUE"})
+                    "ups.user_id=?", ctx.session ? optional{ctx.session->user_id} : std::nullopt
+                })
             .where(where_cond)
             .order_by("p.id DESC")
             .limit("?", limit)
@@ -201,7 +300,9 @@ Response do_list(Context& ctx, uint32_t limit, sql::Condition<Params...> where_c
             );
         }
     });
-    return ctx.response_json(std::move(obj).into_str());
+    auto resp = ctx.response_json(std::move(obj).into_str());
+    set_validators(resp, validators.etag, validators.last_modified);
+    return resp;
 }
 
 constexpr bool is_query_allowed(
@@ -364,15 +465,15 @@ Response view_problem(Context& ctx, decltype(Problem::id) problem_id) {
     }
     stmt = ctx.mysql.prepare_bind_and_execute(
         sql::Select("p.name, p.label, u.username, u.first_name, u.last_name, "
-                    "p.created_at, p.updated_at, s.full_status, p.simfile")
+                    "p.created_at, p.updated_at, ups.full_status, p.simfile")
             .from("problems p")
             .left_join("users u")
             .on("u.id=p.owner_id")
-            .left_join("submissions s")
-            .on(sql::Condition{"s.problem_id=p.id"} and
+            .left_join("user_problem_statuses ups")
+            .on(sql::Condition{"ups.problem_id=p.id"} and
                 sql::Condition{
-                    "s.owner=?", ctx.session ? optional{ctx.session->user_id} : std::nullopt} and
-                sql::Condition{"s.problem_final IS TRUE"})
+                    "ups.user_id=?", ctx.session ? optional{ctx.session->user_id} : std::nullopt
+                })
             .where("p.id=?", problem_id)
     );
     decltype(Problem::simfile) simfile;
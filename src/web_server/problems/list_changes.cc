@@ -0,0 +1,38 @@
+#include "list_changes.hh"
+
+#include <chrono>
+#include <mutex>
+
+namespace web_server::problems {
+
+namespace {
+
+uint64_t microseconds_since_epoch() noexcept {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::system_clock::now().time_since_epoch()
+    )
+        .count();
+}
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+std::mutex mtx;
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+ListChangesVersion version = {
+    .counter = microseconds_since_epoch(),
+    .last_change = time(nullptr),
+};
+
+} // namespace
+
+void note_list_change() noexcept {
+    std::lock_guard<std::mutex> lock(mtx);
+    ++version.counter;
+    version.last_change = time(nullptr);
+}
+
+ListChangesVersion list_changes_version() noexcept {
+    std::lock_guard<std::mutex> lock(mtx);
+    return version;
+}
+
+} // namespace web_server::problems
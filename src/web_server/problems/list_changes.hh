@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+
+namespace web_server::problems {
+
+struct ListChangesVersion {
+    uint64_t counter;
+    time_t last_change;
+};
+
+// Records a change of the data shown in the problem lists that is not reflected in
+// problems.updated_at (tags, owners and their names, deleting and merging problems). The version
+// is a part of the lists' validators; it starts from the server start time, so validators issued
+// before a restart do not match.
+void note_list_change() noexcept;
+
+ListChangesVersion list_changes_version() noexcept;
+
+} // namespace web_server::problems
@@ -0,0 +1,250 @@
+#pragma once
+
+#include "http/request.hh"
+#include "http/route_trie.hh"
+
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+
+// Routing of the web server, see http::RouteTrie for the pattern syntax. The routes of
+// web_worker::WebWorker and old::Sim are matched by a single trie. The old::Sim API is routed
+// down to the handlers, whereas its pages are routed to the subsystems that render the page
+// templates (e.g. /c/** to Sim::contests_handle()).
+namespace web_server::routes {
+
+// Handled by web_worker::WebWorker, route index is the index in the array
+constexpr inline std::string_view web_worker[] = {
+    "GET /api/contest/{u64}/entry_tokens",
+    "GET /api/contest_entry_token/{string}/contest_name",
+    "GET /api/problem/{u64}",
+    "GET /api/problems",
+    "GET /api/problems/id%3C/{u64}",
+    "GET /api/problems/type=/{custom}",
+    "GET /api/problems/type=/{custom}/id%3C/{u64}",
+    "GET /api/user/{u64}",
+    "GET /api/user/{u64}/problems",
+    "GET /api/user/{u64}/problems/id%3C/{u64}",
+    "GET /api/user/{u64}/problems/type=/{custom}",
+    "GET /api/user/{u64}/problems/type=/{custom}/id%3C/{u64}",
+    "GET /api/users",
+    "GET /api/users/id%3E/{u64}",
+    "GET /api/users/type=/{custom}",
+    "GET /api/users/type=/{custom}/id%3E/{u64}",
+    "GET /enter_contest/{string}",
+    "GET /problems",
+    "GET /sign_in",
+    "GET /sign_out",
+    "GET /sign_up",
+    "GET /user/{u64}/change_password",
+    "GET /user/{u64}/delete",
+    "GET /user/{u64}/edit",
+    "GET /user/{u64}/merge_into_another",
+    "GET /users",
+    "GET /users/add",
+    "POST /api/contest/{u64}/entry_tokens/add",
+    "POST /api/contest/{u64}/entry_tokens/add_short",
+    "POST /api/contest/{u64}/entry_tokens/delete",
+    "POST /api/contest/{u64}/entry_tokens/delete_short",
+    "POST /api/contest/{u64}/entry_tokens/regen",
+    "POST /api/contest/{u64}/entry_tokens/regen_short",
+    "POST /api/contest_entry_token/{string}/use",
+    "POST /api/sign_in",
+    "POST /api/sign_out",
+    "POST /api/sign_up",
+    "POST /api/user/{u64}/change_password",
+    "POST /api/user/{u64}/delete",
+    "POST /api/user/{u64}/edit",
+    "POST /api/user/{u64}/merge_into_another",
+    "POST /api/users/add",
+};
+
+// Routes of old::Sim
+enum class Old : uint8_t {
+    KIT,
+    MAIN_PAGE,
+    CONTESTS,
+    SUBMISSIONS,
+    USERS,
+    PROBLEMS,
+    CONTEST_FILE,
+    JOBS,
+    FILE,
+    LOGS,
+    API,
+    API_BATCH,
+    API_DOWNLOAD,
+    API_CONTEST_CREATE,
+    API_CONTEST_CLONE,
+    API_CONTEST_VIEW,
+    API_CONTEST_RANKING,
+    API_CONTEST_RANKING_ROWS,
+    API_CONTEST_EDIT,
+    API_CONTEST_DELETE,
+    API_CONTEST_CREATE_ROUND,
+    API_CONTEST_CLONE_ROUND,
+    API_CONTEST_ROUND_VIEW,
+    API_CONTEST_ROUND_RANKING,
+    API_CONTEST_ROUND_RANKING_ROWS,
+    API_CONTEST_ROUND_ATTACH_PROBLEM,
+    API_CONTEST_ROUND_EDIT,
+    API_CONTEST_ROUND_DELETE,
+    API_CONTEST_PROBLEM_VIEW,
+    API_CONTEST_PROBLEM_STATEMENT,
+    API_CONTEST_PROBLEM_RANKING,
+    API_CONTEST_PROBLEM_RANKING_ROWS,
+    API_CONTEST_PROBLEM_REJUDGE_ALL_SUBMISSIONS,
+    API_CONTEST_PROBLEM_EDIT,
+    API_CONTEST_PROBLEM_DELETE,
+    API_CONTEST_FILE_ADD,
+    API_CONTEST_FILE_DOWNLOAD,
+    API_CONTEST_FILE_EDIT,
+    API_CONTEST_FILE_DELETE,
+    API_CONTEST_FILES,
+    API_CONTEST_USER_ADD,
+    API_CONTEST_USER_CHANGE_MODE,
+    API_CONTEST_USER_EXPEL,
+    API_CONTEST_USERS,
+    API_CONTESTS,
+    API_JOB_CANCEL,
+    API_JOB_RESTART,
+    API_JOB_LOG,
+    API_JOB_WAIT_FOR_STATUS_CHANGE,
+    API_JOB_UPLOADED_PACKAGE,
+    API_JOB_UPLOADED_STATEMENT,
+    API_JOBS,
+    API_LOGS,
+    API_PROBLEM_ADD,
+    API_PROBLEM_STATEMENT,
+    API_PROBLEM_DOWNLOAD,
+    API_PROBLEM_REJUDGE_ALL_SUBMISSIONS,
+    API_PROBLEM_RESET_TIME_LIMITS,
+    API_PROBLEM_REUPLOAD,
+    API_PROBLEM_EDIT_TAGS_ADD,
+    API_PROBLEM_EDIT_TAGS_EDIT,
+    API_PROBLEM_EDIT_TAGS_DELETE,
+    API_PROBLEM_EDIT_PARALLEL_JUDGING,
+    API_PROBLEM_CHANGE_STATEMENT,
+    API_PROBLEM_DELETE,
+    API_PROBLEM_MERGE_INTO_ANOTHER,
+    API_PROBLEM_ATTACHING_CONTEST_PROBLEMS,
+    API_PROBLEMS,
+    API_SUBMISSION_ADD,
+    API_SUBMISSION_SOURCE,
+    API_SUBMISSION_DOWNLOAD,
+    API_SUBMISSION_WAIT_FOR_STATUS_CHANGE,
+    API_SUBMISSION_REJUDGE,
+    API_SUBMISSION_CHANGE_TYPE,
+    API_SUBMISSION_DELETE,
+    API_SUBMISSIONS,
+    NOT_FOUND,
+};
+
+// In the order of Old. The routes ending with "/**" parse the rest of the path themselves.
+constexpr inline std::string_view old[] = {
+    "/kit/**",
+    "/",
+    "/c/**",
+    "/s/**",
+    "/u/**",
+    "/p/**",
+    "/contest_file/**",
+    "/jobs/**",
+    "/file/**",
+    "/logs/**",
+    "/api/**",
+    "/api/batch",
+    "/api/download/**",
+    "/api/contest/create",
+    "/api/contest/clone",
+    "/api/contest/c{u64}",
+    "/api/contest/c{u64}/ranking",
+    "/api/contest/c{u64}/ranking_rows/**",
+    "/api/contest/c{u64}/edit",
+    "/api/contest/c{u64}/delete",
+    "/api/contest/c{u64}/create_round",
+    "/api/contest/c{u64}/clone_round",
+    "/api/contest/r{u64}",
+    "/api/contest/r{u64}/ranking",
+    "/api/contest/r{u64}/ranking_rows/**",
+    "/api/contest/r{u64}/attach_problem",
+    "/api/contest/r{u64}/edit",
+    "/api/contest/r{u64}/delete",
+    "/api/contest/p{u64}",
+    "/api/contest/p{u64}/statement",
+    "/api/contest/p{u64}/ranking",
+    "/api/contest/p{u64}/ranking_rows/**",
+    "/api/contest/p{u64}/rejudge_all_submissions",
+    "/api/contest/p{u64}/edit",
+    "/api/contest/p{u64}/delete",
+    "/api/contest_file/add/c{u64}",
+    "/api/contest_file/{string}/download",
+    "/api/contest_file/{string}/edit",
+    "/api/contest_file/{string}/delete",
+    "/api/contest_files/**",
+    "/api/contest_user/c{u64}/add",
+    "/api/contest_user/c{u64}/u{u64}/change_mode",
+    "/api/contest_user/c{u64}/u{u64}/expel",
+    "/api/contest_users/**",
+    "/api/contests/**",
+    "/api/job/{u64}/cancel",
+    "/api/job/{u64}/restart",
+    "/api/job/{u64}/log",
+    "/api/job/{u64}/wait_for_status_change",
+    "/api/job/{u64}/uploaded-package",
+    "/api/job/{u64}/uploaded-statement",
+    "/api/jobs/**",
+    "/api/logs/**",
+    "/api/problem/add",
+    "/api/problem/{u64}/statement",
+    "/api/problem/{u64}/download",
+    "/api/problem/{u64}/rejudge_all_submissions",
+    "/api/problem/{u64}/reset_time_limits",
+    "/api/problem/{u64}/reupload",
+    "/api/problem/{u64}/edit/tags/add_tag",
+    "/api/problem/{u64}/edit/tags/edit_tag",
+    "/api/problem/{u64}/edit/tags/delete_tag",
+    "/api/problem/{u64}/edit/parallel_judging",
+    "/api/problem/{u64}/change_statement",
+    "/api/problem/{u64}/delete",
+    "/api/problem/{u64}/merge_into_another",
+    "/api/problem/{u64}/attaching_contest_problems/**",
+    "/api/problems/**",
+    "/api/submission/add/**",
+    "/api/submission/{u64}/source",
+    "/api/submission/{u64}/download",
+    "/api/submission/{u64}/wait_for_status_change",
+    "/api/submission/{u64}/rejudge",
+    "/api/submission/{u64}/chtype",
+    "/api/submission/{u64}/delete",
+    "/api/submissions/**",
+};
+static_assert(std::size(old) == static_cast<size_t>(Old::NOT_FOUND));
+
+constexpr inline http::RouteTrie<http::route_trie_nodes_bound(web_worker, old)> trie{
+    web_worker, old
+};
+
+// HEAD requests are matched as GET ones
+constexpr http::RouteMatch match(http::Request::Method method, std::string_view target) noexcept {
+    return trie.match(
+        method == http::Request::POST ? http::RouteMethod::POST : http::RouteMethod::GET, target
+    );
+}
+
+constexpr bool is_web_worker(const http::RouteMatch& match) noexcept {
+    return match and match.route < std::size(web_worker);
+}
+
+// Returns Old::NOT_FOUND if @p match is not a route of old::Sim
+constexpr Old old_route(const http::RouteMatch& match) noexcept {
+    return match and not is_web_worker(match)
+        ? static_cast<Old>(match.route - std::size(web_worker))
+        : Old::NOT_FOUND;
+}
+
+constexpr bool is_old_api(Old route) noexcept {
+    return route >= Old::API and route < Old::NOT_FOUND;
+}
+
+} // namespace web_server::routes
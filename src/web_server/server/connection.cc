@@ -1,11 +1,13 @@
 #include "connection.hh"
 
+#include <cerrno>
 #include <iostream>
 #include <poll.h>
 #include <simlib/debug.hh>
 #include <simlib/file_descriptor.hh>
 #include <simlib/file_manip.hh>
 #include <simlib/logger.hh>
+#include <sys/sendfile.h>
 #include <unistd.h>
 
 using std::pair;
@@ -777,18 +779,33 @@ void Connection::send_response(const http::Response& res) {
         str += to_string(fsize);
         str += "\r\n\r\n";
 
-        constexpr size_t buff_length = 1 << 20;
-        char buff[buff_length];
-
         send(str);
         if (state_ == CLOSED) {
             return;
         }
 
+        // Send the file directly from the page cache to the socket
+        off_t offset = 0;
+        while (offset < fsize && state_ == OK) {
+            ssize_t sent = sendfile(sock_fd_, fd, &offset, fsize - offset);
+            if (sent > 0) {
+                continue;
+            }
+            if (sent == -1 && errno == EINTR) {
+                continue;
+            }
+            if (sent == -1 && offset == 0 && (errno == EINVAL || errno == ENOSYS)) {
+                break; // sendfile() is not supported for this file, fall back to read()
+            }
+            state_ = CLOSED;
+        }
+
         // Read from file and write to socket
-        off64_t pos = 0;
+        constexpr size_t buff_length = 1 << 20;
+        char buff[buff_length];
+        off64_t pos = offset;
         ssize_t read_len = 0;
-        while (pos < fsize && state_ == OK && (read_len = read(fd, buff, buff_length)) != -1) {
+        while (pos < fsize && state_ == OK && (read_len = read(fd, buff, buff_length)) > 0) {
             send(buff, read_len);
             pos += read_len;
         }
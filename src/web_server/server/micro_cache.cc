@@ -0,0 +1,103 @@
+#include "../http/route_trie.hh"
+#include "micro_cache.hh"
+
+#include <simlib/string_view.hh>
+#include <string_view>
+
+namespace web_server::server {
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+MicroCache micro_cache;
+
+namespace {
+
+// Targets whose responses to anonymous users do not depend on anything but the database
+constexpr std::string_view cacheable_routes[] = {
+    "/api/problem/{u64}",
+    "/api/problems",
+    "/api/problems/id%3C/{u64}",
+    "/api/problems/type=/{custom}",
+    "/api/problems/type=/{custom}/id%3C/{u64}",
+};
+
+constexpr http::RouteTrie<http::route_trie_nodes_bound(cacheable_routes)> cacheable_routes_trie{
+    cacheable_routes
+};
+
+} // namespace
+
+bool MicroCache::is_cacheable(const http::Request& req) const noexcept {
+    // Conditional requests are cheap to answer and their responses (e.g. 304) are not reusable
+    return ttl_.count() > 0 and req.method == http::Request::GET and
+        req.get_cookie("session").empty() and not req.headers.get("if-none-match") and
+        not req.headers.get("if-modified-since") and
+        static_cast<bool>(cacheable_routes_trie.match(req.target));
+}
+
+std::pair<MicroCache::Lookup, std::shared_ptr<const http::Response>>
+MicroCache::lookup(const std::string& key) {
+    std::unique_lock<std::mutex> lock(mtx_);
+    auto wait_deadline = std::chrono::steady_clock::now() + MAX_WAIT;
+    for (;;) {
+        auto now = std::chrono::steady_clock::now();
+        auto it = entries_.find(key);
+        if (it != entries_.end() and it->second.computing) {
+            // Other worker computes the response, but if it is stuck, computing it is faster
+            if (now >= wait_deadline) {
+                return {Lookup::BYPASS, nullptr};
+            }
+            cv_.wait_until(lock, wait_deadline);
+            continue;
+        }
+
+        if (it != entries_.end() and it->second.expires > now) {
+            if (it->second.response) {
+                return {Lookup::HIT, it->second.response};
+            }
+            return {Lookup::BYPASS, nullptr};
+        }
+
+        if (it == entries_.end()) {
+            if (entries_.size() >= MAX_ENTRIES) {
+                for (auto jt = entries_.begin(); jt != entries_.end();) {
+                    bool expired = not jt->second.computing and jt->second.expires <= now;
+                    jt = (expired ? entries_.erase(jt) : std::next(jt));
+                }
+                if (entries_.size() >= MAX_ENTRIES) {
+                    return {Lookup::BYPASS, nullptr};
+                }
+            }
+            it = entries_.try_emplace(key).first;
+        }
+
+        it->second = Entry{.response = nullptr, .expires = {}, .computing = true};
+        return {Lookup::MISS, nullptr};
+    }
+}
+
+void MicroCache::store(const std::string& key, const http::Response& resp) {
+    std::shared_ptr<const http::Response> cached_resp;
+    if (has_prefix(resp.status_code, "200 ") and resp.content_type == http::Response::TEXT and
+        resp.cookies.cookies_as_headers.is_empty() and resp.content.size <= MAX_RESPONSE_SIZE)
+    {
+        cached_resp = std::make_shared<const http::Response>(resp);
+    }
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto& entry = entries_[key];
+    // Uncacheable responses are remembered too, so that the waiting workers do not serialize
+    entry = Entry{
+        .response = std::move(cached_resp),
+        .expires = std::chrono::steady_clock::now() + ttl_,
+        .computing = false,
+    };
+    cv_.notify_all();
+}
+
+void MicroCache::abandon(const std::string& key) noexcept {
+    std::lock_guard<std::mutex> lock(mtx_);
+    entries_.erase(key);
+    cv_.notify_all();
+}
+
+} // namespace web_server::server
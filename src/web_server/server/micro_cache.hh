@@ -0,0 +1,89 @@
+#pragma once
+
+#include "../http/request.hh"
+#include "../http/response.hh"
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <simlib/call_in_destructor.hh>
+#include <string>
+#include <utility>
+
+namespace web_server::server {
+
+// Shared cache of responses to anonymous (without the session cookie) GET requests of the
+// public lists and views of problems, which are identical for all anonymous users. Entries live
+// for a short TTL. Concurrent misses of the same target are coalesced: one worker computes the
+// response while the others wait for it (for at most MAX_WAIT, then they compute it themselves).
+// Only successful text responses that do not set cookies are cached.
+class MicroCache {
+    struct Entry {
+        std::shared_ptr<const http::Response> response; // nullptr if the response is uncacheable
+        std::chrono::steady_clock::time_point expires;
+        bool computing = false;
+    };
+
+    enum class Lookup { HIT, MISS, BYPASS };
+
+    static constexpr size_t MAX_ENTRIES = 1024;
+    static constexpr size_t MAX_RESPONSE_SIZE = 1 << 20;
+    static constexpr std::chrono::seconds MAX_WAIT{1};
+
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::chrono::milliseconds ttl_{0};
+    std::map<std::string, Entry, std::less<>> entries_;
+
+public:
+    MicroCache() = default;
+
+    MicroCache(const MicroCache&) = delete;
+    MicroCache(MicroCache&&) = delete;
+    MicroCache& operator=(const MicroCache&) = delete;
+    MicroCache& operator=(MicroCache&&) = delete;
+    ~MicroCache() = default;
+
+    // Not thread-safe, should be called before the workers start. 0 disables the cache.
+    void configure(std::chrono::milliseconds ttl) noexcept { ttl_ = ttl; }
+
+    // Returns the cached response to @p req or the one produced by @p handler
+    template <class Handler>
+    http::Response handle(http::Request req, Handler&& handler) {
+        if (not is_cacheable(req)) {
+            return std::forward<Handler>(handler)(std::move(req));
+        }
+
+        auto key = req.target;
+        auto [lookup_res, cached_resp] = lookup(key);
+        switch (lookup_res) {
+        case Lookup::HIT: return *cached_resp;
+        case Lookup::BYPASS: return std::forward<Handler>(handler)(std::move(req));
+        case Lookup::MISS: break;
+        }
+
+        CallInDtor abandon_guard([&] { abandon(key); });
+        auto resp = std::forward<Handler>(handler)(std::move(req));
+        abandon_guard.cancel();
+        store(key, resp);
+        return resp;
+    }
+
+private:
+    [[nodiscard]] bool is_cacheable(const http::Request& req) const noexcept;
+
+    // On MISS the caller has to compute the response and call store() or abandon()
+    std::pair<Lookup, std::shared_ptr<const http::Response>> lookup(const std::string& key);
+
+    void store(const std::string& key, const http::Response& resp);
+
+    void abandon(const std::string& key) noexcept;
+};
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+extern MicroCache micro_cache;
+
+} // namespace web_server::server
@@ -1,6 +1,9 @@
 #include "../logs.hh"
+#include "../old/highlighted_sources_cache.hh"
 #include "../old/sim.hh"
+#include "../old/status_events_listener.hh"
 #include "connection.hh"
+#include "micro_cache.hh"
 
 #include <arpa/inet.h>
 #include <chrono>
@@ -8,6 +11,7 @@
 #include <cstdint>
 #include <netinet/in.h>
 #include <pthread.h>
+#include <sim/cpu_affinity.hh>
 #include <simlib/config_file.hh>
 #include <simlib/debug.hh>
 #include <simlib/file_descriptor.hh>
@@ -49,7 +53,9 @@ static void* worker(void* ptr) {
                 using std::chrono::steady_clock;
                 auto beg = steady_clock::now();
 
-                http::Response resp = sim_worker.handle(std::move(req));
+                http::Response resp = micro_cache.handle(std::move(req), [&](http::Request r) {
+                    return sim_worker.handle(std::move(r));
+                });
 
                 auto microdur = std::chrono::duration_cast<std::chrono::microseconds>(
                     steady_clock::now() - beg
@@ -116,7 +122,16 @@ int main() {
 
     ConfigFile config;
     try {
-        config.add_vars("address", "workers");
+        config.add_vars(
+            "address",
+            "workers",
+            "highlighted_sources_cache_mem",
+            "highlighted_sources_cache_on_disk",
+            "js_judge_cpus",
+            "js_parallel_judging_cpus",
+            "long_polling_workers",
+            "micro_cache_ttl_ms"
+        );
 
         config.load_config_from_file("sim.conf");
     } catch (const std::exception& e) {
@@ -132,6 +147,37 @@ int main() {
         return 6;
     }
 
+    // By default, a quarter of the workers is left for the requests other than long polling
+    size_t long_polling_workers = workers * 3 / 4;
+    if (config["long_polling_workers"].is_set()) {
+        long_polling_workers = config["long_polling_workers"].as<size_t>().value_or(0);
+    }
+    if (long_polling_workers >= workers) {
+        errlog("sim.conf: Number of long polling workers has to be lower than number of workers");
+        return 6;
+    }
+
+    auto highlighted_sources_cache_mem =
+        config["highlighted_sources_cache_mem"].as<size_t>().value_or(0);
+    auto highlighted_sources_cache_on_disk =
+        config["highlighted_sources_cache_on_disk"].as<bool>().value_or(false);
+    web_server::old::highlighted_sources_cache.configure(
+        highlighted_sources_cache_mem << 20, highlighted_sources_cache_on_disk
+    );
+
+    auto micro_cache_ttl_ms = config["micro_cache_ttl_ms"].as<uint64_t>().value_or(0);
+    web_server::server::micro_cache.configure(std::chrono::milliseconds(micro_cache_ttl_ms));
+
+    // Keep the workers (spawned below) off the cpus on which the submissions are judged
+    try {
+        sim::cpu_affinity::exclude_from_current_thread(
+            sim::cpu_affinity::judging_cpus_from_config(config)
+        );
+    } catch (const std::exception& e) {
+        errlog("Failed to set cpu affinity: ", e.what());
+        return 6;
+    }
+
     sockaddr_in name{};
     name.sin_family = AF_INET;
     memset(name.sin_zero, 0, sizeof(name.sin_zero));
@@ -169,6 +215,10 @@ int main() {
     stdlog("\n=================== Server launched ==================="
            "\nPID: ", getpid(),
            "\nworkers: ", workers,
+           "\nhighlighted sources cache: ", highlighted_sources_cache_mem, " MiB",
+               (highlighted_sources_cache_on_disk ? " + disk" : ""),
+           "\nlong polling workers: ", long_polling_workers,
+           "\nmicro cache TTL: ", micro_cache_ttl_ms, " ms",
            "\naddress: ", address_str, ':', port);
     // clang-format on
 
@@ -223,6 +273,8 @@ int main() {
         return 4;
     }
 
+    web_server::old::status_events_listener.start(long_polling_workers);
+
     // Alter default thread stack size
     pthread_attr_t attr;
     constexpr size_t THREAD_STACK_SIZE = 4 << 20; // 4 MiB
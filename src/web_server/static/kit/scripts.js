@@ -2430,6 +2430,48 @@ function old_API_call(ajax_url, success_handler, oldloader_parent) {
 	});
 }
 
+// Makes the old API calls to @p targets in one request; the server handles them in a single
+// transaction. success_handler gets the parsed responses in the order of @p targets.
+function old_API_batch_call(targets, success_handler, oldloader_parent) {
+	var self = this;
+	var form = add_csrf_token_to($('<form>'));
+	form.append($('<input>', {type: 'hidden', name: 'targets', value: targets.join('\n')}));
+	append_oldloader(oldloader_parent[0]);
+	$.ajax({
+		url: '/api/batch',
+		type: 'POST',
+		processData: false,
+		contentType: false,
+		data: new FormData(form.get(0)),
+		dataType: 'json',
+		success: function(data, status, jqXHR) {
+			var resps = parse_api_resp(data);
+			var results = [];
+			for (var i = 0; i < resps.length; ++i) {
+				var code = parseInt(resps[i].status);
+				if (code !== 200) {
+					// Present the failed request as if it was a separate one
+					var resp = {
+						status: code,
+						statusText: resps[i].status.substring(String(code).length + 1),
+						responseText: resps[i].body
+					};
+					return show_error_via_oldloader(oldloader_parent, resp, status,
+						setTimeout.bind(null, old_API_batch_call.bind(self, targets, success_handler, oldloader_parent))); // Avoid recursion
+				}
+				results.push(parse_api_resp(resps[i].body));
+			}
+
+			remove_oldloader(oldloader_parent[0]);
+			success_handler.apply(this, results);
+		},
+		error: function(resp, status) {
+			show_error_via_oldloader(oldloader_parent, resp, status,
+				setTimeout.bind(null, old_API_batch_call.bind(self, targets, success_handler, oldloader_parent))); // Avoid recursion
+		}
+	});
+}
+
 function API_get(url, success_handler, oldloader_parent) {
 	var self = this;
 	append_oldloader(oldloader_parent[0]);
@@ -2598,6 +2640,38 @@ function timed_hide_show(elem) {
 			this.show();
 	});
 }
+// Calls @p on_change once the status of the submission / job (@p api_url is its API url) changes.
+// Stops if @p elem is removed from the document.
+function on_status_change(api_url, elem, on_change) {
+	var token = '';
+	var wait = function() {
+		if (!$.contains(document.documentElement, elem[0]))
+			return;
+
+		$.ajax({
+			url: api_url + '/wait_for_status_change/' + token,
+			type: 'POST',
+			processData: false,
+			contentType: false,
+			data: new FormData(add_csrf_token_to($('<form>')).get(0)),
+			dataType: 'json',
+			success: function(data) {
+				data = parse_api_resp(data);
+				if (data.changed)
+					return on_change();
+
+				// If the server could not wait for the change, it responded immediately
+				var delay = (data.long_polled || token === '' ? 0 : 5000);
+				token = data.token;
+				setTimeout(wait, delay);
+			},
+			error: function() {
+				setTimeout(wait, 5000);
+			}
+		});
+	};
+	wait();
+}
 function old_view_ajax(as_oldmodal, ajax_url, success_handler, new_window_location, no_oldmodal_elem /*= document.body*/, show_on_success /*= true */) {
 	view_base(as_oldmodal, new_window_location, function() {
 		var elem = $(this);
@@ -2763,63 +2837,6 @@ function OldLister(elem) {
 }
 
 /* ================================== Logs ================================== */
-function HexToUtf8Parser() {
-	var state = 0;
-	var value = 0;
-
-	this.feed = function(hexstr) {
-		hexstr = hexstr.toString(); // force conversion
-		if (hexstr.length % 2 !== 0)
-			throw new Error("hexstr has to have even length");
-
-		var res = '';
-		for (var i = 0; i < hexstr.length; i += 2) {
-			var char = parseInt(hexstr.substring(i, i + 2), 16);
-			if (state == 0) {
-				// No sequence has started yet
-				if (char < 128) { // 128 = 0b10000000
-					res += String.fromCharCode(char);
-					continue;
-				}
-
-				if (char < 192) // 192 == 0b11000000
-					continue; // Ignore invalid character
-
-				if (char < 224) { // 224 == 0b11100000
-					// 0b110xxxxx <--> one more byte to read
-					state = 1;
-					value = char & ((1 << 5) - 1);
-					continue;
-				}
-
-				if (char < 240) { // 240 == 0b11110000
-					// 0b1110xxxx <--> two more bytes to read
-					state = 2;
-					value = char & ((1 << 4) - 1);
-					continue;
-				}
-
-				if (char < 248) { // 248 == 0b11111000
-					// 0b11110xxx <--> two more bytes to read
-					state = 3;
-					value = char & ((1 << 3) - 1);
-					continue;
-				}
-
-				continue; // Ignore invalid character
-			}
-
-			if (char < 128 || char >= 192) // 192 = 0b11000000
-				continue; // Ignore invalid character
-
-			value = (value << 6) | (char & ((1 << 6) - 1));
-			if (--state == 0)
-				res += String.fromCharCode(value);
-		}
-
-		return res;
-	}
-};
 function colorize(log, end) {
 	if (end === undefined || end > log.length)
 		end = log.length;
@@ -2926,33 +2943,41 @@ function is_overflowed_elem_scrolled_down(elem) {
 	const scroll_distance_to_bottom = elem.scrollHeight - elem.scrollTop - elem.clientHeight;
 	return scroll_distance_to_bottom <= 1; // As of March 2020, I managed to get value 1 in firefox with 80% zoom
 }
+// Splits the response of the logs API into the header lines and the log data
+function parse_log_chunk(data, header_lines) {
+	data = String(data);
+	var header = [];
+	var pos = 0;
+	for (var i = 0; i < header_lines; ++i) {
+		var eol = data.indexOf('\n', pos);
+		header.push(parseInt(data.substring(pos, eol)));
+		pos = eol + 1;
+	}
+	return {header: header, text: data.substring(pos)};
+}
 function Logs(type, elem, auto_refresh_checkbox) {
 	var this_ = this;
 	this.type = type;
 	this.elem = $(elem);
 	this.offset = undefined;
 	var lock = false; // allow only manual unlocking
-	var offset, first_offset;
+	var offset; // beginning of the oldest fetched data
+	var tail_offset; // end of the newest fetched data
 	var content = $('<span>').appendTo(elem);
-	var hex_parser = new HexToUtf8Parser();
 
 	var process_data = function(data) {
-		data[0] = parseInt(data[0]);
-		if (first_offset === undefined)
-			first_offset = data[0];
-		else if (data[0] > first_offset) { // Newer logs arrived
-			first_offset = data[0];
-			content.empty();
+		var chunk = parse_log_chunk(data, 2);
+		offset = chunk.header[0];
+		if (tail_offset === undefined) {
+			tail_offset = chunk.header[1];
+			setTimeout(this_.tail, 0);
 		}
 
-		offset = data[0];
-		data = hex_parser.feed(data[1]);
-
 		var prev_height = content[0].scrollHeight;
 		var bottom_dist = prev_height - content[0].scrollTop;
 
 		remove_oldloader(this_.elem[0]);
-		var html_data = text_to_safe_html(data);
+		var html_data = text_to_safe_html(chunk.text);
 		content.html(colorize(html_data + content.html(), html_data.length + 2000));
 		var curr_height = content[0].scrollHeight;
 		content.scrollTop(curr_height - bottom_dist);
@@ -2980,9 +3005,7 @@ function Logs(type, elem, auto_refresh_checkbox) {
 			processData: false,
 			contentType: false,
 			data: new FormData(add_csrf_token_to($('<form>')).get(0)),
-			success: function (data) {
-				process_data(String(data).split('\n'));
-			},
+			success: process_data,
 			error: function(resp, status) {
 				show_error_via_oldloader(this_.elem, resp, status, function () {
 					lock = false; // allow only manual unlocking
@@ -2992,47 +3015,48 @@ function Logs(type, elem, auto_refresh_checkbox) {
 		});
 	};
 
-	this.try_fetching_newest = function() {
-		if (lock)
+	// The server holds the request until new data arrives (if it can afford it), so the newest
+	// logs appear immediately instead of being polled for
+	this.tail = function() {
+		if (!$.contains(document.documentElement, this_.elem[0]))
 			return;
-		lock = true;
+		if (!auto_refresh_checkbox.prop('checked'))
+			return setTimeout(this_.tail, 2000);
 
-		append_oldloader(this_.elem[0]);
 		$.ajax({
-			url: '/api/logs/' + this_.type,
+			url: '/api/logs/' + this_.type + '/tail/' + tail_offset,
 			type: 'POST',
 			processData: false,
 			contentType: false,
 			data: new FormData(add_csrf_token_to($('<form>')).get(0)),
 			success: function(data) {
-				data = String(data).split('\n');
-				if (parseInt(data[0]) !== first_offset)
-					return process_data(data);
+				var chunk = parse_log_chunk(data, 3);
+				if (chunk.header[0] < tail_offset) {
+					// The log was truncated, so start over
+					content.empty();
+					offset = undefined;
+					tail_offset = undefined;
+					lock = false;
+					return this_.fetch_more();
+				}
 
-				remove_oldloader(this_.elem[0]);
-				lock = false;
+				if (chunk.text.length > 0) {
+					var was_scrolled_down = is_overflowed_elem_scrolled_down(content[0]);
+					content.append(colorize(text_to_safe_html(chunk.text)));
+					if (was_scrolled_down)
+						content.scrollTop(content[0].scrollHeight);
+				}
+
+				tail_offset = chunk.header[1];
+				var long_polled = (chunk.header[2] === 1);
+				setTimeout(this_.tail, (long_polled || chunk.text.length > 0 ? 0 : 2000));
 			},
-			error: function(resp, status) {
-				show_error_via_oldloader(this_.elem, resp, status, function () {
-					lock = false; // allow only manual unlocking
-					this_.fetch_more();
-				});
+			error: function() {
+				setTimeout(this_.tail, 5000);
 			}
 		});
 	};
 
-	var refreshing_interval_id = setInterval(function() {
-		if (!$.contains(document.documentElement, this_.elem[0])) {
-			clearInterval(refreshing_interval_id);
-			return;
-		}
-
-		var elem = content[0];
-		if (is_overflowed_elem_scrolled_down(elem) && auto_refresh_checkbox.prop('checked')) {
-			this_.try_fetching_newest();
-		}
-	}, 2000);
-
 	this.monitor_scroll = function() {
 		var scres_handler;
 		var scres_unhandle_if_detatched = function() {
@@ -3490,7 +3514,7 @@ function view_user(as_oldmodal, user_id, opt_hash /*= ''*/) {
 
 /* ================================== Jobs ================================== */
 function view_job(as_oldmodal, job_id, opt_hash /*= ''*/) {
-	old_view_ajax(as_oldmodal, '/api/jobs/=' + job_id, function(data) {
+	old_view_ajax(as_oldmodal, '/api/jobs/=' + job_id, function render(data) {
 		if (data.length === 0)
 			return show_error_via_oldloader(this, {
 				status: '404',
@@ -3590,6 +3614,15 @@ function view_job(as_oldmodal, job_id, opt_hash /*= ''*/) {
 					text: 'Download the full job log'
 				})));
 		}
+
+		var elem = this;
+		if (job.status.text === 'Pending' || job.status.text === 'In progress')
+			on_status_change('/api/job/' + job_id, elem, function() {
+				old_API_call('/api/jobs/=' + job_id, function(data) {
+					elem.empty();
+					render.call(elem, data);
+				}, elem);
+			});
 	}, '/jobs/' + job_id + (opt_hash === undefined ? '' : opt_hash));
 }
 function cancel_job(job_id) {
@@ -3937,7 +3970,7 @@ function delete_submission(submission_id) {
 		'The submission has been deleted.', 'No, go back');
 }
 function view_submission(as_oldmodal, submission_id, opt_hash /*= ''*/) {
-	old_view_ajax(as_oldmodal, '/api/submissions/=' + submission_id, function(data) {
+	old_view_ajax(as_oldmodal, '/api/submissions/=' + submission_id, function render(data) {
 		if (data.length === 0)
 			return show_error_via_oldloader(this, {
 				status: '404',
@@ -4121,6 +4154,13 @@ function view_submission(as_oldmodal, submission_id, opt_hash /*= ''*/) {
 
 		old_tabmenu(default_tabmenu_attacher.bind(elem), tabs);
 
+		if (s.status.text === 'Pending')
+			on_status_change('/api/submission/' + submission_id, elem, function() {
+				old_API_call('/api/submissions/=' + submission_id, function(data) {
+					elem.empty();
+					render.call(elem, data);
+				}, elem);
+			});
 	}, '/s/' + submission_id + (opt_hash === undefined ? '' : opt_hash), undefined, false);
 }
 function SubmissionsLister(elem, query_suffix /*= ''*/, show_submission /*= function(){return true;}*/) {
@@ -5990,7 +6030,7 @@ function view_contest_problem(as_oldmodal, contest_problem_id, opt_hash /*= ''*/
 }
 function contest_ranking(elem_, id_for_api) {
 	var elem = elem_;
-	old_API_call('/api/contest/' + id_for_api, function(cdata) {
+	old_API_batch_call(['/api/contest/' + id_for_api, '/api/contest/' + id_for_api + '/ranking'], function(cdata, data) {
 		var contest = cdata.contest;
 		var rounds = cdata.rounds;
 		var problems = cdata.problems;
@@ -6038,161 +6078,159 @@ function contest_ranking(elem_, id_for_api) {
 			problem_to_col_id.add(problems[i].id, i);
 		problem_to_col_id.prepare();
 
-		old_API_call('/api/contest/' + id_for_api + '/ranking', function(data) {
-			var oldmodal = elem.parents('.oldmodal');
-			if (data.length == 0) {
-				timed_hide_show(oldmodal);
-				var message_to_show = '<p>There is no one in the ranking yet...</p>';
-				if (rounds.length === 1) {
-					var ranking_exposure = utcdt_or_tm_to_Date(rounds[0].ranking_exposure);
-					if (ranking_exposure === Infinity)
-						message_to_show = '<p>The current round will not be shown in the ranking.</p>';
-					else if (ranking_exposure > new Date())
-						message_to_show = $('<p>Ranking will be available since: </p>').append(normalize_datetime($('<span>', {datetime: rounds[0].ranking_exposure})));
-				}
-
-				return elem.append($('<center>', {
-					class: 'always_in_view',
-					html: message_to_show
-				}));
+		var oldmodal = elem.parents('.oldmodal');
+		if (data.length == 0) {
+			timed_hide_show(oldmodal);
+			var message_to_show = '<p>There is no one in the ranking yet...</p>';
+			if (rounds.length === 1) {
+				var ranking_exposure = utcdt_or_tm_to_Date(rounds[0].ranking_exposure);
+				if (ranking_exposure === Infinity)
+					message_to_show = '<p>The current round will not be shown in the ranking.</p>';
+				else if (ranking_exposure > new Date())
+					message_to_show = $('<p>Ranking will be available since: </p>').append(normalize_datetime($('<span>', {datetime: rounds[0].ranking_exposure})));
 			}
 
-			// Construct table's head
-			var tr = $('<tr>', {
-				html: [
-					$('<th>', {
-						rowspan: 2,
-						text: '#'
-					}),
-					$('<th>', {
-						rowspan: 2,
-						text: 'User'
-					}),
-					$('<th>', {
-						rowspan: 2,
-						text: 'Sum'
-					}),
-				]
-			});
-			// Add rounds
-			var colspan = 0;
-			var j = 0; // Index of the current round
-			for (var i = 0; i < problems.length; ++i) {
-				var problem = problems[i];
-				while (rounds[j].id != problem.round_id)
-					++j; // Skip rounds (that have no problems attached)
-
-				++colspan;
-				// If current round's problems end
-				if (i + 1 == problems.length || problems[i + 1].round_id != problem.round_id) {
-					tr.append($('<th>', {
-						colspan: colspan,
-						html: $('<a>', {
-							href: '/c/r' + rounds[j].id + '#ranking',
-							text: rounds[j].name
-						})
-					}));
-					colspan = 0;
-					++j;
-				}
-			}
-			var thead = $('<thead>', {html: tr});
-			tr = $('<tr>');
-			// Add problems
-			for (var i = 0; i < problems.length; ++i)
+			return elem.append($('<center>', {
+				class: 'always_in_view',
+				html: message_to_show
+			}));
+		}
+
+		// Construct table's head
+		var tr = $('<tr>', {
+			html: [
+				$('<th>', {
+					rowspan: 2,
+					text: '#'
+				}),
+				$('<th>', {
+					rowspan: 2,
+					text: 'User'
+				}),
+				$('<th>', {
+					rowspan: 2,
+					text: 'Sum'
+				}),
+			]
+		});
+		// Add rounds
+		var colspan = 0;
+		var j = 0; // Index of the current round
+		for (var i = 0; i < problems.length; ++i) {
+			var problem = problems[i];
+			while (rounds[j].id != problem.round_id)
+				++j; // Skip rounds (that have no problems attached)
+
+			++colspan;
+			// If current round's problems end
+			if (i + 1 == problems.length || problems[i + 1].round_id != problem.round_id) {
 				tr.append($('<th>', {
+					colspan: colspan,
 					html: $('<a>', {
-						href: '/c/p' + problems[i].id + '#ranking',
-						text: problems[i].problem_label
+						href: '/c/r' + rounds[j].id + '#ranking',
+						text: rounds[j].name
 					})
 				}));
-			thead.append(tr);
-
-			// Add score for each user add this to the user's info
-			var submissions;
-			for (var i = 0; i < data.length; ++i) {
-				submissions = data[i].submissions;
-				var total_score = 0;
-				// Count only valid problems (to fix potential discrepancies
-				// between ranking submissions and the contest structure)
-				for (var j = 0; j < submissions.length; ++j) {
-					if (problem_to_col_id.get(submissions[j].contest_problem_id) !== null) {
-						total_score += submissions[j].score;
-					}
+				colspan = 0;
+				++j;
+			}
+		}
+		var thead = $('<thead>', {html: tr});
+		tr = $('<tr>');
+		// Add problems
+		for (var i = 0; i < problems.length; ++i)
+			tr.append($('<th>', {
+				html: $('<a>', {
+					href: '/c/p' + problems[i].id + '#ranking',
+					text: problems[i].problem_label
+				})
+			}));
+		thead.append(tr);
+
+		// Add score for each user add this to the user's info
+		var submissions;
+		for (var i = 0; i < data.length; ++i) {
+			submissions = data[i].submissions;
+			var total_score = 0;
+			// Count only valid problems (to fix potential discrepancies
+			// between ranking submissions and the contest structure)
+			for (var j = 0; j < submissions.length; ++j) {
+				if (problem_to_col_id.get(submissions[j].contest_problem_id) !== null) {
+					total_score += submissions[j].score;
 				}
-
-				data[i].score = total_score;
 			}
 
-			// Sort users (and their submissions) by their -score
-			data.sort(function(a, b) { return b.score - a.score; });
-
-			// Add rows
-			var tbody = $('<tbody>');
-			var prev_score = data[0].score + 1;
-			var place;
-			for (var i = 0; i < data.length; ++i) {
-				var user_row = data[i];
-				tr = $('<tr>');
-				// Place
-				if (prev_score != user_row.score) {
-					place = i + 1;
-					prev_score = user_row.score;
-				}
-				tr.append($('<td>', {text: place}));
-				// User
-				if (user_row.id === null)
-					tr.append($('<td>', {text: user_row.name}));
-				else {
-					tr.append($('<td>', {
-						html: a_view_button(url_user(user_row.id), user_row.name, '',
-							view_user.bind(null, true, user_row.id))
-					}));
-				}
-				// Score
-				tr.append($('<td>', {text: user_row.score}));
-				// Submissions
-				var row = new Array(problems.length);
-				submissions = data[i].submissions;
-				for (var j = 0; j < submissions.length; ++j) {
-					var x = problem_to_col_id.get(submissions[j].contest_problem_id);
-					if (x != null) {
-						var score_text = (submissions[j].score != null ? submissions[j].score : '?');
-						if (submissions[j].id === null) {
-							row[x] = $('<td>', {
-								class: 'status ' + submissions[j].status.class,
-								text: score_text
-							});
-						} else {
-							row[x] = $('<td>', {
-								class: 'status ' + submissions[j].status.class,
-								html: a_view_button('/s/' + submissions[j].id,
-									score_text, '',
-									view_submission.bind(null, true, submissions[j].id))
-							});
-						}
+			data[i].score = total_score;
+		}
+
+		// Sort users (and their submissions) by their -score
+		data.sort(function(a, b) { return b.score - a.score; });
+
+		// Add rows
+		var tbody = $('<tbody>');
+		var prev_score = data[0].score + 1;
+		var place;
+		for (var i = 0; i < data.length; ++i) {
+			var user_row = data[i];
+			tr = $('<tr>');
+			// Place
+			if (prev_score != user_row.score) {
+				place = i + 1;
+				prev_score = user_row.score;
+			}
+			tr.append($('<td>', {text: place}));
+			// User
+			if (user_row.id === null)
+				tr.append($('<td>', {text: user_row.name}));
+			else {
+				tr.append($('<td>', {
+					html: a_view_button(url_user(user_row.id), user_row.name, '',
+						view_user.bind(null, true, user_row.id))
+				}));
+			}
+			// Score
+			tr.append($('<td>', {text: user_row.score}));
+			// Submissions
+			var row = new Array(problems.length);
+			submissions = data[i].submissions;
+			for (var j = 0; j < submissions.length; ++j) {
+				var x = problem_to_col_id.get(submissions[j].contest_problem_id);
+				if (x != null) {
+					var score_text = (submissions[j].score != null ? submissions[j].score : '?');
+					if (submissions[j].id === null) {
+						row[x] = $('<td>', {
+							class: 'status ' + submissions[j].status.class,
+							text: score_text
+						});
+					} else {
+						row[x] = $('<td>', {
+							class: 'status ' + submissions[j].status.class,
+							html: a_view_button('/s/' + submissions[j].id,
+								score_text, '',
+								view_submission.bind(null, true, submissions[j].id))
+						});
 					}
 				}
-				// Construct the row
-				for (var j = 0; j < problems.length; ++j) {
-					if (row[j] === undefined)
-						$('<td>').appendTo(tr);
-					else
-						row[j].appendTo(tr);
-				}
-
-				tbody.append(tr);
+			}
+			// Construct the row
+			for (var j = 0; j < problems.length; ++j) {
+				if (row[j] === undefined)
+					$('<td>').appendTo(tr);
+				else
+					row[j].appendTo(tr);
 			}
 
-			elem.append($('<table>', {
-				class: 'table ranking stripped',
-				html: [thead, tbody]
-			}));
+			tbody.append(tr);
+		}
 
-			timed_hide_show(oldmodal);
-			centerize_oldmodal(oldmodal, false);
+		elem.append($('<table>', {
+			class: 'table ranking stripped',
+			html: [thead, tbody]
+		}));
+
+		timed_hide_show(oldmodal);
+		centerize_oldmodal(oldmodal, false);
 
-		}, elem);
 	}, elem);
 }
 function ContestsLister(elem, query_suffix /*= ''*/) {
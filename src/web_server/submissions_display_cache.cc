@@ -0,0 +1,54 @@
+#include "submissions_display_cache.hh"
+
+namespace web_server {
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+SubmissionsDisplayCache submissions_display_cache;
+
+std::optional<SubmissionsDisplayCache::Columns>
+SubmissionsDisplayCache::find(Entity entity, uint64_t id) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = entries_.find(Key{entity, id});
+    if (it == entries_.end()) {
+        return std::nullopt;
+    }
+    if (it->second.expires <= std::chrono::steady_clock::now()) {
+        entries_.erase(it);
+        return std::nullopt;
+    }
+    return it->second.columns;
+}
+
+uint64_t SubmissionsDisplayCache::generation() noexcept {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return generation_;
+}
+
+void SubmissionsDisplayCache::insert(
+    Entity entity, uint64_t id, Columns columns, uint64_t read_generation
+) {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (read_generation != generation_) {
+        return; // The columns might have been read before the invalidation
+    }
+
+    if (entries_.size() >= MAX_ENTRIES) {
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            it = (it->second.expires <= now ? entries_.erase(it) : std::next(it));
+        }
+        if (entries_.size() >= MAX_ENTRIES) {
+            entries_.clear();
+        }
+    }
+
+    entries_.insert_or_assign(Key{entity, id}, Entry{std::move(columns), now + TTL});
+}
+
+void SubmissionsDisplayCache::invalidate(Entity entity, uint64_t id) noexcept {
+    std::lock_guard<std::mutex> lock(mtx_);
+    ++generation_;
+    entries_.erase(Key{entity, id});
+}
+
+} // namespace web_server
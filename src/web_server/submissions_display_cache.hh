@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace web_server {
+
+// Process-wide cache of the columns of users, problems, contest problems, contest rounds and
+// contests that the submission lists display next to the submissions (names, round times, score
+// revealing mode), so that listing submissions is a single range scan of the submissions table
+// followed by cache lookups. Entries expire after TTL, which bounds staleness caused by changes
+// the web server is not notified about (e.g. a problem reupload changing the problem name).
+// Changes affecting what the lists reveal (round times, score revealing) are made by the web
+// server and invalidate the affected entries explicitly, as do user and problem status events.
+class SubmissionsDisplayCache {
+public:
+    enum class Entity : uint8_t { USER, PROBLEM, CONTEST_PROBLEM, CONTEST_ROUND, CONTEST };
+
+    // Values of the columns, in the order chosen by the caller of insert() (NULL is nullopt)
+    using Columns = std::vector<std::optional<std::string>>;
+
+    static constexpr std::chrono::seconds TTL{10};
+    static constexpr size_t MAX_ENTRIES = 1 << 16;
+
+private:
+    struct Entry {
+        Columns columns;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    using Key = std::pair<Entity, uint64_t>;
+
+    std::mutex mtx_;
+    uint64_t generation_ = 0; // incremented by every invalidation
+    std::map<Key, Entry> entries_;
+
+public:
+    SubmissionsDisplayCache() = default;
+
+    SubmissionsDisplayCache(const SubmissionsDisplayCache&) = delete;
+    SubmissionsDisplayCache(SubmissionsDisplayCache&&) = delete;
+    SubmissionsDisplayCache& operator=(const SubmissionsDisplayCache&) = delete;
+    SubmissionsDisplayCache& operator=(SubmissionsDisplayCache&&) = delete;
+    ~SubmissionsDisplayCache() = default;
+
+    std::optional<Columns> find(Entity entity, uint64_t id);
+
+    // Has to be taken before reading the columns from the database (in a transaction: before its
+    // first query, which takes the snapshot) and passed to insert(), so that columns read before
+    // a concurrent invalidation are not cached
+    uint64_t generation() noexcept;
+
+    void insert(Entity entity, uint64_t id, Columns columns, uint64_t read_generation);
+
+    // Has to be called after the change is committed
+    void invalidate(Entity entity, uint64_t id) noexcept;
+};
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+extern SubmissionsDisplayCache submissions_display_cache;
+
+} // namespace web_server
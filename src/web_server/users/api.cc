@@ -9,6 +9,7 @@
 
 #include <cstdint>
 #include <optional>
+#include <sim/contest_ranking_snapshots/contest_ranking_snapshot.hh>
 #include <sim/jobs/job.hh>
 #include <sim/jobs/utils.hh>
 #include <sim/users/user.hh>
@@ -387,6 +388,17 @@ Response edit(Context& ctx, decltype(User::id) user_id) {
         "email=COALESCE(?, email) WHERE id=?"
     );
     stmt.bind_and_execute(type, username, first_name, last_name, email, user_id);
+    if (type) {
+        ctx.invalidate_contest_permissions_after_commit = user_id;
+    }
+    if (first_name or last_name) {
+        // Names are shown in the rankings
+        sim::contest_ranking_snapshots::invalidate_of_user(ctx.mysql, user_id);
+    }
+    if (username or first_name or last_name) {
+        // Owners of the problems are shown in the problem lists
+        ctx.note_problems_list_change_after_commit = true;
+    }
 
     return ctx.response_ok();
 }
@@ -458,7 +470,7 @@ Response delete_(Context& ctx, decltype(User::id) user_id) {
 
     // Queue the deleting job
     auto stmt = ctx.mysql.prepare("INSERT INTO jobs (creator, type, priority, status, "
-                                  "added, aux_id, info, data) VALUES(?, ?, ?, ?, ?, ?, '', '')");
+                                  "added, aux_id, info) VALUES(?, ?, ?, ?, ?, ?, '')");
     constexpr auto type = Job::Type::DELETE_USER;
     stmt.bind_and_execute(
         ctx.session.value().user_id,
@@ -509,7 +521,7 @@ Response merge_into_another(Context& ctx, decltype(User::id) user_id) {
 
     // Queue the merging job
     auto stmt = ctx.mysql.prepare("INSERT INTO jobs (creator, type, priority, status, "
-                                  "added, aux_id, info, data) VALUES(?, ?, ?, ?, ?, ?, ?, '')");
+                                  "added, aux_id, info) VALUES(?, ?, ?, ?, ?, ?, ?)");
     constexpr auto type = Job::Type::MERGE_USERS;
     stmt.bind_and_execute(
         ctx.session.value().user_id,
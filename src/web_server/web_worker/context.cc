@@ -162,6 +162,12 @@ http::Response Context::response_404() {
     );
 }
 
+Response Context::response_304() {
+    auto resp = Response{Response::TEXT, "304 Not Modified"};
+    resp.cookies = std::move(cookie_changes);
+    return resp;
+}
+
 Response Context::response_ui(StringView title, StringView javascript_code) {
     auto resp = response_ok("", "text/html; charset=utf-8");
     // TODO: merge *_ui_template into one function after getting rid of the old code requiring
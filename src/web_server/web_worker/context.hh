@@ -4,6 +4,7 @@
 #include "../http/request.hh"
 #include "../http/response.hh"
 
+#include <optional>
 #include <sim/mysql/mysql.hh>
 #include <sim/sessions/session.hh>
 #include <sim/users/user.hh>
@@ -16,6 +17,10 @@ struct Context {
     const http::Request& request;
     mysql::Connection& mysql;
     bool notify_job_server_after_commit = false;
+    // The user whose entries of contest_permissions_cache are invalidated after commit
+    std::optional<decltype(sim::users::User::id)> invalidate_contest_permissions_after_commit;
+    // Whether data shown in the problem lists changed, see problems::note_list_change()
+    bool note_problems_list_change_after_commit = false;
 
     struct Session {
         decltype(sim::sessions::Session::id) id;
@@ -68,6 +73,8 @@ struct Context {
 
     http::Response response_404();
 
+    http::Response response_304();
+
     http::Response response_ui(StringView title, StringView javascript_code);
 };
 
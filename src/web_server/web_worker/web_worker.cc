@@ -1,14 +1,19 @@
 #include "../contest_entry_tokens/api.hh"
 #include "../contest_entry_tokens/ui.hh"
+#include "../contest_permissions_cache.hh"
 #include "../http/request.hh"
 #include "../http/response.hh"
 #include "../problems/api.hh"
+#include "../problems/list_changes.hh"
 #include "../problems/ui.hh"
+#include "../routes.hh"
 #include "../users/api.hh"
 #include "../users/ui.hh"
 #include "context.hh"
 #include "web_worker.hh"
 
+#include <algorithm>
+#include <iterator>
 #include <optional>
 #include <sim/jobs/utils.hh>
 #include <sim/problems/problem.hh>
@@ -34,7 +39,9 @@ namespace web_server::web_worker {
     (func);        \
     }
 
-WebWorker::WebWorker(mysql::Connection& mysql) : mysql{mysql} {
+WebWorker::WebWorker(mysql::Connection& mysql)
+: mysql{mysql}
+, handlers(std::size(routes::web_worker)) {
     // Handlers
     // clang-format off
     GET("/api/contest/{u64}/entry_tokens")(contest_entry_tokens::api::view);
@@ -80,30 +87,25 @@ WebWorker::WebWorker(mysql::Connection& mysql) : mysql{mysql} {
     POST("/api/user/{u64}/merge_into_another")(users::api::merge_into_another);
     POST("/api/users/add")(users::api::add);
     // clang-format on
-    // Ensure fast query dispatch
-    // assert(get_dispatcher.all_potential_collisions().empty()); // dispatcher is imperfect,
-    // collisions exist
-    assert(post_dispatcher.all_potential_collisions().empty());
+    // Ensure every route has its handler
+    assert(std::all_of(handlers.begin(), handlers.end(), [](auto& h) { return h; }));
 }
 
 #undef GET
 #undef POST
 #undef REST
 
-std::variant<Response, Request> WebWorker::handle(Request req) {
+std::variant<Response, Request> WebWorker::handle(Request req, bool in_outer_transaction) {
     request = std::move(req);
-    auto& dispatcher = [&]() -> auto& {
-        switch (request->method) {
-        case Request::HEAD:
-        case Request::GET: return get_dispatcher;
-        case Request::POST: return post_dispatcher;
+    this->in_outer_transaction = in_outer_transaction;
+    // HEAD is handled as GET. Captures refer to request->target, which stays intact until the
+    // handler returns.
+    auto match = routes::match(request->method, request->target);
+    if (routes::is_web_worker(match)) {
+        auto resp = handlers[match.route](match);
+        if (resp) {
+            return std::move(*resp);
         }
-        __builtin_unreachable();
-    }
-    ();
-    auto resp = dispatcher.dispatch(request->target);
-    if (resp) {
-        return *resp;
     }
     return std::move(*request);
 }
@@ -117,7 +119,10 @@ Response WebWorker::handler_impl(ResponseMaker&& response_maker) {
         .session = std::nullopt,
         .cookie_changes = {},
     };
-    auto transaction = ctx.mysql.start_transaction();
+    std::optional<mysql::Transaction> transaction;
+    if (not in_outer_transaction) {
+        transaction.emplace(ctx.mysql.start_transaction());
+    }
     ctx.open_session();
     auto response = std::forward<ResponseMaker>(response_maker)(ctx);
     assert(
@@ -127,29 +132,49 @@ Response WebWorker::handler_impl(ResponseMaker&& response_maker) {
     if (ctx.session) {
         ctx.close_session();
     }
-    transaction.commit();
+    if (transaction) {
+        transaction->commit();
+    }
     if (ctx.notify_job_server_after_commit) {
         sim::jobs::notify_job_server();
     }
+    if (ctx.invalidate_contest_permissions_after_commit) {
+        contest_permissions_cache.invalidate_user(*ctx.invalidate_contest_permissions_after_commit);
+    }
+    if (ctx.note_problems_list_change_after_commit) {
+        problems::note_list_change();
+    }
     return response;
 }
 
 template <const char* url_pattern, auto... CustomParsers, class... Params>
 void WebWorker::do_add_get_handler(strongly_typed_function<Response(Context&, Params...)> handler) {
-    get_dispatcher.add_handler<url_pattern, CustomParsers...>(
-        [&, handler = std::move(handler)](Params... args) {
+    constexpr auto route =
+        http::route_index(routes::web_worker, http::RouteMethod::GET, url_pattern);
+    static_assert(
+        route != http::RouteMatch::NONE, "The url pattern is missing in routes::web_worker"
+    );
+    handlers[route] = [this, handler = std::move(handler)](const http::RouteMatch& match) {
+        using Captures = http::RouteCaptures<url_pattern, CustomParsers...>;
+        return Captures::template call<Params...>(match, [&](Params... args) {
             return handler_impl([&](Context& ctx) {
                 return handler(ctx, std::forward<Params>(args)...);
             });
-        }
-    );
+        });
+    };
 }
 
 template <const char* url_pattern, auto... CustomParsers, class... Params>
 void WebWorker::do_add_post_handler(strongly_typed_function<Response(Context&, Params...)> handler
 ) {
-    post_dispatcher.add_handler<url_pattern, CustomParsers...>(
-        [&, handler = std::move(handler)](Params... args) {
+    constexpr auto route =
+        http::route_index(routes::web_worker, http::RouteMethod::POST, url_pattern);
+    static_assert(
+        route != http::RouteMatch::NONE, "The url pattern is missing in routes::web_worker"
+    );
+    handlers[route] = [this, handler = std::move(handler)](const http::RouteMatch& match) {
+        using Captures = http::RouteCaptures<url_pattern, CustomParsers...>;
+        return Captures::template call<Params...>(match, [&](Params... args) {
             return handler_impl([&](Context& ctx) {
                 // First check the CSRF token, if no session is open then we use value from
                 // cookie to pass the verification
@@ -162,8 +187,8 @@ void WebWorker::do_add_post_handler(strongly_typed_function<Response(Context&, P
                 // Safe to pass the request to the proper handler
                 return handler(ctx, std::forward<Params>(args)...);
             });
-        }
-    );
+        });
+    };
 }
 
 } // namespace web_server::web_worker
@@ -3,27 +3,37 @@
 #include "../http/cookies.hh"
 #include "../http/request.hh"
 #include "../http/response.hh"
+#include "../http/route_trie.hh"
 #include "context.hh"
 
+#include <functional>
+#include <optional>
 #include <sim/mysql/mysql.hh>
 #include <sim/sessions/session.hh>
 #include <simlib/http/url_dispatcher.hh>
 #include <variant>
+#include <vector>
 
 namespace web_server::web_worker {
 
 class WebWorker {
+    // Used only to deduce the handlers' parameters from the url patterns
     using UrlDispatcher = ::http::UrlDispatcher<http::Response>;
+    // Returns std::nullopt if a custom capture could not be parsed
+    using RouteHandler = std::function<std::optional<http::Response>(const http::RouteMatch&)>;
     mysql::Connection& mysql;
     std::optional<http::Request> request;
-    UrlDispatcher get_dispatcher;
-    UrlDispatcher post_dispatcher;
+    bool in_outer_transaction = false;
+    // Indexed by the routes from routes::web_worker
+    std::vector<RouteHandler> handlers;
 
 public:
     explicit WebWorker(mysql::Connection& mysql);
 
-    // Returns response for @p request or @p request if it cannot handle the @p request
-    std::variant<http::Response, http::Request> handle(http::Request req);
+    // Returns response for @p request or @p request if it cannot handle the @p request. If
+    // @p in_outer_transaction is true, the handler does not start its own transaction.
+    std::variant<http::Response, http::Request>
+    handle(http::Request req, bool in_outer_transaction = false);
 
 private:
     template <class ResponseMaker>
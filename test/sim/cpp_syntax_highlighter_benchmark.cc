@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <sim/cpp_syntax_highlighter.hh>
+#include <simlib/directory.hh>
+#include <simlib/file_contents.hh>
+#include <simlib/string_traits.hh>
+#include <simlib/string_view.hh>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+namespace {
+
+constexpr CStringView tests_dir = "test/sim/cpp_syntax_highlighter_test_cases/";
+
+template <class Func>
+double measure_seconds(Func&& func) {
+    auto beg = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - beg).count();
+}
+
+void benchmark_highlighting(const char* name, const string& source, size_t target_bytes) {
+    sim::CppSyntaxHighlighter csh;
+    size_t iterations = std::max<size_t>(1, target_bytes / std::max<size_t>(1, source.size()));
+    size_t output_bytes = 0;
+    double secs = measure_seconds([&] {
+        for (size_t i = 0; i < iterations; ++i) {
+            output_bytes += csh(intentional_unsafe_cstring_view(source)).size();
+        }
+    });
+    double mib = static_cast<double>(source.size() * iterations) / (1 << 20);
+    printf(
+        "%-28s %10zu B x %6zu: %8.3f s  %8.2f MiB/s  (output: %zu B per run)\n",
+        name,
+        source.size(),
+        iterations,
+        secs,
+        mib / secs,
+        output_bytes / iterations
+    );
+}
+
+} // namespace
+
+int main() {
+    // Corpus: the test cases of the highlighter
+    vector<string> corpus;
+    for_each_dir_component(tests_dir, [&](dirent* file) {
+        if (has_suffix(StringView{file->d_name}, ".in")) {
+            corpus.emplace_back(get_file_contents(concat(tests_dir, file->d_name)));
+        }
+    });
+    if (corpus.empty()) {
+        fprintf(stderr, "No test cases found in %s\n", tests_dir.data());
+        return 1;
+    }
+
+    // Creating a highlighter used to build the keyword automaton every time
+    constexpr size_t constructions = 100000;
+    double secs = measure_seconds([&] {
+        for (size_t i = 0; i < constructions; ++i) {
+            sim::CppSyntaxHighlighter csh;
+            (void)csh;
+        }
+    });
+    printf("%-28s %zu x: %.3f s\n", "construction", constructions, secs);
+
+    constexpr size_t target_bytes = 64 << 20;
+    string all;
+    for (const auto& source : corpus) {
+        benchmark_highlighting("test case", source, target_bytes / corpus.size());
+        all += source;
+        all += '\n';
+    }
+
+    // Large submissions
+    string large;
+    while (large.size() < (4 << 20)) {
+        large += all;
+    }
+    benchmark_highlighting("corpus repeated (4 MiB)", large, target_bytes);
+
+    // Mostly identifiers and white-spaces - the best case for skipping plain code
+    string plain;
+    while (plain.size() < (4 << 20)) {
+        plain += "    some_variable = another_variable + yet_another_one * factor;\n";
+    }
+    benchmark_highlighting("plain code (4 MiB)", plain, target_bytes);
+
+    // Dense comments and literals - the worst case for skipping plain code
+    string dense;
+    while (dense.size() < (4 << 20)) {
+        dense += "s = \"a\\tb\"; /* c */ c = '\\n'; // d\n";
+    }
+    benchmark_highlighting("comments and literals (4 MiB)", dense, target_bytes);
+}
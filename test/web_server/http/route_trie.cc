@@ -0,0 +1,191 @@
+#include "../../../src/web_server/http/request.hh"
+#include "../../../src/web_server/http/route_trie.hh"
+#include "../../../src/web_server/routes.hh"
+
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <optional>
+#include <simlib/string_view.hh>
+#include <string>
+#include <string_view>
+
+using web_server::http::Request;
+using web_server::http::RouteCaptures;
+using web_server::http::RouteMatch;
+using web_server::http::RouteMethod;
+using web_server::http::RouteTrie;
+using web_server::http::route_trie_nodes_bound;
+
+namespace {
+
+constexpr std::string_view patterns[] = {
+    "/",
+    "/api/**",
+    "/api/user/{u64}",
+    "/api/user/{u64}/problems",
+    "/api/user/me",
+    "/api/type=/{custom}/id%3C/{u64}",
+    "/a/{u64}/x",
+    "/a/{string}/y",
+    "GET /m",
+    "POST /m",
+    "/m",
+    "/c/c{u64}",
+    "/c/r{u64}/**",
+};
+constexpr RouteTrie<route_trie_nodes_bound(patterns)> trie{patterns};
+
+constexpr RouteMatch match(std::string_view target) { return trie.match(RouteMethod::GET, target); }
+
+enum class Kind { ONE, TWO };
+
+std::optional<Kind> kind_from_str(StringView str) {
+    if (str == "one") {
+        return Kind::ONE;
+    }
+    if (str == "two") {
+        return Kind::TWO;
+    }
+    return std::nullopt;
+}
+
+constexpr char custom_pattern[] = "/api/type=/{custom}/id%3C/{u64}";
+constexpr char user_pattern[] = "/api/user/{u64}";
+
+// Instantiates the captures of @p pattern (without the method)
+std::string sample_target(std::string_view pattern) {
+    pattern.remove_prefix(pattern.find('/'));
+    std::string res;
+    while (not pattern.empty()) {
+        pattern.remove_prefix(1);
+        auto segment = pattern.substr(0, pattern.find('/'));
+        pattern.remove_prefix(segment.size());
+        if (segment == "**") {
+            break;
+        }
+        res += '/';
+        if (segment == "{string}" or segment == "{custom}") {
+            res += "abc";
+        } else if (segment.size() >= 5 and segment.substr(segment.size() - 5) == "{u64}") {
+            res += segment.substr(0, segment.size() - 5);
+            res += "42";
+        } else {
+            res += segment;
+        }
+    }
+    return res.empty() ? "/" : res;
+}
+
+} // namespace
+
+// NOLINTNEXTLINE
+TEST(route_trie, match) {
+    static_assert(trie.routes_num() == std::size(patterns));
+    static_assert(match("/").route == 0);
+    static_assert(match("/?query").route == 0);
+    static_assert(match("/api/user/42").route == 2);
+    static_assert(match("/api/user/42").captures[0].u64 == 42);
+    static_assert(match("/api/user/42/problems?x/y").route == 3);
+    static_assert(match("/api/user/me").route == 4);
+    static_assert(match("/api/type=/abc/id%3C/7").captures_num == 2);
+    // Literal preceding a capture does not hide it
+    static_assert(match("/a/5/y").route == 7);
+    static_assert(match("/a/5/x").route == 6);
+    // Prefixed captures
+    static_assert(match("/c/c5").route == 11);
+    static_assert(match("/c/c5").captures[0].str == "5");
+    static_assert(match("/c/c5").captures[0].u64 == 5);
+
+    static_assert(not match(""));
+    static_assert(not match("/abc"));
+    static_assert(not match("/a//y"));
+    static_assert(not match("/c/x5"));
+    static_assert(not match("/c/c"));
+    static_assert(not match("/c/c5/"));
+
+    EXPECT_EQ(match("/api/user/18446744073709551615").captures[0].u64, UINT64_MAX);
+    EXPECT_EQ(match("/a/xyz/y").captures[0].str, "xyz");
+}
+
+// NOLINTNEXTLINE
+TEST(route_trie, match_rest) {
+    static_assert(match("/api").route == 1);
+    static_assert(match("/api").rest.empty());
+    static_assert(match("/api/").route == 1);
+    static_assert(match("/api/abc/def?x/y").route == 1);
+    static_assert(match("/api/user/42/abc").route == 1);
+    static_assert(match("/api/user/42/abc").captures_num == 0);
+    static_assert(match("/api/user/").route == 1);
+    static_assert(match("/api/user/-1").route == 1);
+    static_assert(match("/api/user/18446744073709551616").route == 1);
+    static_assert(match("/c/r5").route == 12);
+    static_assert(match("/c/r5/x").captures[0].u64 == 5);
+
+    EXPECT_EQ(match("/api/").rest, "/");
+    EXPECT_EQ(match("/api/abc/def?x/y").rest, "/abc/def");
+    EXPECT_EQ(match("/c/r5/x/y").rest, "/x/y");
+    EXPECT_EQ(match("/api/user/42").rest, "");
+}
+
+// NOLINTNEXTLINE
+TEST(route_trie, match_method) {
+    static_assert(trie.match(RouteMethod::GET, "/m").route == 8);
+    static_assert(trie.match(RouteMethod::POST, "/m").route == 9);
+    static_assert(trie.match(RouteMethod::ANY, "/m").route == 10);
+    static_assert(trie.match(RouteMethod::POST, "/api/user/42").route == 2);
+}
+
+// NOLINTNEXTLINE
+TEST(route_trie, captures) {
+    auto call = [](StringView target) {
+        return RouteCaptures<custom_pattern, kind_from_str>::call<Kind, uint64_t>(
+            match(target), [](Kind kind, uint64_t id) { return std::pair{kind, id}; }
+        );
+    };
+    EXPECT_EQ(call("/api/type=/two/id%3C/7"), std::pair(Kind::TWO, uint64_t{7}));
+    EXPECT_EQ(call("/api/type=/three/id%3C/7"), std::nullopt);
+
+    // Captures out of range of the parameter do not match
+    auto call_narrow = [](StringView target) {
+        return RouteCaptures<user_pattern>::call<uint32_t>(match(target), [](uint32_t id) {
+            return id;
+        });
+    };
+    EXPECT_EQ(call_narrow("/api/user/4294967295"), UINT32_MAX);
+    EXPECT_EQ(call_narrow("/api/user/4294967296"), std::nullopt);
+}
+
+// NOLINTNEXTLINE
+TEST(route_trie, routes) {
+    namespace routes = web_server::routes;
+    using routes::Old;
+
+    constexpr auto old_route = [](Request::Method method, std::string_view target) {
+        return routes::old_route(routes::match(method, target));
+    };
+    static_assert(
+        routes::trie.routes_num() == std::size(routes::web_worker) + std::size(routes::old)
+    );
+    static_assert(old_route(Request::GET, "/") == Old::MAIN_PAGE);
+    static_assert(old_route(Request::GET, "/c/c1/edit") == Old::CONTESTS);
+    static_assert(old_route(Request::GET, "/xyz") == Old::NOT_FOUND);
+    static_assert(old_route(Request::POST, "/api/contests") == Old::API_CONTESTS);
+    static_assert(old_route(Request::POST, "/api/contest/c1/ranking") == Old::API_CONTEST_RANKING);
+    static_assert(old_route(Request::POST, "/api/contest/1/ranking") == Old::API);
+    static_assert(old_route(Request::POST, "/api/xyz") == Old::API);
+    // The routes of WebWorker are bound to methods
+    static_assert(routes::is_web_worker(routes::match(Request::GET, "/api/problems")));
+    static_assert(routes::is_web_worker(routes::match(Request::HEAD, "/api/problems")));
+    static_assert(old_route(Request::POST, "/api/problems") == Old::API_PROBLEMS);
+    static_assert(old_route(Request::GET, "/api/contest/1/entry_tokens/add") == Old::API);
+
+    for (size_t i = 0; i < std::size(routes::web_worker); ++i) {
+        auto pattern = routes::web_worker[i];
+        auto method = pattern.substr(0, pattern.find(' ')) == "GET" ? Request::GET : Request::POST;
+        EXPECT_EQ(routes::match(method, sample_target(pattern)).route, i) << pattern;
+    }
+    for (size_t i = 0; i < std::size(routes::old); ++i) {
+        EXPECT_EQ(old_route(Request::POST, sample_target(routes::old[i])), static_cast<Old>(i))
+            << routes::old[i];
+    }
+}
@@ -0,0 +1,96 @@
+#include "../../../src/web_server/http/request.hh"
+#include "../../../src/web_server/http/route_trie.hh"
+#include "../../../src/web_server/routes.hh"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using std::string;
+using std::vector;
+using web_server::http::Request;
+
+namespace {
+
+template <class Func>
+double measure_seconds(Func&& func) {
+    auto beg = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - beg).count();
+}
+
+struct Target {
+    Request::Method method;
+    string target;
+};
+
+// Instantiates the captures of @p pattern, the method is taken from the pattern
+Target sample_target(std::string_view pattern) {
+    auto method = pattern.substr(0, 5) == "POST " ? Request::POST : Request::GET;
+    pattern.remove_prefix(pattern.find('/'));
+    string res;
+    size_t pos = 0;
+    while (pos < pattern.size()) {
+        auto end = pattern.find('/', pos + 1);
+        auto segment = pattern.substr(pos + 1, end - pos - 1);
+        res += '/';
+        if (segment.size() >= 5 and segment.substr(segment.size() - 5) == "{u64}") {
+            res += segment.substr(0, segment.size() - 5);
+            res += "1234567";
+        } else if (segment == "{string}" or segment == "{custom}") {
+            res += "some_string";
+        } else if (segment == "**") {
+            res += "some/rest";
+        } else {
+            res += segment;
+        }
+        pos = end == std::string_view::npos ? pattern.size() : end;
+    }
+    return {method, res};
+}
+
+template <size_t N, class Matcher>
+void benchmark_routes(const char* name, const std::string_view (&patterns)[N], Matcher&& matcher) {
+    vector<Target> targets;
+    for (auto pattern : patterns) {
+        auto [method, target] = sample_target(pattern);
+        targets.push_back({method, target});
+        targets.push_back({method, target + "?query"});
+        targets.push_back({method, target + "/not_matching"});
+    }
+
+    constexpr size_t target_lookups = 20'000'000;
+    size_t iterations = target_lookups / targets.size();
+    size_t matched = 0;
+    double secs = measure_seconds([&] {
+        for (size_t i = 0; i < iterations; ++i) {
+            for (const auto& [method, target] : targets) {
+                matched += matcher(method, target);
+            }
+        }
+    });
+    size_t lookups = iterations * targets.size();
+    printf(
+        "%-6s %3zu patterns: %10zu lookups in %.3f s  %7.2f ns/lookup  (%zu matched)\n",
+        name,
+        N,
+        lookups,
+        secs,
+        secs * 1e9 / static_cast<double>(lookups),
+        matched
+    );
+}
+
+} // namespace
+
+int main() {
+    namespace routes = web_server::routes;
+    // Both lists are matched by the same trie
+    auto matcher = [](Request::Method method, std::string_view target) {
+        return static_cast<bool>(routes::match(method, target));
+    };
+    benchmark_routes("new", routes::web_worker, matcher);
+    benchmark_routes("old", routes::old, matcher);
+}